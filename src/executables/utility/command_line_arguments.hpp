@@ -1,12 +1,15 @@
 #pragma once
 
 #include <core/helper/expected.hpp>
+#include <core/helper/types.hpp>
 
 #include <argparse/argparse.hpp>
 #include <filesystem>
 #include <fmt/format.h>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 
 struct Dump {
@@ -14,23 +17,42 @@ struct Dump {
     bool pretty_print;
 };
 
-struct Info { };
+struct Info {
+    // start from the last keyframe of every tetrion instead of replaying the whole recording
+    bool fast;
+};
+
+struct Verify {
+    // files, directories (searched recursively for .rec files) or globs in the file name
+    std::vector<std::string> paths;
+    // 0 means one thread per hardware thread
+    u32 num_threads;
+};
+
+struct Trace {
+    std::filesystem::path output_path;
+};
+
+struct Bisect {
+    std::filesystem::path first_trace_path;
+    std::filesystem::path second_trace_path;
+};
 
 
 struct CommandLineArguments final {
 private:
 public:
-    std::filesystem::path recording_path;
-    std::variant<Dump, Info> value;
+    std::optional<std::filesystem::path> recording_path;
+    std::variant<Dump, Info, Verify, Trace, Bisect> value;
 
 
     template<typename T>
-    CommandLineArguments(std::filesystem::path&& recording_path, T&& value)
+    CommandLineArguments(std::optional<std::filesystem::path>&& recording_path, T&& value)
         : recording_path{ std::move(recording_path) },
           value{ std::forward<T>(value) } { }
 
     template<typename T>
-    CommandLineArguments(std::filesystem::path&& recording_path, const T& value)
+    CommandLineArguments(std::optional<std::filesystem::path>&& recording_path, const T& value)
         : recording_path{ std::move(recording_path) },
           value{ value } { }
 
@@ -41,7 +63,8 @@ public:
                                          "0.0.1", argparse::default_arguments::all };
 
 
-        parser.add_argument("-r", "--recording").help("the path of a recorded game file").required();
+        parser.add_argument("-r", "--recording")
+                .help("the path of a recorded game file, needed by dump, info and trace");
 
 
         // git add subparser
@@ -53,37 +76,92 @@ public:
         dump_parser.add_argument("-p", "--pretty-print").help("Pretty print the JSON").flag();
 
         argparse::ArgumentParser info_parser("info");
-        info_parser.add_description("Print hHuman readable Info");
+        info_parser.add_description("Print human readable info and the final result of every tetrion");
+        info_parser.add_argument("-f", "--fast")
+                .help("Start the simulation at the last keyframe of every tetrion, that matches its state hash")
+                .flag();
+
+        argparse::ArgumentParser verify_parser("verify");
+        verify_parser.add_description("Replay recordings and check their embedded snapshots");
+        verify_parser.add_argument("paths")
+                .help("recording files, directories or globs (e.g. recordings/*.rec)")
+                .nargs(argparse::nargs_pattern::at_least_one);
+        verify_parser.add_argument("-j", "--jobs")
+                .help("the number of threads, 0 uses all hardware threads")
+                .scan<'i', u32>()
+                .default_value(u32{ 0 });
+
+
+        argparse::ArgumentParser trace_parser("trace");
+        trace_parser.add_description("Replay a recording step by step and write a trace of the tetrion states");
+        trace_parser.add_argument("-o", "--output").help("the path of the trace file").required();
+
+        argparse::ArgumentParser bisect_parser("bisect");
+        bisect_parser.add_description("Find the first step at which two traces of the same recording diverge");
+        bisect_parser.add_argument("first").help("the trace of the first build or run");
+        bisect_parser.add_argument("second").help("the trace of the second build or run");
 
 
         parser.add_subparser(dump_parser);
         parser.add_subparser(info_parser);
+        parser.add_subparser(verify_parser);
+        parser.add_subparser(trace_parser);
+        parser.add_subparser(bisect_parser);
 
         try {
 
             parser.parse_args(argc, argv);
 
-            auto recording_path = parser.get("--recording");
-
-            if (parser.is_subcommand_used(dump_parser)) {
-                const auto ensure_ascii = dump_parser.get<bool>("--ensure-ascii");
-                const auto pretty_print = dump_parser.get<bool>("--pretty-print");
+            auto recording_path = parser.present("--recording").transform([](const std::string& path) {
+                return std::filesystem::path{ path };
+            });
 
+            if (parser.is_subcommand_used(verify_parser)) {
+                return CommandLineArguments{
+                    std::move(recording_path),
+                    Verify{ .paths = verify_parser.get<std::vector<std::string>>("paths"),
+                           .num_threads = verify_parser.get<u32>("--jobs") }
+                };
+            }
 
+            if (parser.is_subcommand_used(bisect_parser)) {
                 return CommandLineArguments{
-                    std::move(recording_path), Dump{ .ensure_ascii = ensure_ascii, .pretty_print = pretty_print }
+                    std::move(recording_path),
+                    Bisect{ .first_trace_path = bisect_parser.get<std::string>("first"),
+                           .second_trace_path = bisect_parser.get<std::string>("second") }
                 };
             }
 
-            if (parser.is_subcommand_used(info_parser)) {
+            if (not parser.is_subcommand_used(dump_parser) and not parser.is_subcommand_used(info_parser)
+                and not parser.is_subcommand_used(trace_parser)) {
+                return helper::unexpected<std::string>{ "Unknown or no subcommand used" };
+            }
+
+            if (not recording_path.has_value()) {
+                return helper::unexpected<std::string>{ "--recording is required for this subcommand" };
+            }
+
+            if (parser.is_subcommand_used(trace_parser)) {
                 return CommandLineArguments{
                     std::move(recording_path),
-                    Info{},
+                    Trace{ .output_path = trace_parser.get<std::string>("--output") },
                 };
             }
 
+            if (parser.is_subcommand_used(dump_parser)) {
+                const auto ensure_ascii = dump_parser.get<bool>("--ensure-ascii");
+                const auto pretty_print = dump_parser.get<bool>("--pretty-print");
+
+
+                return CommandLineArguments{
+                    std::move(recording_path), Dump{ .ensure_ascii = ensure_ascii, .pretty_print = pretty_print }
+                };
+            }
 
-            return helper::unexpected<std::string>{ "Unknown or no subcommand used" };
+            return CommandLineArguments{
+                std::move(recording_path),
+                Info{ .fast = info_parser.get<bool>("--fast") },
+            };
 
         } catch (const std::exception& error) {
             return helper::unexpected<std::string>{ error.what() };
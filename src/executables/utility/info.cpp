@@ -0,0 +1,160 @@
+#include "./info.hpp"
+
+#include <core/helper/input_event.hpp>
+#include <core/helper/magic_enum_wrapper.hpp>
+#include <core/helper/types.hpp>
+
+#include "game/simulation.hpp"
+#include "helper/constants.hpp"
+#include "helper/spdlog_wrapper.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct RecordingStatistics {
+        usize num_records{ 0 };
+        // only pressing a key is an action, releasing it again isn't
+        usize num_actions{ 0 };
+        usize num_snapshots{ 0 };
+        usize num_keyframes{ 0 };
+    };
+
+    [[nodiscard]] std::vector<RecordingStatistics> collect_statistics(const recorder::RecordingReader& recording_reader
+    ) {
+        std::vector<RecordingStatistics> result(recording_reader.tetrion_headers().size());
+
+        for (const auto& record : recording_reader.records()) {
+            auto& statistics = result.at(record.tetrion_index);
+            ++statistics.num_records;
+            if (record.event < InputEvent::RotateLeftReleased) {
+                ++statistics.num_actions;
+            }
+        }
+
+        for (const auto& snapshot : recording_reader.snapshots()) {
+            ++result.at(snapshot.tetrion_index()).num_snapshots;
+        }
+
+        for (const auto& keyframe : recording_reader.keyframes()) {
+            ++result.at(keyframe.tetrion_index()).num_keyframes;
+        }
+
+        return result;
+    }
+
+    [[nodiscard]] double per_second(const double value, const double seconds) {
+        return seconds > 0.0 ? value / seconds : 0.0;
+    }
+
+    void print_header(const recorder::RecordingReader& recording_reader) {
+        std::vector<std::pair<std::string, std::string>> information{};
+        for (const auto& [key, value] : recording_reader.information()) {
+            information.emplace_back(key, value.to_string());
+        }
+        std::ranges::sort(information);
+
+        std::cout << "information:\n";
+        for (const auto& [key, value] : information) {
+            std::cout << fmt::format("  {}: {}\n", key, value);
+        }
+
+        std::cout << fmt::format(
+                "records: {}, snapshots: {}, keyframes: {}, state hashes: {}\n", recording_reader.num_records(),
+                recording_reader.snapshots().size(), recording_reader.keyframes().size(),
+                recording_reader.state_hashes().size()
+        );
+    }
+
+    void print_result(
+            const Simulation& simulation,
+            const usize tetrion_index,
+            const recorder::TetrionHeader& header,
+            const RecordingStatistics& statistics,
+            const u32 simulation_frequency
+    ) {
+        const auto& tetrion = simulation.tetrion(tetrion_index);
+        const auto simulation_step_index = simulation.simulation_step_index(tetrion_index);
+        const auto seconds = static_cast<double>(simulation_step_index) / static_cast<double>(simulation_frequency);
+
+        std::cout << fmt::format("\ntetrion {}:\n", tetrion_index);
+        std::cout << fmt::format("  seed: {}\n", header.seed);
+        std::cout << fmt::format("  starting level: {}\n", header.starting_level);
+        std::cout << fmt::format("  random algorithm: {}\n", magic_enum::enum_name(header.random_algorithm));
+        std::cout << fmt::format(
+                "  records: {} ({} actions), snapshots: {}, keyframes: {}\n", statistics.num_records,
+                statistics.num_actions, statistics.num_snapshots, statistics.num_keyframes
+        );
+        std::cout << fmt::format("  game over: {}\n", tetrion.is_game_over() ? "yes" : "no");
+        std::cout << fmt::format("  score: {}\n", tetrion.score());
+        std::cout << fmt::format("  level: {}\n", tetrion.level());
+        std::cout << fmt::format("  lines: {}\n", tetrion.lines_cleared());
+        std::cout << fmt::format("  pieces: {}\n", tetrion.num_locked_tetrominos());
+        std::cout << fmt::format("  steps: {} ({:.2f} s)\n", simulation_step_index, seconds);
+        std::cout << fmt::format(
+                "  PPS: {:.2f}\n", per_second(static_cast<double>(tetrion.num_locked_tetrominos()), seconds)
+        );
+        std::cout << fmt::format(
+                "  APM: {:.1f}\n", per_second(static_cast<double>(statistics.num_actions), seconds) * 60.0
+        );
+    }
+
+} // namespace
+
+
+[[nodiscard]] int
+print_info(const std::shared_ptr<recorder::RecordingReader>& recording_reader, const Info& info) noexcept {
+    try {
+        // the replay logs every snapshot comparison, only real problems are of interest here
+        spdlog::set_level(spdlog::level::warn);
+
+        print_header(*recording_reader);
+
+        auto simulation = Simulation::get_replay_simulation(recording_reader);
+        if (not simulation.has_value()) {
+            std::cerr << fmt::format("An error occurred while creating the simulation: {}\n", simulation.error());
+            return 1;
+        }
+
+        const auto start = Clock::now();
+        if (info.fast) {
+            // starting at the last keyframe of every tetrion skips almost all of the replay, tetrions without any
+            // keyframe are simulated from the start, the keyframe is checked against the state hash of its step and
+            // the rest of the replay against the following ones, so the result is verified like a full replay
+            simulation->seek(std::numeric_limits<SimulationStep>::max());
+        } else {
+            simulation->simulate_to_end();
+        }
+        const auto duration = Clock::now() - start;
+
+        const auto simulation_frequency =
+                recording_reader->information().get_if<u32>("simulation_frequency").value_or(
+                        constants::simulation_frequency
+                );
+        const auto statistics = collect_statistics(*recording_reader);
+
+        for (usize tetrion_index = 0; tetrion_index < simulation->num_tetrions(); ++tetrion_index) {
+            print_result(
+                    simulation.value(), tetrion_index, recording_reader->tetrion_headers().at(tetrion_index),
+                    statistics.at(tetrion_index), simulation_frequency
+            );
+        }
+
+        std::cout << fmt::format(
+                "\nsimulated in {:.1f} ms\n", std::chrono::duration<double, std::milli>(duration).count()
+        );
+
+        return 0;
+    } catch (const std::exception& error) {
+        std::cerr << error.what();
+        return 1;
+    }
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <recordings/recordings.hpp>
+
+#include "./command_line_arguments.hpp"
+
+#include <memory>
+
+// prints the header data of the recording and replays it headless for the final result, returns the exit code
+[[nodiscard]] int
+print_info(const std::shared_ptr<recorder::RecordingReader>& recording_reader, const Info& info) noexcept;
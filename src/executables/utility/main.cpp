@@ -1,18 +1,17 @@
 
 #include "./command_line_arguments.hpp"
+#include "./info.hpp"
+#include "./trace.hpp"
+#include "./verify.hpp"
 
 #include <recordings/recordings.hpp>
 
 #include <exception>
 #include <filesystem>
 #include <iostream>
+#include <memory>
 
 namespace {
-    void print_info(const recorder::RecordingReader& recording_reader) noexcept {
-        //TODO(Totto): Implement, print basic information and final result for each simulation
-        UNUSED(recording_reader);
-        std::cerr << "NOT IMPLEMENTED\n";
-    }
 
     void dump_json(const recorder::RecordingReader& recording_reader, bool pretty_print, bool ensure_ascii) noexcept {
 
@@ -61,30 +60,48 @@ int main(int argc, char** argv) noexcept {
 
         auto arguments = std::move(arguments_result.value());
 
-        if (not std::filesystem::exists(arguments.recording_path)) {
-            std::cerr << arguments.recording_path << " does not exist!\n";
+        if (const auto* verify = std::get_if<Verify>(&arguments.value); verify != nullptr) {
+            return verify_recordings(*verify);
+        }
+
+        if (const auto* bisect = std::get_if<Bisect>(&arguments.value); bisect != nullptr) {
+            return bisect_traces(*bisect);
+        }
+
+        const auto recording_path = arguments.recording_path.value();
+
+        if (not std::filesystem::exists(recording_path)) {
+            std::cerr << recording_path << " does not exist!\n";
             return 1;
         }
 
 
-        auto parsed = recorder::RecordingReader::from_path(arguments.recording_path);
+        auto parsed = recorder::RecordingReader::from_path(recording_path);
 
         if (not parsed.has_value()) {
             std::cerr << fmt::format(
-                    "An error occurred during parsing of the recording file '{}': {}\n",
-                    arguments.recording_path.string(), parsed.error()
+                    "An error occurred during parsing of the recording file '{}': {}\n", recording_path.string(),
+                    parsed.error()
             );
             return 1;
         }
 
 
-        const auto recording_reader = std::move(parsed.value());
+        const auto recording_reader = std::make_shared<recorder::RecordingReader>(std::move(parsed.value()));
 
-        std::visit(
+        return std::visit(
                 helper::Overloaded{ [&recording_reader](const Dump& dump) {
-                                       dump_json(recording_reader, dump.pretty_print, dump.ensure_ascii);
+                                       dump_json(*recording_reader, dump.pretty_print, dump.ensure_ascii);
+                                       return 0;
                                    },
-                                    [&recording_reader](const Info& /* info */) { print_info(recording_reader); } },
+                                    [&recording_reader](const Info& info) {
+                                        return print_info(recording_reader, info);
+                                    },
+                                    [&recording_reader](const Trace& trace) {
+                                        return write_trace(recording_reader, trace);
+                                    },
+                                    [](const Verify& /* verify */) { return 0; },
+                                    [](const Bisect& /* bisect */) { return 0; } },
                 arguments.value
         );
 
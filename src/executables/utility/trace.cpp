@@ -0,0 +1,365 @@
+#include "./trace.hpp"
+
+#include <core/game/grid_properties.hpp>
+#include <core/helper/expected.hpp>
+#include <core/helper/magic_enum_wrapper.hpp>
+#include <core/helper/types.hpp>
+
+#include "game/simulation.hpp"
+#include "helper/spdlog_wrapper.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// a trace is a text file, after the header line every line holds the complete state of one tetrion:
+//   <tetrion index> <simulation step> hash=<state hash> <key>=<value> ...
+// lines are only written if the state changed, so every step in between has the state of the line before it
+
+namespace {
+
+    constexpr std::string_view trace_header = "oopetris-trace 2";
+
+    using StateFields = std::vector<std::pair<std::string, std::string>>;
+
+    struct TraceEntry {
+        SimulationStep simulation_step_index;
+        StateFields fields;
+    };
+
+    // the entries of every tetrion, sorted by step
+    using TraceFile = std::map<u8, std::vector<TraceEntry>>;
+
+    [[nodiscard]] std::string describe_tetromino(const std::optional<Tetromino>& tetromino) {
+        if (not tetromino.has_value()) {
+            return "-";
+        }
+
+        return fmt::format(
+                "{}:{}:{},{}", magic_enum::enum_name(tetromino->type()), magic_enum::enum_name(tetromino->rotation()),
+                tetromino->position().x, tetromino->position().y
+        );
+    }
+
+    // one character per cell, the rows from top to bottom are separated by '/'
+    [[nodiscard]] std::string describe_mino_stack(const MinoStack& mino_stack) {
+        constexpr auto row_length = static_cast<usize>(grid::width_in_tiles) + 1;
+
+        std::string result(row_length * grid::height_in_tiles - 1, '.');
+        for (usize row = 1; row < grid::height_in_tiles; ++row) {
+            result.at(row * row_length - 1) = '/';
+        }
+
+        for (const auto& mino : mino_stack.minos()) {
+            const auto& position = mino.position();
+            if (position.x < 0 or position.x >= grid::width_in_tiles or position.y < 0
+                or position.y >= grid::height_in_tiles) {
+                continue;
+            }
+            result.at(static_cast<usize>(position.y) * row_length + static_cast<usize>(position.x)) =
+                    magic_enum::enum_name(mino.type()).front();
+        }
+
+        return result;
+    }
+
+    [[nodiscard]] StateFields describe_state(const SimulatedTetrion& tetrion) {
+        const auto& state = tetrion.state();
+
+        std::string preview{};
+        for (const auto type : tetrion.preview_tetromino_types()) {
+            preview += magic_enum::enum_name(type).front();
+        }
+
+        return StateFields{
+            { "hash", fmt::format("{:016x}", tetrion.state_hash()) },
+            { "game_state", std::string{ magic_enum::enum_name(state.game_state) } },
+            { "score", std::to_string(state.score) },
+            { "level", std::to_string(state.level) },
+            { "lines", std::to_string(state.lines_cleared) },
+            { "pieces", std::to_string(state.num_locked_tetrominos) },
+            { "active", describe_tetromino(state.active_tetromino) },
+            { "hold", describe_tetromino(state.tetromino_on_hold) },
+            { "preview", preview },
+            { "sequence_position", std::to_string(state.sequence_position) },
+            { "allowed_to_hold", state.allowed_to_hold ? "1" : "0" },
+            { "down_key_pressed", state.down_key_pressed ? "1" : "0" },
+            { "accelerated", state.is_accelerated_down_movement ? "1" : "0" },
+            { "in_lock_delay", state.is_in_lock_delay ? "1" : "0" },
+            { "num_executed_lock_delays", std::to_string(state.num_executed_lock_delays) },
+            { "lock_delay_step", std::to_string(state.lock_delay_step_index) },
+            { "next_gravity_step", std::to_string(state.next_gravity_simulation_step_index) },
+            { "mino_stack", describe_mino_stack(state.mino_stack) },
+        };
+    }
+
+    [[nodiscard]] std::string format_entry(const u8 tetrion_index, const TraceEntry& entry) {
+        std::string result = fmt::format("{} {}", tetrion_index, entry.simulation_step_index);
+        for (const auto& [key, value] : entry.fields) {
+            result += fmt::format(" {}={}", key, value);
+        }
+        return result;
+    }
+
+    [[nodiscard]] helper::expected<TraceFile, std::string> read_trace(const std::filesystem::path& path) {
+        std::ifstream file{ path };
+        if (not file) {
+            return helper::unexpected<std::string>{ fmt::format("unable to open trace \"{}\"", path.string()) };
+        }
+
+        std::string line;
+        if (not std::getline(file, line) or line != trace_header) {
+            return helper::unexpected<std::string>{ fmt::format("\"{}\" is not a trace", path.string()) };
+        }
+
+        TraceFile result{};
+        for (usize line_number = 2; std::getline(file, line); ++line_number) {
+            std::istringstream stream{ line };
+
+            u32 tetrion_index{};
+            TraceEntry entry{};
+            if (not(stream >> tetrion_index >> entry.simulation_step_index) or tetrion_index > 0xFF) {
+                return helper::unexpected<std::string>{
+                    fmt::format("invalid line {} in trace \"{}\"", line_number, path.string())
+                };
+            }
+
+            std::string field;
+            while (stream >> field) {
+                const auto separator = field.find('=');
+                if (separator == std::string::npos) {
+                    return helper::unexpected<std::string>{ fmt::format(
+                            "invalid field \"{}\" in line {} of trace \"{}\"", field, line_number, path.string()
+                    ) };
+                }
+                entry.fields.emplace_back(field.substr(0, separator), field.substr(separator + 1));
+            }
+
+            auto& entries = result[static_cast<u8>(tetrion_index)];
+            if (not entries.empty() and entries.back().simulation_step_index >= entry.simulation_step_index) {
+                return helper::unexpected<std::string>{
+                    fmt::format("the steps in line {} of trace \"{}\" are not ascending", line_number, path.string())
+                };
+            }
+            entries.push_back(std::move(entry));
+        }
+
+        return result;
+    }
+
+    template<typename T>
+    void sort_unique(std::vector<T>& values) {
+        std::ranges::sort(values);
+        const auto [first, last] = std::ranges::unique(values);
+        values.erase(first, last);
+    }
+
+    // the state of the tetrion at the given step, if the trace has already started at that point
+    [[nodiscard]] const TraceEntry*
+    entry_at(const TraceFile& trace, const u8 tetrion_index, const SimulationStep simulation_step_index) {
+        const auto entries = trace.find(tetrion_index);
+        if (entries == trace.end()) {
+            return nullptr;
+        }
+
+        const auto after = std::ranges::upper_bound(
+                entries->second, simulation_step_index, std::less{}, &TraceEntry::simulation_step_index
+        );
+        if (after == entries->second.begin()) {
+            return nullptr;
+        }
+        return &*std::prev(after);
+    }
+
+    [[nodiscard]] bool
+    is_equal_at(const TraceFile& first, const TraceFile& second, const u8 tetrion_index, const SimulationStep step) {
+        const auto* first_entry = entry_at(first, tetrion_index, step);
+        const auto* second_entry = entry_at(second, tetrion_index, step);
+        if (first_entry == nullptr or second_entry == nullptr) {
+            return first_entry == second_entry;
+        }
+        return first_entry->fields == second_entry->fields;
+    }
+
+    void print_difference(const TraceEntry* first_entry, const TraceEntry* second_entry) {
+        if (first_entry == nullptr or second_entry == nullptr) {
+            std::cout << fmt::format(
+                    "  only the {} trace has a state at this step\n", first_entry == nullptr ? "second" : "first"
+            );
+            return;
+        }
+
+        std::map<std::string, std::pair<std::string, std::string>> fields{};
+        for (const auto& [key, value] : first_entry->fields) {
+            fields[key].first = value;
+        }
+        for (const auto& [key, value] : second_entry->fields) {
+            fields[key].second = value;
+        }
+
+        for (const auto& [key, values] : fields) {
+            const auto& [first_value, second_value] = values;
+            if (first_value == second_value) {
+                continue;
+            }
+
+            if (key != "mino_stack") {
+                std::cout << fmt::format("  {}: {} -> {}\n", key, first_value, second_value);
+                continue;
+            }
+
+            // the whole stack doesn't fit on one line, so only the differing rows are printed
+            std::istringstream first_rows{ first_value };
+            std::istringstream second_rows{ second_value };
+            std::string first_row;
+            std::string second_row;
+            for (usize row = 0; std::getline(first_rows, first_row, '/') and std::getline(second_rows, second_row, '/');
+                 ++row) {
+                if (first_row != second_row) {
+                    std::cout << fmt::format("  mino_stack row {}: {} -> {}\n", row, first_row, second_row);
+                }
+            }
+        }
+    }
+
+} // namespace
+
+
+[[nodiscard]] int
+write_trace(const std::shared_ptr<recorder::RecordingReader>& recording_reader, const Trace& trace) noexcept {
+    try {
+        spdlog::set_level(spdlog::level::warn);
+
+        auto simulation = Simulation::get_replay_simulation(recording_reader, 1);
+        if (not simulation.has_value()) {
+            std::cerr << fmt::format("An error occurred while creating the simulation: {}\n", simulation.error());
+            return 1;
+        }
+
+        std::ofstream file{ trace.output_path };
+        if (not file) {
+            std::cerr << fmt::format("unable to open \"{}\" for writing\n", trace.output_path.string());
+            return 1;
+        }
+        file << trace_header << '\n';
+
+        std::vector<StateFields> previous_states(simulation->num_tetrions());
+        const auto add_changed_states = [&simulation, &previous_states, &file]() {
+            for (usize index = 0; index < simulation->num_tetrions(); ++index) {
+                auto fields = describe_state(simulation->tetrion(index));
+                if (fields == previous_states.at(index)) {
+                    continue;
+                }
+
+                const auto entry = TraceEntry{ simulation->simulation_step_index(index), std::move(fields) };
+                file << format_entry(simulation->tetrion(index).tetrion_index(), entry) << '\n';
+                previous_states.at(index) = entry.fields;
+            }
+        };
+
+        // every step is simulated on its own, so a difference in skipping idle steps shows up as well
+        add_changed_states();
+        try {
+            while (not simulation->is_game_finished()) {
+                simulation->update();
+                add_changed_states();
+            }
+        } catch (const std::exception& error) {
+            // a mismatching snapshot or state hash is exactly what the trace is for, so the trace is kept up to there
+            std::cerr << fmt::format(
+                    "the replay stopped at simulation step {}: {}\n", simulation->simulation_step_index(), error.what()
+            );
+        }
+
+        if (not file) {
+            std::cerr << fmt::format("an error occurred while writing \"{}\"\n", trace.output_path.string());
+            return 1;
+        }
+
+        std::cout << fmt::format(
+                "wrote a trace of {} steps to {}\n", simulation->simulation_step_index(), trace.output_path.string()
+        );
+
+        return 0;
+    } catch (const std::exception& error) {
+        std::cerr << error.what();
+        return 1;
+    }
+}
+
+[[nodiscard]] int bisect_traces(const Bisect& bisect) noexcept {
+    try {
+        const auto first = read_trace(bisect.first_trace_path);
+        if (not first.has_value()) {
+            std::cerr << first.error() << '\n';
+            return 1;
+        }
+
+        const auto second = read_trace(bisect.second_trace_path);
+        if (not second.has_value()) {
+            std::cerr << second.error() << '\n';
+            return 1;
+        }
+
+        std::vector<u8> tetrion_indices{};
+        std::vector<SimulationStep> simulation_step_indices{};
+        for (const auto* trace : { &first.value(), &second.value() }) {
+            for (const auto& [tetrion_index, entries] : *trace) {
+                tetrion_indices.push_back(tetrion_index);
+                for (const auto& entry : entries) {
+                    simulation_step_indices.push_back(entry.simulation_step_index);
+                }
+            }
+        }
+
+        // the state only changes at the steps that have an entry, so only those have to be checked
+        sort_unique(simulation_step_indices);
+        sort_unique(tetrion_indices);
+
+        const auto is_diverged = [&](const SimulationStep simulation_step_index) {
+            return std::ranges::any_of(tetrion_indices, [&](const u8 tetrion_index) {
+                return not is_equal_at(first.value(), second.value(), tetrion_index, simulation_step_index);
+            });
+        };
+
+        // a divergence isn't necessarily permanent (e.g. two builds that only disagree about a transient field), so
+        // every step has to be checked in order, each check is only a lookup in the already loaded traces
+        const auto diverging_step = std::ranges::find_if(simulation_step_indices, is_diverged);
+
+        if (diverging_step == simulation_step_indices.end()) {
+            std::cout << "the traces are identical\n";
+            return 0;
+        }
+
+        const auto simulation_step_index = *diverging_step;
+        std::cout << fmt::format("the traces diverge at simulation step {}", simulation_step_index);
+        if (diverging_step != simulation_step_indices.begin()) {
+            std::cout << fmt::format(", they are equal up to simulation step {}", *std::prev(diverging_step));
+        }
+        std::cout << '\n';
+
+        for (const auto tetrion_index : tetrion_indices) {
+            if (is_equal_at(first.value(), second.value(), tetrion_index, simulation_step_index)) {
+                continue;
+            }
+
+            std::cout << fmt::format("\ntetrion {} (first -> second):\n", tetrion_index);
+            print_difference(
+                    entry_at(first.value(), tetrion_index, simulation_step_index),
+                    entry_at(second.value(), tetrion_index, simulation_step_index)
+            );
+        }
+
+        return 1;
+    } catch (const std::exception& error) {
+        std::cerr << error.what();
+        return 1;
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <recordings/recordings.hpp>
+
+#include "./command_line_arguments.hpp"
+
+#include <memory>
+
+// replays the recording step by step and writes the state of every tetrion whenever it changed, returns the exit code
+[[nodiscard]] int
+write_trace(const std::shared_ptr<recorder::RecordingReader>& recording_reader, const Trace& trace) noexcept;
+
+// searches the first step at which the traces differ and prints both states at that step, returns the exit code
+[[nodiscard]] int bisect_traces(const Bisect& bisect) noexcept;
@@ -0,0 +1,209 @@
+#include "./verify.hpp"
+
+#include <core/helper/expected.hpp>
+#include <core/helper/types.hpp>
+
+#include "game/simulation.hpp"
+#include "helper/spdlog_wrapper.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct VerifyResult {
+        std::filesystem::path path;
+        helper::expected<SimulationStep, std::string> steps;
+        Clock::duration duration;
+    };
+
+    // supports '*' and '?', which is enough for selecting recordings by name
+    [[nodiscard]] bool matches_glob(std::string_view pattern, std::string_view name) {
+        usize pattern_index = 0;
+        usize name_index = 0;
+        std::optional<usize> star_pattern_index{};
+        usize star_name_index = 0;
+
+        while (name_index < name.size()) {
+            if (pattern_index < pattern.size()
+                and (pattern[pattern_index] == '?' or pattern[pattern_index] == name[name_index])) {
+                ++pattern_index;
+                ++name_index;
+            } else if (pattern_index < pattern.size() and pattern[pattern_index] == '*') {
+                star_pattern_index = pattern_index;
+                star_name_index = name_index;
+                ++pattern_index;
+            } else if (star_pattern_index.has_value()) {
+                // let the last star consume one more character
+                pattern_index = star_pattern_index.value() + 1;
+                name_index = ++star_name_index;
+            } else {
+                return false;
+            }
+        }
+
+        while (pattern_index < pattern.size() and pattern[pattern_index] == '*') {
+            ++pattern_index;
+        }
+        return pattern_index == pattern.size();
+    }
+
+    [[nodiscard]] bool is_recording(const std::filesystem::path& path) {
+        return std::filesystem::is_regular_file(path) and path.extension() == ".rec";
+    }
+
+    [[nodiscard]] helper::expected<std::vector<std::filesystem::path>, std::string> collect_recordings(
+            const std::vector<std::string>& paths
+    ) {
+        std::vector<std::filesystem::path> result{};
+
+        for (const auto& raw_path : paths) {
+            const auto path = std::filesystem::path{ raw_path };
+            const auto file_name = path.filename().string();
+
+            if (file_name.find_first_of("*?") != std::string::npos) {
+                const auto directory = path.has_parent_path() ? path.parent_path() : std::filesystem::path{ "." };
+                if (not std::filesystem::is_directory(directory)) {
+                    return helper::unexpected<std::string>{ fmt::format("{} is not a directory", directory.string()) };
+                }
+                for (const auto& entry : std::filesystem::directory_iterator{ directory }) {
+                    if (entry.is_regular_file() and matches_glob(file_name, entry.path().filename().string())) {
+                        result.push_back(entry.path());
+                    }
+                }
+                continue;
+            }
+
+            if (std::filesystem::is_directory(path)) {
+                for (const auto& entry : std::filesystem::recursive_directory_iterator{ path }) {
+                    if (is_recording(entry.path())) {
+                        result.push_back(entry.path());
+                    }
+                }
+                continue;
+            }
+
+            if (not std::filesystem::exists(path)) {
+                return helper::unexpected<std::string>{ fmt::format("{} does not exist", path.string()) };
+            }
+
+            result.push_back(path);
+        }
+
+        std::ranges::sort(result);
+        const auto [first, last] = std::ranges::unique(result);
+        result.erase(first, last);
+
+        return result;
+    }
+
+    [[nodiscard]] helper::expected<SimulationStep, std::string> verify_recording(std::filesystem::path path) {
+        try {
+            // the recording is only replayed once from start to end, so it doesn't need to be in memory completely, a
+            // streamed simulation always runs on the calling thread, the files are verified in parallel instead
+            auto simulation = Simulation::get_streaming_replay_simulation(path);
+            if (not simulation.has_value()) {
+                return helper::unexpected<std::string>{ simulation.error() };
+            }
+
+            // the snapshots are checked by the replay input, a mismatch throws
+            simulation->simulate_to_end();
+
+            // the game time that was replayed, idle steps are skipped by the simulation, but they are counted here, as
+            // they are part of the game, every tetrion has its own
+            SimulationStep total_steps = 0;
+            for (usize index = 0; index < simulation->num_tetrions(); ++index) {
+                total_steps += simulation->simulation_step_index(index);
+            }
+            return total_steps;
+        } catch (const std::exception& error) {
+            return helper::unexpected<std::string>{ error.what() };
+        }
+    }
+
+    [[nodiscard]] double to_seconds(const Clock::duration duration) {
+        return std::chrono::duration<double>(duration).count();
+    }
+
+} // namespace
+
+
+[[nodiscard]] int verify_recordings(const Verify& verify) noexcept {
+    try {
+        // the replay logs every snapshot comparison, failures are reported per file below instead
+        spdlog::set_level(spdlog::level::off);
+
+        const auto recordings = collect_recordings(verify.paths);
+        if (not recordings.has_value()) {
+            std::cerr << fmt::format("An error occurred while collecting the recordings: {}\n", recordings.error());
+            return 1;
+        }
+
+        const auto& paths = recordings.value();
+        std::vector<std::optional<VerifyResult>> results(paths.size());
+
+        const auto num_threads = std::min<usize>(
+                verify.num_threads == 0 ? std::max(1U, std::thread::hardware_concurrency()) : verify.num_threads,
+                std::max<usize>(paths.size(), 1)
+        );
+
+        // recordings differ a lot in length, so every thread grabs the next file as soon as it is done
+        std::atomic<usize> next_index{ 0 };
+        const auto worker = [&paths, &results, &next_index]() {
+            for (auto index = next_index.fetch_add(1); index < paths.size(); index = next_index.fetch_add(1)) {
+                const auto start = Clock::now();
+                auto steps = verify_recording(paths.at(index));
+                results.at(index) = VerifyResult{ paths.at(index), std::move(steps), Clock::now() - start };
+            }
+        };
+
+        const auto start = Clock::now();
+        {
+            std::vector<std::jthread> threads{};
+            threads.reserve(num_threads);
+            for (usize i = 0; i < num_threads; ++i) {
+                threads.emplace_back(worker);
+            }
+        }
+        const auto total_duration = Clock::now() - start;
+
+        usize num_failed = 0;
+        SimulationStep total_steps = 0;
+        for (const auto& result : results) {
+            const auto& [path, steps, duration] = result.value();
+            const auto milliseconds = to_seconds(duration) * 1000.0;
+            if (steps.has_value()) {
+                total_steps += steps.value();
+                std::cout << fmt::format(
+                        "OK     {} ({} game steps, {:.1f} ms)\n", path.string(), steps.value(), milliseconds
+                );
+            } else {
+                ++num_failed;
+                std::cout << fmt::format("FAILED {} ({:.1f} ms): {}\n", path.string(), milliseconds, steps.error());
+            }
+        }
+
+        const auto seconds = std::max(to_seconds(total_duration), 1e-9);
+        std::cout << fmt::format(
+                "\n{} of {} recordings verified in {:.2f} s using {} threads, {} failed\n", paths.size() - num_failed,
+                paths.size(), seconds, num_threads, num_failed
+        );
+        std::cout << fmt::format(
+                "throughput: {:.0f} replayed game steps/s, {:.1f} files/s\n", static_cast<double>(total_steps) / seconds,
+                static_cast<double>(paths.size()) / seconds
+        );
+
+        return num_failed == 0 ? 0 : 1;
+    } catch (const std::exception& error) {
+        std::cerr << error.what();
+        return 1;
+    }
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "./command_line_arguments.hpp"
+
+// replays all given recordings in parallel and checks their snapshots, returns the exit code
+[[nodiscard]] int verify_recordings(const Verify& verify) noexcept;
@@ -0,0 +1,104 @@
+#include "checkpoint_cache.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+
+CheckpointCache::CheckpointCache(const usize memory_budget, const SimulationStep interval)
+    : m_capacity{ std::max(memory_budget / sizeof(Entry), usize{ 1 }) },
+      m_interval{ interval } {
+    assert(interval > 0 and "interval has to be positive");
+}
+
+void CheckpointCache::save(
+        const SimulatedTetrion& tetrion,
+        const input::GameInput& input,
+        const SimulationStep simulation_step_index
+) {
+    m_playhead = simulation_step_index;
+
+    const auto index = upper_bound(simulation_step_index);
+    if (index > 0 and simulation_step_index - m_entries.at(index - 1).checkpoint.simulation_step_index < m_interval) {
+        return;
+    }
+    if (index < m_entries.size()
+        and m_entries.at(index).checkpoint.simulation_step_index - simulation_step_index < m_interval) {
+        return;
+    }
+
+    if (m_entries.size() >= m_capacity) {
+        evict();
+    }
+
+    const auto state = keyframe::State{ .tetrion = tetrion.state(), .held_keys = input.held_keys() };
+    const auto entry = Entry{
+        .checkpoint = Checkpoint{ .simulation_step_index = simulation_step_index, .state = state },
+        .last_used = ++m_use_counter,
+    };
+    m_entries.insert(m_entries.begin() + static_cast<std::ptrdiff_t>(upper_bound(simulation_step_index)), entry);
+}
+
+[[nodiscard]] std::optional<CheckpointCache::Checkpoint> CheckpointCache::newest_before(
+        const SimulationStep simulation_step_index
+) {
+    m_playhead = simulation_step_index;
+
+    const auto index = upper_bound(simulation_step_index);
+    if (index == 0) {
+        return std::nullopt;
+    }
+
+    auto& entry = m_entries.at(index - 1);
+    entry.last_used = ++m_use_counter;
+    return entry.checkpoint;
+}
+
+[[nodiscard]] usize CheckpointCache::size() const {
+    return m_entries.size();
+}
+
+[[nodiscard]] usize CheckpointCache::capacity() const {
+    return m_capacity;
+}
+
+[[nodiscard]] usize CheckpointCache::upper_bound(const SimulationStep simulation_step_index) const {
+    const auto iterator = std::ranges::upper_bound(m_entries, simulation_step_index, {}, [](const Entry& entry) {
+        return entry.checkpoint.simulation_step_index;
+    });
+    return static_cast<usize>(iterator - m_entries.begin());
+}
+
+[[nodiscard]] SimulationStep CheckpointCache::interval_at(const SimulationStep simulation_step_index) const {
+    const auto distance = simulation_step_index > m_playhead ? simulation_step_index - m_playhead
+                                                             : m_playhead - simulation_step_index;
+    const auto tier = std::bit_width(distance / (m_interval * entries_per_tier));
+    return m_interval << std::min<SimulationStep>(tier, 32);
+}
+
+void CheckpointCache::evict() {
+    assert(not m_entries.empty());
+
+    // prefer checkpoints that are denser than needed at their distance to the playhead, the least recently used first
+    std::optional<usize> evicted_index = std::nullopt;
+    for (usize index = 1; index < m_entries.size(); ++index) {
+        const auto step = m_entries.at(index).checkpoint.simulation_step_index;
+        const auto previous_step = m_entries.at(index - 1).checkpoint.simulation_step_index;
+        const auto interval = interval_at(step);
+        if (step / interval != previous_step / interval) {
+            continue;
+        }
+
+        if (not evicted_index.has_value()
+            or m_entries.at(index).last_used < m_entries.at(evicted_index.value()).last_used) {
+            evicted_index = index;
+        }
+    }
+
+    if (not evicted_index.has_value()) {
+        const auto least_recently_used = std::ranges::min_element(m_entries, {}, &Entry::last_used);
+        evicted_index = static_cast<usize>(least_recently_used - m_entries.begin());
+    }
+
+    m_entries.erase(m_entries.begin() + static_cast<std::ptrdiff_t>(evicted_index.value()));
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <core/helper/types.hpp>
+
+#include "helper/export_symbols.hpp"
+#include "input/game_input.hpp"
+#include "keyframe.hpp"
+#include "simulated_tetrion.hpp"
+
+#include <optional>
+#include <vector>
+
+// keeps states of a replay in memory while it is played, so that seeking (especially backwards) only has to simulate
+// a few steps, they are dense around the playhead and get sparser further away once the memory budget is used up
+struct CheckpointCache final {
+public:
+    struct Checkpoint {
+        SimulationStep simulation_step_index;
+        keyframe::State state;
+    };
+
+    static constexpr SimulationStep default_interval = 60;
+
+private:
+    struct Entry {
+        Checkpoint checkpoint;
+        u64 last_used;
+    };
+
+    // this many checkpoints at the smallest interval around the playhead, then the interval doubles, and so on
+    static constexpr usize entries_per_tier = 8;
+
+    // sorted by step
+    std::vector<Entry> m_entries;
+    usize m_capacity;
+    SimulationStep m_interval;
+    SimulationStep m_playhead{ 0 };
+    u64 m_use_counter{ 0 };
+
+public:
+    // keeps as many checkpoints as fit into the memory budget (in bytes), at least one every interval steps
+    OOPETRIS_GRAPHICS_EXPORTED explicit CheckpointCache(
+            usize memory_budget,
+            SimulationStep interval = default_interval
+    );
+
+    // has to be called after the given step was simulated, only stores a checkpoint if the last one is an interval ago
+    OOPETRIS_GRAPHICS_EXPORTED void
+    save(const SimulatedTetrion& tetrion, const input::GameInput& input, SimulationStep simulation_step_index);
+
+    // the newest checkpoint at or before the given step, the playhead moves to that step
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED std::optional<Checkpoint> newest_before(
+            SimulationStep simulation_step_index
+    );
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED usize size() const;
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED usize capacity() const;
+
+    // the memory one checkpoint takes up in the budget
+    [[nodiscard]] static constexpr usize bytes_per_checkpoint() {
+        return sizeof(Entry);
+    }
+
+private:
+    // the index of the first entry after the given step
+    [[nodiscard]] usize upper_bound(SimulationStep simulation_step_index) const;
+
+    // the interval that is enough at that distance to the playhead
+    [[nodiscard]] SimulationStep interval_at(SimulationStep simulation_step_index) const;
+
+    void evict();
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <core/helper/types.hpp>
+
+#include <variant>
+
+// events emitted by the simulation core, they are consumed after the step by the recorder, the ui and the music
+namespace engine {
+
+    struct Locked { };
+
+    struct LinesCleared {
+        u32 num_lines;
+    };
+
+    struct LevelUp {
+        u32 previous_level;
+        u32 level;
+    };
+
+    struct GameOver { };
+
+    struct SnapshotRequested { };
+
+    struct StateHashRequested { };
+
+    using Event = std::variant<Locked, LinesCleared, LevelUp, GameOver, SnapshotRequested, StateHashRequested>;
+
+    struct StepEvent {
+        SimulationStep simulation_step_index;
+        Event event;
+    };
+
+} // namespace engine
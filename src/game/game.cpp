@@ -5,6 +5,7 @@
 
 #include "game.hpp"
 #include "input/replay_input.hpp"
+#include "keyframe.hpp"
 
 Game::Game(
         ServiceProvider* const service_provider,
@@ -16,17 +17,22 @@ Game::Game(
 )
     : ui::Widget{ layout, ui::WidgetType::Component, is_top_level },
       m_clock_source{ std::make_unique<LocalClock>(simulation_frequency) },
-      m_input{ input } {
+      m_input{ input },
+      m_recording_writer{ starting_parameters.recording_writer },
+      m_next_keyframe_simulation_step_index{ keyframe::interval },
+      m_initial_state{ starting_parameters.seed, starting_parameters.starting_level, 0,
+                       starting_parameters.random_algorithm } {
 
 
     spdlog::info("starting level for tetrion {}", starting_parameters.starting_level);
 
     m_tetrion = std::make_unique<Tetrion>(
             starting_parameters.tetrion_index, starting_parameters.seed, starting_parameters.starting_level,
-            service_provider, starting_parameters.recording_writer, layout, false
+            service_provider, starting_parameters.recording_writer, layout, false, starting_parameters.random_algorithm
     );
 
     m_tetrion->spawn_next_tetromino(0);
+    m_initial_state = m_tetrion->state();
 
     m_input->set_target_tetrion(m_tetrion.get());
     if (starting_parameters.recording_writer.has_value()) {
@@ -53,11 +59,98 @@ void Game::update() {
         set_paused(false);
     }
 
-    while (m_simulation_step_index < m_clock_source->simulation_step_index()) {
-        ++m_simulation_step_index;
+    if (m_is_max_speed) {
+        simulate_until(m_input->next_active_step(m_simulation_step_index));
+        m_clock_source->seek(m_simulation_step_index);
+        return;
+    }
+
+    simulate_until(m_clock_source->simulation_step_index());
+}
+
+void Game::set_playback_speed(const std::optional<double> speed) {
+    m_is_max_speed = not speed.has_value();
+    if (speed.has_value()) {
+        m_clock_source->seek(m_simulation_step_index);
+        m_clock_source->set_speed(speed.value());
+    }
+}
+
+void Game::skip_to_end() {
+    assert(utils::is_child_class<input::ReplayGameInput>(m_input).has_value() and "only replays have an end");
+
+    // only the final state is shown, so the texts and the music are updated once at the end
+    const auto previous_level = m_tetrion->level();
+    while (not is_game_finished()) {
+        simulate_until(m_input->next_active_step(m_simulation_step_index), true);
+    }
+    m_tetrion->refresh_presentation(previous_level);
+    m_clock_source->seek(m_simulation_step_index);
+}
+
+void Game::seek(const SimulationStep simulation_step_index) {
+    const auto input_as_replay = utils::is_child_class<input::ReplayGameInput>(m_input);
+    assert(input_as_replay.has_value() and "only replays can be seeked");
+
+    m_simulation_step_index = keyframe::restore_closest(
+            *m_tetrion, *input_as_replay.value(), m_initial_state, m_simulation_step_index, simulation_step_index
+    );
+
+    // a checkpoint of this session is usually closer than any keyframe of the recording
+    if (m_checkpoints.has_value()) {
+        if (const auto checkpoint = m_checkpoints->newest_before(simulation_step_index);
+            checkpoint.has_value() and checkpoint->simulation_step_index > m_simulation_step_index) {
+            m_tetrion->restore_state(checkpoint->state.tetrion);
+            input_as_replay.value()->seek(checkpoint->simulation_step_index, checkpoint->state.held_keys);
+            m_simulation_step_index = checkpoint->simulation_step_index;
+        }
+    }
+
+    simulate_until(simulation_step_index);
+
+    m_clock_source->seek(m_simulation_step_index);
+}
+
+void Game::enable_checkpoints(const usize memory_budget) {
+    assert(utils::is_child_class<input::ReplayGameInput>(m_input).has_value() and "only replays can be seeked");
+
+    m_checkpoints.emplace(memory_budget);
+}
+
+[[nodiscard]] SimulationStep Game::simulation_step_index() const {
+    return m_simulation_step_index;
+}
+
+void Game::simulate_until(const SimulationStep target_simulation_step_index, const bool is_headless) {
+    while (m_simulation_step_index < target_simulation_step_index) {
+        // idle steps are skipped, for live input this is always the next step
+        const auto next_simulation_step_index = m_input->next_active_step(m_simulation_step_index);
+        if (next_simulation_step_index > target_simulation_step_index) {
+            m_simulation_step_index = target_simulation_step_index;
+            break;
+        }
+
+        m_simulation_step_index = next_simulation_step_index;
         m_input->update(m_simulation_step_index);
         m_tetrion->update_step(m_simulation_step_index);
         m_input->late_update(m_simulation_step_index);
+        if (is_headless) {
+            m_tetrion->SimulatedTetrion::dispatch_events();
+        } else {
+            m_tetrion->dispatch_events();
+        }
+
+        if (m_checkpoints.has_value()) {
+            m_checkpoints->save(*m_tetrion, *m_input, m_simulation_step_index);
+        }
+
+        if (m_recording_writer.has_value() and m_simulation_step_index >= m_next_keyframe_simulation_step_index) {
+            //TODO(Totto): Remove all occurrences of std::ignore, where we shouldn't ignore this return value
+            std::ignore = m_recording_writer.value()->add_keyframe(
+                    m_tetrion->tetrion_index(), m_simulation_step_index, keyframe::to_bytes(*m_tetrion, *m_input)
+            );
+            m_next_keyframe_simulation_step_index = m_simulation_step_index + keyframe::interval;
+        }
     }
 }
 
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <recordings/utility/recording.hpp>
+#include <recordings/utility/recording_writer.hpp>
 
+#include "checkpoint_cache.hpp"
 #include "helper/clock_source.hpp"
 #include "helper/export_symbols.hpp"
 #include "input/input_creator.hpp"
@@ -17,6 +19,15 @@ private:
     std::unique_ptr<Tetrion> m_tetrion;
     std::shared_ptr<input::GameInput> m_input;
     bool m_is_paused{ false };
+    std::optional<std::shared_ptr<recorder::RecordingWriter>> m_recording_writer;
+    SimulationStep m_next_keyframe_simulation_step_index;
+    // seeking backwards in a replay without any keyframe has to start from here
+    TetrionState m_initial_state;
+    // simulates one step with input or game events per update, instead of following the clock, the scene decides how
+    // many updates fit into a frame
+    bool m_is_max_speed{ false };
+    // only used by replays, see enable_checkpoints
+    std::optional<CheckpointCache> m_checkpoints;
 
 public:
     OOPETRIS_GRAPHICS_EXPORTED explicit Game(
@@ -30,6 +41,21 @@ public:
 
     OOPETRIS_GRAPHICS_EXPORTED void update() override;
 
+    // only supported for replays, continues the replay at the given step
+    OOPETRIS_GRAPHICS_EXPORTED void seek(SimulationStep simulation_step_index);
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED SimulationStep simulation_step_index() const;
+
+    // a multiple of the simulation frequency, or std::nullopt to simulate as fast as possible
+    OOPETRIS_GRAPHICS_EXPORTED void set_playback_speed(std::optional<double> speed);
+
+    // only supported for replays, simulates the rest of the replay at once
+    OOPETRIS_GRAPHICS_EXPORTED void skip_to_end();
+
+    // only supported for replays, keeps states of the played steps in memory (at most memory_budget bytes), so that
+    // seeking back to them doesn't depend on the keyframes of the recording
+    OOPETRIS_GRAPHICS_EXPORTED void enable_checkpoints(usize memory_budget);
+
     OOPETRIS_GRAPHICS_EXPORTED void render(const ServiceProvider& service_provider) const override;
 
     [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED Widget::EventHandleResult
@@ -42,4 +68,9 @@ public:
     [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED bool is_game_finished() const;
 
     [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED const std::shared_ptr<input::GameInput>& game_input() const;
+
+private:
+    // simulates all steps up to the given one, skipping idle steps, without the ui and the music (is_headless) the
+    // events of the steps are only dispatched to the simulation itself
+    void simulate_until(SimulationStep target_simulation_step_index, bool is_headless = false);
 };
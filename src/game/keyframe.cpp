@@ -0,0 +1,405 @@
+#include <core/helper/magic_enum_wrapper.hpp>
+#include <recordings/utility/helper.hpp>
+#include <recordings/utility/mapped_file.hpp>
+
+#include "helper/spdlog_wrapper.hpp"
+#include "keyframe.hpp"
+
+#include <algorithm>
+#include <istream>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+    // has to be increased, whenever a field is added, removed or changes its meaning
+    constexpr u32 format_version = 2;
+
+    // the steps in the state are at most a gravity delay, the lock delay or the auto shift delay ahead of the keyframe,
+    // this is far more than any of them, but keeps a forged keyframe from stalling the replay
+    constexpr SimulationStep max_step_distance = keyframe::interval;
+
+    template<typename Integral>
+    void append(std::vector<char>& bytes, const Integral value) {
+        helper::writer::append_value(bytes, value);
+    }
+
+    void append_bool(std::vector<char>& bytes, const bool value) {
+        append<u8>(bytes, value ? 1 : 0);
+    }
+
+    void append_tetromino(std::vector<char>& bytes, const std::optional<Tetromino>& tetromino) {
+        append_bool(bytes, tetromino.has_value());
+        if (not tetromino.has_value()) {
+            return;
+        }
+
+        static_assert(sizeof(std::underlying_type_t<helper::TetrominoType>) == 1);
+        append(bytes, std::to_underlying(tetromino->type()));
+        static_assert(sizeof(std::underlying_type_t<Rotation>) == 1);
+        append(bytes, std::to_underlying(tetromino->rotation()));
+        static_assert(sizeof(grid::GridType) == 1);
+        append(bytes, tetromino->position().x);
+        append(bytes, tetromino->position().y);
+    }
+
+    void append_held_key(std::vector<char>& bytes, const std::optional<SimulationStep>& held_since) {
+        append_bool(bytes, held_since.has_value());
+        append<u64>(bytes, held_since.value_or(0));
+    }
+
+    // reads the fields in the order they are appended, every value is validated, as recordings come from anywhere
+    struct StateReader {
+        std::istream& istream;
+        // the first error, the following fields are skipped, so that it only has to be checked now and then
+        std::optional<std::string> error;
+
+        template<typename Target, typename Value>
+        void read_into(Target& target, helper::expected<Value, std::string>&& field) {
+            if (error.has_value()) {
+                return;
+            }
+            if (not field.has_value()) {
+                error = std::move(field.error());
+                return;
+            }
+            target = std::move(field.value());
+        }
+
+        template<typename Integral>
+        [[nodiscard]] helper::expected<Integral, std::string> read(const std::string_view name) {
+            const auto value = helper::reader::read_from_istream<Integral>(istream);
+            if (not value.has_value()) {
+                return helper::unexpected<std::string>{ fmt::format("unable to read {} from keyframe", name) };
+            }
+            return value.value();
+        }
+
+        [[nodiscard]] helper::expected<bool, std::string> read_bool(const std::string_view name) {
+            const auto value = read<u8>(name);
+            if (not value.has_value()) {
+                return helper::unexpected<std::string>{ value.error() };
+            }
+            if (value.value() > 1) {
+                return helper::unexpected<std::string>{
+                    fmt::format("got invalid value for {} in keyframe: {}", name, value.value())
+                };
+            }
+            return value.value() == 1;
+        }
+
+        template<typename Enum>
+        [[nodiscard]] helper::expected<Enum, std::string> read_enum(const std::string_view name) {
+            const auto value = read<std::underlying_type_t<Enum>>(name);
+            if (not value.has_value()) {
+                return helper::unexpected<std::string>{ value.error() };
+            }
+            const auto result = magic_enum::enum_cast<Enum>(value.value());
+            if (not result.has_value()) {
+                return helper::unexpected<std::string>{
+                    fmt::format("got invalid value for {} in keyframe: {}", name, value.value())
+                };
+            }
+            return result.value();
+        }
+
+        [[nodiscard]] helper::expected<std::optional<Tetromino>, std::string> read_tetromino(
+                const std::string_view name
+        ) {
+            const auto has_value = read_bool(name);
+            if (not has_value.has_value()) {
+                return helper::unexpected<std::string>{ has_value.error() };
+            }
+            if (not has_value.value()) {
+                return std::nullopt;
+            }
+
+            const auto type = read_enum<helper::TetrominoType>(name);
+            if (not type.has_value()) {
+                return helper::unexpected<std::string>{ type.error() };
+            }
+            const auto rotation = read_enum<Rotation>(name);
+            if (not rotation.has_value()) {
+                return helper::unexpected<std::string>{ rotation.error() };
+            }
+            const auto x_coord = read<grid::GridType>(name);
+            if (not x_coord.has_value()) {
+                return helper::unexpected<std::string>{ x_coord.error() };
+            }
+            const auto y_coord = read<grid::GridType>(name);
+            if (not y_coord.has_value()) {
+                return helper::unexpected<std::string>{ y_coord.error() };
+            }
+
+            auto tetromino = Tetromino{ grid::GridPoint{ x_coord.value(), y_coord.value() }, type.value() };
+            while (tetromino.rotation() != rotation.value()) {
+                tetromino.rotate_right();
+            }
+            return tetromino;
+        }
+
+        [[nodiscard]] helper::expected<std::optional<SimulationStep>, std::string> read_held_key(
+                const std::string_view name
+        ) {
+            const auto is_held = read_bool(name);
+            if (not is_held.has_value()) {
+                return helper::unexpected<std::string>{ is_held.error() };
+            }
+            const auto held_since = read<u64>(name);
+            if (not held_since.has_value()) {
+                return helper::unexpected<std::string>{ held_since.error() };
+            }
+            return is_held.value() ? std::optional{ held_since.value() } : std::nullopt;
+        }
+    };
+
+    // the falling and the ghost tetromino have to be inside of the grid and must not overlap the stack
+    [[nodiscard]] bool is_on_free_cells(const Tetromino& tetromino, const MinoStack& mino_stack) {
+        return std::ranges::all_of(tetromino.minos(), [&mino_stack](const Mino& mino) {
+            const auto& position = mino.position();
+            return position.x >= 0 and position.x < grid::width_in_tiles and position.y >= 0
+                   and position.y < grid::height_in_tiles and mino_stack.is_empty(position);
+        });
+    }
+
+    [[nodiscard]] helper::expected<keyframe::State, std::string> read_state(
+            std::istream& istream,
+            const SimulationStep simulation_step_index,
+            const TetrionState& initial_state
+    ) {
+        auto reader = StateReader{ .istream = istream, .error = std::nullopt };
+
+        Random::Seed random_seed{};
+        reader.read_into(random_seed, reader.read<Random::Seed>("random seed"));
+        RandomAlgorithm random_algorithm{};
+        reader.read_into(random_algorithm, reader.read_enum<RandomAlgorithm>("random algorithm"));
+        u32 level{};
+        reader.read_into(level, reader.read<u32>("level"));
+        u64 lock_delay_step_index{};
+        reader.read_into(lock_delay_step_index, reader.read<u64>("lock delay step"));
+        if (reader.error.has_value()) {
+            return helper::unexpected<std::string>{ reader.error.value() };
+        }
+
+        // the piece sequence and the starting level come from the header of the recording, a keyframe can't change them
+        if (random_seed != initial_state.random_seed or random_algorithm != initial_state.random_algorithm) {
+            return helper::unexpected<std::string>{ "keyframe has another piece sequence than the recording" };
+        }
+        if (level < initial_state.level) {
+            return helper::unexpected<std::string>{
+                fmt::format("keyframe has level {}, but the recording starts at {}", level, initial_state.level)
+            };
+        }
+
+        auto state = keyframe::State{
+            .tetrion = TetrionState{ random_seed, level, lock_delay_step_index, random_algorithm },
+            .held_keys = {},
+        };
+        auto& tetrion = state.tetrion;
+
+        reader.read_into(tetrion.lines_cleared, reader.read<u32>("lines cleared"));
+        reader.read_into(tetrion.score, reader.read<u64>("score"));
+        reader.read_into(tetrion.num_locked_tetrominos, reader.read<u32>("number of locked tetrominos"));
+        reader.read_into(tetrion.is_accelerated_down_movement, reader.read_bool("accelerated movement"));
+        reader.read_into(tetrion.down_key_pressed, reader.read_bool("down key"));
+        reader.read_into(tetrion.allowed_to_hold, reader.read_bool("allowed to hold"));
+        reader.read_into(tetrion.is_in_lock_delay, reader.read_bool("lock delay"));
+        reader.read_into(tetrion.num_executed_lock_delays, reader.read<u32>("number of lock delays"));
+        reader.read_into(tetrion.next_gravity_simulation_step_index, reader.read<u64>("gravity step"));
+        reader.read_into(tetrion.game_state, reader.read_enum<GameState>("game state"));
+        reader.read_into(tetrion.sequence_position, reader.read<u64>("sequence position"));
+
+        // the stack is rebuilt mino by mino, so that all of its planes and its hash are consistent
+        u32 num_minos{};
+        reader.read_into(num_minos, reader.read<u32>("number of minos"));
+        if (reader.error.has_value()) {
+            return helper::unexpected<std::string>{ reader.error.value() };
+        }
+        if (num_minos > MinoStack::width * MinoStack::height) {
+            return helper::unexpected<std::string>{ fmt::format("keyframe has too many minos: {}", num_minos) };
+        }
+        for (u32 i = 0; i < num_minos; ++i) {
+            grid::GridType x_coord{};
+            reader.read_into(x_coord, reader.read<grid::GridType>("mino"));
+            grid::GridType y_coord{};
+            reader.read_into(y_coord, reader.read<grid::GridType>("mino"));
+            helper::TetrominoType type{};
+            reader.read_into(type, reader.read_enum<helper::TetrominoType>("mino"));
+            if (reader.error.has_value()) {
+                return helper::unexpected<std::string>{ reader.error.value() };
+            }
+
+            const auto position = grid::GridPoint{ x_coord, y_coord };
+            if (x_coord < 0 or x_coord >= grid::width_in_tiles or y_coord < 0 or y_coord >= grid::height_in_tiles
+                or not tetrion.mino_stack.is_empty(position)) {
+                return helper::unexpected<std::string>{
+                    fmt::format("invalid mino position in keyframe: ({}, {})", x_coord, y_coord)
+                };
+            }
+            tetrion.mino_stack.set(position, type);
+        }
+
+        reader.read_into(tetrion.active_tetromino, reader.read_tetromino("active tetromino"));
+        reader.read_into(tetrion.ghost_tetromino, reader.read_tetromino("ghost tetromino"));
+        reader.read_into(tetrion.tetromino_on_hold, reader.read_tetromino("tetromino on hold"));
+
+        reader.read_into(state.held_keys.left, reader.read_held_key("left key"));
+        reader.read_into(state.held_keys.right, reader.read_held_key("right key"));
+        if (reader.error.has_value()) {
+            return helper::unexpected<std::string>{ reader.error.value() };
+        }
+
+        for (const auto& tetromino : { tetrion.active_tetromino, tetrion.ghost_tetromino }) {
+            if (tetromino.has_value() and not is_on_free_cells(tetromino.value(), tetrion.mino_stack)) {
+                return helper::unexpected<std::string>{ "keyframe has a tetromino outside of the free cells" };
+            }
+        }
+        if (tetrion.tetromino_on_hold.has_value()
+            and (tetrion.tetromino_on_hold->position() != grid::hold_tetromino_position
+                 or tetrion.tetromino_on_hold->rotation() != Rotation::North)) {
+            return helper::unexpected<std::string>{ "keyframe has an invalid tetromino on hold" };
+        }
+
+        const auto max_simulation_step_index = simulation_step_index + max_step_distance;
+        for (const auto& [name, step] : {
+                     std::pair{ "lock delay step", std::optional{ tetrion.lock_delay_step_index } },
+                     std::pair{ "gravity step", std::optional{ tetrion.next_gravity_simulation_step_index } },
+                     std::pair{ "left key", state.held_keys.left },
+                     std::pair{ "right key", state.held_keys.right },
+             }) {
+            if (step.has_value() and step.value() > max_simulation_step_index) {
+                return helper::unexpected<std::string>{ fmt::format(
+                        "{} of keyframe at step {} is too far ahead: {}", name, simulation_step_index, step.value()
+                ) };
+            }
+        }
+
+        return state;
+    }
+
+} // namespace
+
+
+[[nodiscard]] std::vector<char> keyframe::to_bytes(const SimulatedTetrion& tetrion, const input::GameInput& input) {
+    const auto& state = tetrion.state();
+    const auto held_keys = input.held_keys();
+
+    auto bytes = std::vector<char>{};
+
+    append(bytes, format_version);
+
+    static_assert(sizeof(Random::Seed) == 8);
+    append(bytes, state.random_seed);
+    static_assert(sizeof(std::underlying_type_t<RandomAlgorithm>) == 1);
+    append(bytes, std::to_underlying(state.random_algorithm));
+    append<u32>(bytes, state.level);
+    append<u64>(bytes, state.lock_delay_step_index);
+
+    append<u32>(bytes, state.lines_cleared);
+    append<u64>(bytes, state.score);
+    append<u32>(bytes, state.num_locked_tetrominos);
+    append_bool(bytes, state.is_accelerated_down_movement);
+    append_bool(bytes, state.down_key_pressed);
+    append_bool(bytes, state.allowed_to_hold);
+    append_bool(bytes, state.is_in_lock_delay);
+    append<u32>(bytes, state.num_executed_lock_delays);
+    append<u64>(bytes, state.next_gravity_simulation_step_index);
+    static_assert(sizeof(std::underlying_type_t<GameState>) == 1);
+    append(bytes, std::to_underlying(state.game_state));
+    append<u64>(bytes, state.sequence_position);
+
+    const auto minos = state.mino_stack.minos();
+    append(bytes, static_cast<u32>(minos.size()));
+    for (const auto& mino : minos) {
+        append(bytes, mino.position().x);
+        append(bytes, mino.position().y);
+        append(bytes, std::to_underlying(mino.type()));
+    }
+
+    append_tetromino(bytes, state.active_tetromino);
+    append_tetromino(bytes, state.ghost_tetromino);
+    append_tetromino(bytes, state.tetromino_on_hold);
+
+    append_held_key(bytes, held_keys.left);
+    append_held_key(bytes, held_keys.right);
+
+    return bytes;
+}
+
+[[nodiscard]] helper::expected<keyframe::State, std::string> keyframe::from_bytes(
+        const std::vector<char>& bytes,
+        const SimulationStep simulation_step_index,
+        const TetrionState& initial_state
+) {
+    auto buffer = helper::ByteStreamBuffer{ std::as_bytes(std::span{ bytes }) };
+    auto istream = std::istream{ &buffer };
+
+    const auto version = helper::reader::read_from_istream<u32>(istream);
+    if (not version.has_value()) {
+        return helper::unexpected<std::string>{ "unable to read format version from keyframe" };
+    }
+    if (version.value() != format_version) {
+        return helper::unexpected<std::string>{ fmt::format(
+                "keyframe has format version {}, but only {} is supported", version.value(), format_version
+        ) };
+    }
+
+    auto state = read_state(istream, simulation_step_index, initial_state);
+    if (not state.has_value()) {
+        return state;
+    }
+
+    if (buffer.position() != bytes.size()) {
+        return helper::unexpected<std::string>{
+            fmt::format("keyframe has {} bytes, but only {} were read", bytes.size(), buffer.position())
+        };
+    }
+
+    return state;
+}
+
+[[nodiscard]] SimulationStep keyframe::restore_closest(
+        SimulatedTetrion& tetrion,
+        input::ReplayGameInput& input,
+        const TetrionState& initial_state,
+        const SimulationStep current_simulation_step_index,
+        const SimulationStep target_simulation_step_index
+) {
+    const auto can_continue = target_simulation_step_index >= current_simulation_step_index;
+
+    if (const auto* keyframe = input.keyframe_before(target_simulation_step_index); keyframe != nullptr) {
+        const auto keyframe_simulation_step_index = keyframe->simulation_step_index();
+        if (can_continue and keyframe_simulation_step_index <= current_simulation_step_index) {
+            return current_simulation_step_index;
+        }
+
+        const auto state = from_bytes(keyframe->state(), keyframe_simulation_step_index, initial_state);
+        if (state.has_value()) {
+            const auto previous_state = tetrion.state();
+            tetrion.restore_state(state->tetrion);
+
+            // the state hash of the same step was computed from the live game, so it shows whether the keyframe really
+            // is the state, that the recording reached there, the steps after it are checked by the replay itself
+            if (input.matches_recorded_state_hash(keyframe_simulation_step_index)) {
+                input.seek(keyframe_simulation_step_index, state->held_keys);
+                return keyframe_simulation_step_index;
+            }
+
+            tetrion.restore_state(previous_state);
+            spdlog::warn(
+                    "ignoring keyframe at step {}: it doesn't match the recorded state hash",
+                    keyframe_simulation_step_index
+            );
+        } else {
+            spdlog::warn("ignoring keyframe at step {}: {}", keyframe_simulation_step_index, state.error());
+        }
+    }
+
+    if (can_continue) {
+        return current_simulation_step_index;
+    }
+
+    tetrion.restore_state(initial_state);
+    input.seek(0, {});
+    return 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <core/helper/expected.hpp>
+#include <core/helper/types.hpp>
+
+#include "helper/export_symbols.hpp"
+#include "input/game_input.hpp"
+#include "input/replay_input.hpp"
+#include "simulated_tetrion.hpp"
+#include "tetrion_state.hpp"
+
+#include <type_traits>
+#include <vector>
+
+namespace keyframe {
+
+    // ten seconds at the default simulation frequency, a seek never has to simulate more steps than that
+    constexpr SimulationStep interval = 600;
+
+    // everything that is needed to resume a replay: the tetrion and the auto shift state of its input
+    struct State final {
+        TetrionState tetrion;
+        input::GameInput::HeldKeys held_keys;
+    };
+
+    static_assert(std::is_trivially_copyable_v<State>);
+
+    // every field is stored on its own in little endian, keyframes of another format version or with invalid values are
+    // ignored and the replay is simulated from an earlier state instead
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED std::vector<char>
+    to_bytes(const SimulatedTetrion& tetrion, const input::GameInput& input);
+
+    // the keyframe has to fit to the recording, i.e. to the initial state from its header (same seed, random algorithm
+    // and at least the starting level), and its steps must not be far ahead of the step of the keyframe
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED helper::expected<State, std::string> from_bytes(
+            const std::vector<char>& bytes,
+            SimulationStep simulation_step_index,
+            const TetrionState& initial_state
+    );
+
+    // restores the closest known state from which the given step can be reached and returns its step, that is the
+    // latest keyframe before the target, the initial state or, if that is closer, the current state (which is kept),
+    // a keyframe that doesn't match the state hash recorded at its step is ignored
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED SimulationStep restore_closest(
+            SimulatedTetrion& tetrion,
+            input::ReplayGameInput& input,
+            const TetrionState& initial_state,
+            SimulationStep current_simulation_step_index,
+            SimulationStep target_simulation_step_index
+    );
+
+} // namespace keyframe
@@ -0,0 +1,117 @@
+#include "piece_sequence.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+    // draws types until one isn't in the bag yet, that keeps the draws of the recordings that used single bags
+    void append_bag(Random& random, std::vector<helper::TetrominoType>& types) {
+        u32 used_types = 0;
+        for (usize i = 0; i < PieceSequence::bag_size; ++i) {
+            while (true) {
+                const auto type = random.random(static_cast<int>(PieceSequence::bag_size));
+                const auto mask = u32{ 1 } << static_cast<u32>(type);
+                if ((used_types & mask) == 0) {
+                    used_types |= mask;
+                    types.push_back(static_cast<helper::TetrominoType>(type));
+                    break;
+                }
+            }
+        }
+    }
+
+} // namespace
+
+PieceSequence::PieceSequence(const Random::Seed seed, const RandomAlgorithm random_algorithm)
+    : m_random{ seed, random_algorithm } { }
+
+[[nodiscard]] Random::Seed PieceSequence::seed() const {
+    return m_random.seed();
+}
+
+[[nodiscard]] RandomAlgorithm PieceSequence::random_algorithm() const {
+    return m_random.algorithm();
+}
+
+[[nodiscard]] u64 PieceSequence::num_generated() const {
+    return m_first_index + m_types.size();
+}
+
+[[nodiscard]] usize PieceSequence::num_cached() const {
+    return m_types.size();
+}
+
+[[nodiscard]] std::span<const helper::TetrominoType> PieceSequence::get(const u64 first_index, const usize count) {
+    if (first_index < m_first_index) {
+        restart_at(first_index);
+    }
+
+    generate_until(first_index + count);
+    return generated(first_index, count);
+}
+
+[[nodiscard]] std::span<const helper::TetrominoType>
+PieceSequence::generated(const u64 first_index, const usize count) const {
+    assert(first_index >= m_first_index and first_index + count <= num_generated());
+    return std::span{ m_types }.subspan(static_cast<usize>(first_index - m_first_index), count);
+}
+
+[[nodiscard]] helper::TetrominoType PieceSequence::at(const u64 index) {
+    return get(index, 1).front();
+}
+
+void PieceSequence::discard_before(const u64 index) {
+    if (index <= m_first_index) {
+        return;
+    }
+
+    // dropping only a few types at a time would move the rest of the window every time
+    const auto num_bags = static_cast<usize>(std::min(index, num_generated()) - m_first_index) / bag_size;
+    if (num_bags < min_generated_bags) {
+        return;
+    }
+
+    m_types.erase(m_types.begin(), m_types.begin() + static_cast<std::ptrdiff_t>(num_bags * bag_size));
+    m_first_index += num_bags * bag_size;
+}
+
+[[nodiscard]] std::vector<helper::TetrominoType>
+PieceSequence::generate(const Random::Seed seed, const RandomAlgorithm random_algorithm, const usize count) {
+    auto random = Random{ seed, random_algorithm };
+
+    std::vector<helper::TetrominoType> result{};
+    result.reserve((count + bag_size - 1) / bag_size * bag_size);
+    while (result.size() < count) {
+        append_bag(random, result);
+    }
+
+    result.resize(count);
+    return result;
+}
+
+void PieceSequence::generate_until(const u64 end_index) {
+    if (num_generated() >= end_index) {
+        return;
+    }
+
+    const auto num_missing = static_cast<usize>(end_index - num_generated());
+    const auto num_bags = std::max((num_missing + bag_size - 1) / bag_size, min_generated_bags);
+    m_types.reserve(m_types.size() + num_bags * bag_size);
+    for (usize i = 0; i < num_bags; ++i) {
+        append_bag(m_random, m_types);
+    }
+}
+
+void PieceSequence::restart_at(const u64 first_index) {
+    m_random = Random{ seed(), random_algorithm() };
+    m_types.clear();
+    m_first_index = 0;
+
+    const auto first_bag = first_index / bag_size;
+    for (u64 bag = 0; bag < first_bag; ++bag) {
+        append_bag(m_random, m_types);
+        m_types.clear();
+    }
+    m_first_index = first_bag * bag_size;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <core/game/tetromino_type.hpp>
+#include <core/helper/random.hpp>
+#include <core/helper/types.hpp>
+
+#include "../helper/export_symbols.hpp"
+
+#include <span>
+#include <vector>
+
+// the endless sequence of tetromino types of a tetrion, every 7 pieces form a bag with each type exactly once
+// it only depends on the seed and the random algorithm, so it is generated in bulk and cached, previews and lookahead
+// searches (e.g. of bots) index it directly, only a window of it is cached, the consumed bags are dropped by
+// discard_before, so the cache stays small, no matter how long the game runs
+struct PieceSequence final {
+public:
+    static constexpr usize bag_size = static_cast<usize>(helper::TetrominoType::LastType) + 1;
+
+    // missing pieces are generated in batches of at least this many bags, consumed ones are dropped in batches of that
+    // many bags as well
+    static constexpr usize min_generated_bags = 16;
+
+    // the cache never holds more than this many types plus the furthest index, that was requested past the position
+    // given to discard_before
+    static constexpr usize max_cached_without_lookahead = 2 * min_generated_bags * bag_size;
+
+private:
+    Random m_random;
+    // the index of m_types.front() in the sequence, always the start of a bag
+    u64 m_first_index{ 0 };
+    std::vector<helper::TetrominoType> m_types;
+
+public:
+    OOPETRIS_GRAPHICS_EXPORTED PieceSequence(Random::Seed seed, RandomAlgorithm random_algorithm);
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED Random::Seed seed() const;
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED RandomAlgorithm random_algorithm() const;
+
+    // the index after the last generated type
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED u64 num_generated() const;
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED usize num_cached() const;
+
+    // the types from first_index on, missing ones are generated first, an index before the cached window generates the
+    // sequence again from its start
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED std::span<const helper::TetrominoType>
+    get(u64 first_index, usize count);
+
+    // the same, but without generating, so the range has to be cached already
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED std::span<const helper::TetrominoType>
+    generated(u64 first_index, usize count) const;
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED helper::TetrominoType at(u64 index);
+
+    // the types before that index won't be needed anymore (until the sequence is rewound)
+    OOPETRIS_GRAPHICS_EXPORTED void discard_before(u64 index);
+
+    // the first count types of that seed in one pass, without keeping a cache around
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED static std::vector<helper::TetrominoType>
+    generate(Random::Seed seed, RandomAlgorithm random_algorithm, usize count);
+
+private:
+    void generate_until(u64 end_index);
+
+    // starts the cache again at the bag of that index, the earlier bags are still drawn, but not kept
+    void restart_at(u64 first_index);
+};
@@ -0,0 +1,83 @@
+#include "rollback_buffer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <fmt/format.h>
+
+
+RollbackBuffer::RollbackBuffer(const usize capacity, const SimulationStep interval)
+    : m_capacity{ capacity },
+      m_interval{ interval } {
+    assert(capacity > 0 and interval > 0 and "capacity and interval have to be positive");
+    m_entries.reserve(capacity);
+}
+
+void RollbackBuffer::save(const SimulatedTetrion& tetrion, const SimulationStep simulation_step_index) {
+    if (simulation_step_index % m_interval != 0) {
+        return;
+    }
+
+    assert((not newest_step().has_value() or newest_step().value() < simulation_step_index)
+           and "states have to be saved in order");
+
+    if (m_next_index == m_entries.size()) {
+        m_entries.push_back(Entry{ simulation_step_index, tetrion.state() });
+    } else {
+        m_entries.at(m_next_index) = Entry{ simulation_step_index, tetrion.state() };
+    }
+
+    m_next_index = (m_next_index + 1) % m_capacity;
+    m_size = std::min(m_size + 1, m_capacity);
+}
+
+[[nodiscard]] helper::expected<SimulationStep, std::string>
+RollbackBuffer::rollback_to(SimulatedTetrion& tetrion, const SimulationStep simulation_step_index) {
+    // newest entries first, so the common case of a short rollback is found quickly
+    for (usize age = 0; age < m_size; ++age) {
+        const auto index = entry_index(age);
+        const auto& entry = m_entries.at(index);
+        if (entry.simulation_step_index > simulation_step_index) {
+            continue;
+        }
+
+        tetrion.restore_state(entry.state);
+
+        // the discarded states belonged to the old inputs, the next saves overwrite them
+        m_size -= age;
+        m_next_index = (index + 1) % m_capacity;
+
+        return entry.simulation_step_index;
+    }
+
+    return helper::unexpected<std::string>{ fmt::format(
+            "can't roll back to step {}, the oldest saved state is from step {}", simulation_step_index,
+            oldest_step().has_value() ? fmt::format("{}", oldest_step().value()) : "<none>"
+    ) };
+}
+
+[[nodiscard]] usize RollbackBuffer::size() const {
+    return m_size;
+}
+
+[[nodiscard]] usize RollbackBuffer::capacity() const {
+    return m_capacity;
+}
+
+[[nodiscard]] std::optional<SimulationStep> RollbackBuffer::oldest_step() const {
+    if (m_size == 0) {
+        return std::nullopt;
+    }
+    return m_entries.at(entry_index(m_size - 1)).simulation_step_index;
+}
+
+[[nodiscard]] std::optional<SimulationStep> RollbackBuffer::newest_step() const {
+    if (m_size == 0) {
+        return std::nullopt;
+    }
+    return m_entries.at(entry_index(0)).simulation_step_index;
+}
+
+[[nodiscard]] usize RollbackBuffer::entry_index(const usize age) const {
+    assert(age < m_size and "entry out of range");
+    return (m_next_index + m_capacity - 1 - age) % m_capacity;
+}
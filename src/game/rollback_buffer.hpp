@@ -0,0 +1,51 @@
+#pragma once
+
+#include <core/helper/expected.hpp>
+#include <core/helper/types.hpp>
+
+#include "helper/export_symbols.hpp"
+#include "simulated_tetrion.hpp"
+#include "tetrion_state.hpp"
+
+#include <string>
+#include <vector>
+
+// keeps the states of the last steps of a tetrion, so that it can be rewound and re-simulated with corrected inputs,
+// saving and restoring each copy a single TetrionState and never allocate
+struct RollbackBuffer final {
+private:
+    struct Entry {
+        SimulationStep simulation_step_index;
+        TetrionState state;
+    };
+
+    // ring storage, it is allocated once and then only overwritten
+    std::vector<Entry> m_entries;
+    usize m_capacity;
+    usize m_next_index{ 0 };
+    usize m_size{ 0 };
+    SimulationStep m_interval;
+
+public:
+    // keeps at most capacity states, one for every step that is a multiple of interval
+    OOPETRIS_GRAPHICS_EXPORTED explicit RollbackBuffer(usize capacity, SimulationStep interval = 1);
+
+    // has to be called after the given step was simulated
+    OOPETRIS_GRAPHICS_EXPORTED void save(const SimulatedTetrion& tetrion, SimulationStep simulation_step_index);
+
+    // restores the newest state that was saved at or before the given step, all newer states are discarded
+    // returns the step of the restored state, the simulation has to continue with the step after it
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED helper::expected<SimulationStep, std::string>
+    rollback_to(SimulatedTetrion& tetrion, SimulationStep simulation_step_index);
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED usize size() const;
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED usize capacity() const;
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED std::optional<SimulationStep> oldest_step() const;
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED std::optional<SimulationStep> newest_step() const;
+
+private:
+    [[nodiscard]] usize entry_index(usize age) const;
+};
@@ -1,15 +1,14 @@
+#include <core/helper/hash.hpp>
 #include <core/helper/magic_enum_wrapper.hpp>
 #include <core/helper/utils.hpp>
 #include <recordings/utility/recording_writer.hpp>
 
-#include "helper/constants.hpp"
-#include "helper/graphic_utils.hpp"
-#include "helper/music_utils.hpp"
-#include "manager/music_manager.hpp"
 #include "simulated_tetrion.hpp"
 
 #include "helper/spdlog_wrapper.hpp"
+#include <algorithm>
 #include <cassert>
+#include <tuple>
 
 
 SimulatedTetrion::SimulatedTetrion(
@@ -17,15 +16,18 @@ SimulatedTetrion::SimulatedTetrion(
         const Random::Seed random_seed,
         const u32 starting_level,
         ServiceProvider* const service_provider,
-        std::optional<std::shared_ptr<recorder::RecordingWriter>> recording_writer
+        std::optional<std::shared_ptr<recorder::RecordingWriter>> recording_writer,
+        const RandomAlgorithm random_algorithm
 )
-    : m_lock_delay_step_index{ lock_delay },
-      m_level{ starting_level },
-      m_random{ random_seed },
+    : m_state{ random_seed, starting_level, lock_delay, random_algorithm },
       m_tetrion_index{ tetrion_index },
-      m_next_gravity_simulation_step_index{ get_gravity_delay_frames() },
+      m_piece_sequence{ random_seed, random_algorithm },
       m_recording_writer{ std::move(recording_writer) },
-      m_service_provider{ service_provider } { }
+      m_service_provider{ service_provider } {
+    m_state.next_gravity_simulation_step_index = get_gravity_delay_frames();
+    m_events.reserve(initial_event_capacity);
+    std::ignore = m_piece_sequence.get(0, num_preview_tetrominos);
+}
 
 SimulatedTetrion::~SimulatedTetrion() = default;
 
@@ -34,23 +36,23 @@ SimulatedTetrion::SimulatedTetrion(const SimulatedTetrion& other) = default;
 SimulatedTetrion::SimulatedTetrion(SimulatedTetrion&& other) noexcept = default;
 
 void SimulatedTetrion::update_step(const SimulationStep simulation_step_index) {
-    switch (m_game_state) {
+    switch (m_state.game_state) {
         case GameState::Playing: {
-            if (simulation_step_index >= m_next_gravity_simulation_step_index) {
-                assert(simulation_step_index == m_next_gravity_simulation_step_index and "frame skipped?!");
-                if (m_is_accelerated_down_movement and not m_down_key_pressed) {
-                    assert(m_next_gravity_simulation_step_index >= get_gravity_delay_frames() and "overflow");
-                    m_next_gravity_simulation_step_index -= get_gravity_delay_frames();
-                    m_is_accelerated_down_movement = false;
+            if (simulation_step_index >= m_state.next_gravity_simulation_step_index) {
+                assert(simulation_step_index == m_state.next_gravity_simulation_step_index and "frame skipped?!");
+                if (m_state.is_accelerated_down_movement and not m_state.down_key_pressed) {
+                    assert(m_state.next_gravity_simulation_step_index >= get_gravity_delay_frames() and "overflow");
+                    m_state.next_gravity_simulation_step_index -= get_gravity_delay_frames();
+                    m_state.is_accelerated_down_movement = false;
                 } else {
                     if (move_tetromino_down(
-                                m_is_accelerated_down_movement ? MovementType::Forced : MovementType::Gravity,
+                                m_state.is_accelerated_down_movement ? MovementType::Forced : MovementType::Gravity,
                                 simulation_step_index
                         )) {
                         reset_lock_delay(simulation_step_index);
                     }
                 }
-                m_next_gravity_simulation_step_index += get_gravity_delay_frames();
+                m_state.next_gravity_simulation_step_index += get_gravity_delay_frames();
             }
 
             refresh_ghost_tetromino();
@@ -60,6 +62,10 @@ void SimulatedTetrion::update_step(const SimulationStep simulation_step_index) {
         default:
             break;
     }
+
+    if (simulation_step_index % state_hash_interval == 0) {
+        emit(simulation_step_index, engine::StateHashRequested{});
+    }
 }
 
 bool SimulatedTetrion::handle_input_command(
@@ -94,9 +100,9 @@ bool SimulatedTetrion::handle_input_command(
         case input::GameInputCommand::MoveDown:
             //TODO(Totto): use input_type() != InputType:Touch
 #if not defined(__ANDROID__)
-            m_down_key_pressed = true;
-            m_is_accelerated_down_movement = true;
-            m_next_gravity_simulation_step_index = simulation_step_index + get_gravity_delay_frames();
+            m_state.down_key_pressed = true;
+            m_state.is_accelerated_down_movement = true;
+            m_state.next_gravity_simulation_step_index = simulation_step_index + get_gravity_delay_frames();
 #endif
             if (move_tetromino_down(MovementType::Forced, simulation_step_index)) {
                 reset_lock_delay(simulation_step_index);
@@ -104,17 +110,17 @@ bool SimulatedTetrion::handle_input_command(
             }
             return false;
         case input::GameInputCommand::Drop:
-            m_lock_delay_step_index = simulation_step_index; // lock instantly
+            m_state.lock_delay_step_index = simulation_step_index; // lock instantly
             return drop_tetromino(simulation_step_index);
         case input::GameInputCommand::ReleaseMoveDown: {
-            m_down_key_pressed = false;
+            m_state.down_key_pressed = false;
             return false;
         }
         case input::GameInputCommand::Hold:
-            if (m_allowed_to_hold) {
+            if (m_state.allowed_to_hold) {
                 hold_tetromino(simulation_step_index);
                 reset_lock_delay(simulation_step_index);
-                m_allowed_to_hold = false;
+                m_state.allowed_to_hold = false;
                 return true;
             }
             return false;
@@ -133,12 +139,11 @@ void SimulatedTetrion::spawn_next_tetromino(
         const SimulationStep simulation_step_index
 ) {
     constexpr grid::GridPoint spawn_position{ 3, 0 };
-    m_active_tetromino = Tetromino{ spawn_position, type };
-    refresh_previews();
+    m_state.active_tetromino = Tetromino{ spawn_position, type };
     if (not is_active_tetromino_position_valid()) {
-        m_game_state = GameState::GameOver;
+        m_state.game_state = GameState::GameOver;
 
-        auto current_pieces = m_active_tetromino.value().minos();
+        auto current_pieces = m_state.active_tetromino.value().minos();
 
         bool all_valid{ false };
         i8 move_up = 0;
@@ -156,25 +161,22 @@ void SimulatedTetrion::spawn_next_tetromino(
             ++move_up;
         }
 
-        for (const Mino& mino : m_active_tetromino->minos()) {
+        for (const Mino& mino : m_state.active_tetromino->minos()) {
             auto position = mino.position();
             if (mino.position().y >= move_up && move_up != 0) {
                 position -= grid::GridPoint{ 0, move_up };
-                m_mino_stack.set(position, mino.type());
+                m_state.mino_stack.set(position, mino.type());
             }
         }
 
-        spdlog::info("game over");
-        if (m_recording_writer.has_value()) {
-            spdlog::info("writing snapshot");
-            std::ignore = m_recording_writer.value()->add_snapshot(simulation_step_index, core_information());
-        }
-        m_active_tetromino = {};
-        m_ghost_tetromino = {};
+        emit(simulation_step_index, engine::GameOver{});
+        emit(simulation_step_index, engine::SnapshotRequested{});
+        m_state.active_tetromino = {};
+        m_state.ghost_tetromino = {};
         return;
     }
 
-    m_next_gravity_simulation_step_index = simulation_step_index + get_gravity_delay_frames();
+    m_state.next_gravity_simulation_step_index = simulation_step_index + get_gravity_delay_frames();
     refresh_ghost_tetromino();
 }
 
@@ -187,26 +189,26 @@ bool SimulatedTetrion::rotate_tetromino_left() {
 }
 
 bool SimulatedTetrion::move_tetromino_down(MovementType movement_type, const SimulationStep simulation_step_index) {
-    if (not m_active_tetromino.has_value()) {
+    if (not m_state.active_tetromino.has_value()) {
         return false;
     }
     if (movement_type == MovementType::Forced) {
-        m_score += 4;
+        m_state.score += 4;
     }
 
 
-    if (tetromino_can_move_down(m_active_tetromino.value())) {
-        m_active_tetromino->move_down();
+    if (tetromino_can_move_down(m_state.active_tetromino.value())) {
+        m_state.active_tetromino->move_down();
         return true;
     }
 
-    m_is_in_lock_delay = true;
-    if ((m_is_in_lock_delay and m_num_executed_lock_delays >= num_lock_delays)
-        or simulation_step_index >= m_lock_delay_step_index) {
+    m_state.is_in_lock_delay = true;
+    if ((m_state.is_in_lock_delay and m_state.num_executed_lock_delays >= num_lock_delays)
+        or simulation_step_index >= m_state.lock_delay_step_index) {
         lock_active_tetromino(simulation_step_index);
         reset_lock_delay(simulation_step_index);
     } else {
-        m_next_gravity_simulation_step_index = simulation_step_index + 1;
+        m_state.next_gravity_simulation_step_index = simulation_step_index + 1;
     }
     return false;
 }
@@ -220,31 +222,30 @@ bool SimulatedTetrion::move_tetromino_right() {
 }
 
 bool SimulatedTetrion::drop_tetromino(const SimulationStep simulation_step_index) {
-    if (not m_active_tetromino.has_value()) {
+    if (not m_state.active_tetromino.has_value()) {
         return false;
     }
-    u64 num_movements = 0;
-    while (tetromino_can_move_down(m_active_tetromino.value())) {
-        ++num_movements;
-        m_active_tetromino->move_down();
+    const u64 num_movements = drop_distance(m_state.active_tetromino.value());
+    if (num_movements > 0) {
+        m_state.active_tetromino->move({ 0, static_cast<i8>(num_movements) });
     }
 
-    m_score += static_cast<u64>(4) * num_movements;
+    m_state.score += static_cast<u64>(4) * num_movements;
     lock_active_tetromino(simulation_step_index);
     return num_movements > 0;
 }
 
 void SimulatedTetrion::hold_tetromino(const SimulationStep simulation_step_index) {
-    if (not m_active_tetromino.has_value()) {
+    if (not m_state.active_tetromino.has_value()) {
         return;
     }
 
-    if (not m_tetromino_on_hold.has_value()) {
-        m_tetromino_on_hold = Tetromino{ grid::hold_tetromino_position, m_active_tetromino->type() };
+    if (not m_state.tetromino_on_hold.has_value()) {
+        m_state.tetromino_on_hold = Tetromino{ grid::hold_tetromino_position, m_state.active_tetromino->type() };
         spawn_next_tetromino(simulation_step_index);
     } else {
-        const auto on_hold = m_tetromino_on_hold->type();
-        m_tetromino_on_hold = Tetromino{ grid::hold_tetromino_position, m_active_tetromino->type() };
+        const auto on_hold = m_state.tetromino_on_hold->type();
+        m_state.tetromino_on_hold = Tetromino{ grid::hold_tetromino_position, m_state.active_tetromino->type() };
         spawn_next_tetromino(on_hold, simulation_step_index);
     }
 }
@@ -254,173 +255,269 @@ void SimulatedTetrion::hold_tetromino(const SimulationStep simulation_step_index
 }
 
 [[nodiscard]] u32 SimulatedTetrion::level() const {
-    return m_level;
+    return m_state.level;
 }
 
 [[nodiscard]] u64 SimulatedTetrion::score() const {
-    return m_score;
+    return m_state.score;
 }
 
 [[nodiscard]] u32 SimulatedTetrion::lines_cleared() const {
-    return m_lines_cleared;
+    return m_state.lines_cleared;
+}
+
+[[nodiscard]] u32 SimulatedTetrion::num_locked_tetrominos() const {
+    return m_state.num_locked_tetrominos;
 }
 
 [[nodiscard]] const MinoStack& SimulatedTetrion::mino_stack() const {
-    return m_mino_stack;
+    return m_state.mino_stack;
 }
 
 [[nodiscard]] std::unique_ptr<TetrionCoreInformation> SimulatedTetrion::core_information() const {
 
-    return std::make_unique<TetrionCoreInformation>(m_tetrion_index, m_level, m_score, m_lines_cleared, m_mino_stack);
+    return std::make_unique<TetrionCoreInformation>(
+            m_tetrion_index, m_state.level, m_state.score, m_state.lines_cleared, m_state.mino_stack
+    );
 }
 
 [[nodiscard]] bool SimulatedTetrion::is_game_over() const {
-    return m_game_state == GameState::GameOver;
+    return m_state.game_state == GameState::GameOver;
+}
+
+[[nodiscard]] std::optional<SimulationStep> SimulatedTetrion::next_gravity_step() const {
+    if (m_state.game_state != GameState::Playing) {
+        return std::nullopt;
+    }
+    return m_state.next_gravity_simulation_step_index;
+}
+
+[[nodiscard]] u64 SimulatedTetrion::state_hash() const {
+    u64 result = m_state.mino_stack.hash();
+
+    const auto add = [&result](const auto value) { result = hash::combine(result, static_cast<u64>(value)); };
+
+    add(m_state.active_tetromino.has_value());
+    if (m_state.active_tetromino.has_value()) {
+        add(m_state.active_tetromino->type());
+        add(m_state.active_tetromino->rotation());
+        add(m_state.active_tetromino->position().x);
+        add(m_state.active_tetromino->position().y);
+    }
+
+    add(m_state.tetromino_on_hold.has_value());
+    if (m_state.tetromino_on_hold.has_value()) {
+        add(m_state.tetromino_on_hold->type());
+    }
+
+    add(m_state.random_seed);
+    add(m_state.random_algorithm);
+    add(m_state.sequence_position);
+
+    add(m_state.game_state);
+    add(m_state.level);
+    add(m_state.lines_cleared);
+    add(m_state.score);
+
+    add(m_state.is_accelerated_down_movement);
+    add(m_state.down_key_pressed);
+    add(m_state.allowed_to_hold);
+    add(m_state.is_in_lock_delay);
+    add(m_state.num_executed_lock_delays);
+    add(m_state.lock_delay_step_index);
+    add(m_state.next_gravity_simulation_step_index);
+
+    return result;
+}
+
+[[nodiscard]] const TetrionState& SimulatedTetrion::state() const {
+    return m_state;
+}
+
+[[nodiscard]] std::span<const helper::TetrominoType> SimulatedTetrion::preview_tetromino_types() const {
+    return m_piece_sequence.generated(m_state.sequence_position, num_preview_tetrominos);
+}
+
+[[nodiscard]] std::span<const helper::TetrominoType> SimulatedTetrion::upcoming_tetromino_types(const usize count) {
+    return m_piece_sequence.get(m_state.sequence_position, count);
+}
+
+void SimulatedTetrion::restore_state(const TetrionState& state) {
+    m_state = state;
+    m_events.clear();
+
+    if (m_piece_sequence.seed() != m_state.random_seed
+        or m_piece_sequence.random_algorithm() != m_state.random_algorithm) {
+        m_piece_sequence = PieceSequence{ m_state.random_seed, m_state.random_algorithm };
+    }
+    std::ignore = m_piece_sequence.get(m_state.sequence_position, num_preview_tetrominos);
 }
 
 void SimulatedTetrion::reset_lock_delay(const SimulationStep simulation_step_index) {
-    m_lock_delay_step_index = simulation_step_index + lock_delay;
-}
-
-void SimulatedTetrion::refresh_texts() { }
-
-void SimulatedTetrion::clear_fully_occupied_lines() {
-    bool cleared = false;
-    const u32 lines_cleared_before = m_lines_cleared;
-    do { // NOLINT(cppcoreguidelines-avoid-do-while)
-        cleared = false;
-        for (i8 row = 0; row < grid::height_in_tiles; ++row) {
-            bool fully_occupied = true;
-            for (i8 column = 0; column < grid::width_in_tiles; ++column) {
-                if (m_mino_stack.is_empty(grid::GridPoint{ column, row })) {
-                    fully_occupied = false;
-                    break;
-                }
-            }
+    m_state.lock_delay_step_index = simulation_step_index + lock_delay;
+}
 
-            if (fully_occupied) {
-                ++m_lines_cleared;
-                const auto level = m_lines_cleared / 10;
-                if (level > m_level) {
-                    m_level = level;
-                    spdlog::info("new level: {}", m_level);
-                    if (level == constants::music_change_level) {
-                        if (m_service_provider != nullptr) {
-                            m_service_provider->music_manager()
-                                    .load_and_play_music(
-                                            utils::get_assets_folder() / "music"
-                                            / utils::get_supported_music_extension("03. Game Theme (50 Left)")
-                                    )
-                                    .and_then(utils::log_error);
-                        }
-                    }
-                }
-                m_mino_stack.clear_row_and_let_sink(static_cast<int>(row));
-                cleared = true;
-                break;
-            }
+[[nodiscard]] const std::vector<engine::StepEvent>& SimulatedTetrion::events() const {
+    return m_events;
+}
+
+void SimulatedTetrion::dispatch_events() {
+    for (const auto& [simulation_step_index, event] : m_events) {
+        if (std::holds_alternative<engine::SnapshotRequested>(event) and m_recording_writer.has_value()) {
+            spdlog::debug("adding snapshot at step {}", simulation_step_index);
+            std::ignore = m_recording_writer.value()->add_snapshot(simulation_step_index, core_information());
         }
-    } while (cleared);
-    const u32 num_lines_cleared = m_lines_cleared - lines_cleared_before;
+        if (std::holds_alternative<engine::StateHashRequested>(event) and m_recording_writer.has_value()) {
+            std::ignore =
+                    m_recording_writer.value()->add_state_hash(m_tetrion_index, simulation_step_index, state_hash());
+        }
+    }
+
+    // after the loop, so that the final snapshot is part of it
+    const auto is_game_over = std::ranges::any_of(m_events, [](const engine::StepEvent& step_event) {
+        return std::holds_alternative<engine::GameOver>(step_event.event);
+    });
+    if (is_game_over and m_recording_writer.has_value()) {
+        std::ignore = m_recording_writer.value()->game_over();
+    }
+    m_events.clear();
+}
+
+void SimulatedTetrion::emit(const SimulationStep simulation_step_index, engine::Event event) {
+    // events of older steps that were never dispatched are dropped, so the buffer can't grow without bounds, the
+    // recording is only written while dispatching though, so with a writer that would lose snapshots and state hashes
+    if (not m_events.empty() and m_events.back().simulation_step_index != simulation_step_index) {
+        assert(not m_recording_writer.has_value() and "the events of an earlier step were never dispatched");
+        m_events.clear();
+    }
+    m_events.push_back(engine::StepEvent{ simulation_step_index, event });
+}
+
+void SimulatedTetrion::clear_fully_occupied_lines(
+        const u8 first_row,
+        const u8 last_row,
+        const SimulationStep simulation_step_index
+) {
+    const u32 num_lines_cleared = m_state.mino_stack.clear_full_rows(first_row, last_row);
+    if (num_lines_cleared == 0) {
+        return;
+    }
+
+    m_state.lines_cleared += num_lines_cleared;
+    emit(simulation_step_index, engine::LinesCleared{ num_lines_cleared });
+
+    const auto level = m_state.lines_cleared / 10;
+    if (level > m_state.level) {
+        emit(simulation_step_index, engine::LevelUp{ m_state.level, level });
+        m_state.level = level;
+    }
+
     static constexpr std::array<u32, 5> score_per_line_multiplier{ 0, 40, 100, 300, 1200 };
-    m_score += static_cast<u64>(score_per_line_multiplier.at(num_lines_cleared)) * static_cast<u64>(m_level + 1);
+    m_state.score +=
+            static_cast<u64>(score_per_line_multiplier.at(num_lines_cleared)) * static_cast<u64>(m_state.level + 1);
 }
 
 void SimulatedTetrion::lock_active_tetromino(const SimulationStep simulation_step_index) {
-    assert(m_active_tetromino.has_value());
-    for (const Mino& mino : m_active_tetromino->minos()) { // NOLINT(bugprone-unchecked-optional-access)
-        m_mino_stack.set(mino.position(), mino.type());
-    }
-    m_allowed_to_hold = true;
-    m_is_in_lock_delay = false;
-    m_num_executed_lock_delays = 0;
-    clear_fully_occupied_lines();
+    assert(m_state.active_tetromino.has_value());
+    // only the rows the tetromino was locked into can become fully occupied
+    auto first_row = static_cast<u8>(grid::height_in_tiles - 1);
+    u8 last_row = 0;
+    for (const Mino& mino : m_state.active_tetromino->minos()) { // NOLINT(bugprone-unchecked-optional-access)
+        m_state.mino_stack.set(mino.position(), mino.type());
+        const auto row = static_cast<u8>(mino.position().y);
+        first_row = std::min(first_row, row);
+        last_row = std::max(last_row, row);
+    }
+    ++m_state.num_locked_tetrominos;
+    m_state.allowed_to_hold = true;
+    m_state.is_in_lock_delay = false;
+    m_state.num_executed_lock_delays = 0;
+    emit(simulation_step_index, engine::Locked{});
+    clear_fully_occupied_lines(first_row, last_row, simulation_step_index);
     spawn_next_tetromino(simulation_step_index);
-    refresh_texts();
     reset_lock_delay(simulation_step_index);
-
-    // save a snapshot on every freeze (only in debug builds)
-#if !defined(NDEBUG)
-    if (m_recording_writer) {
-        spdlog::debug("adding snapshot at step {}", simulation_step_index);
-        std::ignore = (*m_recording_writer)->add_snapshot(simulation_step_index, core_information());
-    }
-#endif
 }
 
 bool SimulatedTetrion::is_active_tetromino_position_valid() const {
-    if (not m_active_tetromino) {
+    if (not m_state.active_tetromino) {
         return false;
     }
-    return is_tetromino_position_valid(m_active_tetromino.value());
+    return is_tetromino_position_valid(m_state.active_tetromino.value());
 }
 
 bool SimulatedTetrion::is_valid_mino_position(grid::GridPoint position) const {
 
     return position.x >= 0 and position.x < grid::width_in_tiles and position.y >= 0
-           and position.y < grid::height_in_tiles and m_mino_stack.is_empty(position);
+           and position.y < grid::height_in_tiles and m_state.mino_stack.is_empty(position);
 }
 
-bool SimulatedTetrion::mino_can_move_down(grid::GridPoint position) const {
-    if (position.y == (grid::height_in_tiles - 1)) {
+bool SimulatedTetrion::is_shape_position_valid(
+        const helper::TetrominoType type,
+        const Rotation rotation,
+        const grid::GridPoint position
+) const {
+    const auto& shape = Tetromino::get_shape_mask(type, rotation);
+
+    const auto left = position.x + shape.min.x;
+    const auto right = position.x + shape.max.x;
+    const auto top = position.y + shape.min.y;
+    const auto bottom = position.y + shape.max.y;
+    if (left < 0 or right >= grid::width_in_tiles or top < 0 or bottom >= grid::height_in_tiles) {
         return false;
     }
 
-    return is_valid_mino_position(position + grid::GridPoint{ 0, 1 });
+    // the bounding box check guarantees that no set bit gets shifted out of the row
+    for (auto row = shape.min.y; row <= shape.max.y; ++row) {
+        const auto shape_row = static_cast<u32>(shape.rows.at(static_cast<usize>(row)));
+        const auto shifted = (position.x >= 0 ? shape_row << position.x : shape_row >> -position.x);
+        if ((shifted & m_state.mino_stack.row_mask(static_cast<u8>(position.y + row))) != 0) {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 
 void SimulatedTetrion::refresh_ghost_tetromino() {
-    if (not m_active_tetromino.has_value()) {
-        m_ghost_tetromino = {};
+    if (not m_state.active_tetromino.has_value()) {
+        m_state.ghost_tetromino = {};
         return;
     }
-    m_ghost_tetromino = m_active_tetromino.value();
-    while (tetromino_can_move_down(m_ghost_tetromino.value())) {
-        m_ghost_tetromino->move_down();
-    }
-}
-
-void SimulatedTetrion::refresh_previews() {
-    auto sequence_index = m_sequence_index;
-    auto bag_index = usize{ 0 };
-    for (std::remove_cvref_t<decltype(num_preview_tetrominos)> i = 0; i < num_preview_tetrominos; ++i) {
-        m_preview_tetrominos.at(static_cast<usize>(i)) = Tetromino{
-            grid::preview_tetromino_position + shapes::IPoint{ 0, grid::preview_padding * i },
-            m_sequence_bags.at(bag_index)[sequence_index]
-        };
-        ++sequence_index;
-        static constexpr auto bag_size = decltype(m_sequence_bags)::value_type::size();
-        if (sequence_index >= bag_size) {
-            assert(sequence_index == bag_size);
-            sequence_index = 0;
-            ++bag_index;
-            assert(bag_index < m_sequence_bags.size());
-        }
+    m_state.ghost_tetromino = m_state.active_tetromino.value();
+    const auto distance = drop_distance(m_state.ghost_tetromino.value());
+    if (distance > 0) {
+        m_state.ghost_tetromino->move({ 0, static_cast<i8>(distance) });
     }
 }
 
 helper::TetrominoType SimulatedTetrion::get_next_tetromino_type() {
-    const helper::TetrominoType next_type = m_sequence_bags[0][m_sequence_index];
-    m_sequence_index = (m_sequence_index + 1) % Bag::size();
-    if (m_sequence_index == 0) {
-        // we had a wrap-around
-        m_sequence_bags[0] = m_sequence_bags[1];
-        m_sequence_bags[1] = Bag{ m_random };
-    }
-    return next_type;
+    // the previews after it have to be available as well
+    const auto type = m_piece_sequence.get(m_state.sequence_position, num_preview_tetrominos + 1).front();
+    ++m_state.sequence_position;
+    m_piece_sequence.discard_before(m_state.sequence_position);
+    return type;
 }
 
 bool SimulatedTetrion::tetromino_can_move_down(const Tetromino& tetromino) const {
-    return not std::ranges::any_of(tetromino.minos(), [this](const Mino& mino) {
-        return not mino_can_move_down(mino.position());
-    });
+    return is_shape_position_valid(
+            tetromino.type(), tetromino.rotation(), tetromino.position() + grid::GridPoint{ 0, 1 }
+    );
 }
 
+u8 SimulatedTetrion::drop_distance(const Tetromino& tetromino) const {
+    // the tetromino can fall as far as the mino with the least free space below it
+    u8 distance = grid::height_in_tiles;
+    for (const Mino& mino : tetromino.minos()) {
+        distance = std::min(distance, m_state.mino_stack.free_cells_below(mino.position()));
+    }
+    return distance;
+}
 
 [[nodiscard]] u64 SimulatedTetrion::get_gravity_delay_frames() const {
-    const auto frames = (m_level >= frames_per_tile.size() ? frames_per_tile.back() : frames_per_tile.at(m_level));
-    if (m_is_accelerated_down_movement) {
+    const auto frames =
+            (m_state.level >= frames_per_tile.size() ? frames_per_tile.back() : frames_per_tile.at(m_state.level));
+    if (m_state.is_accelerated_down_movement) {
         return std::max(u64{ 1 }, static_cast<u64>(std::round(static_cast<double>(frames) / 20.0)));
     }
     return frames;
@@ -455,13 +552,11 @@ u8 SimulatedTetrion::rotation_to_index(const Rotation from, const Rotation rotat
 }
 
 bool SimulatedTetrion::is_tetromino_position_valid(const Tetromino& tetromino) const {
-    return not std::ranges::any_of(tetromino.minos(), [this](const Mino& mino) {
-        return not is_valid_mino_position(mino.position());
-    });
+    return is_shape_position_valid(tetromino.type(), tetromino.rotation(), tetromino.position());
 }
 
 bool SimulatedTetrion::rotate(SimulatedTetrion::RotationDirection rotation_direction) {
-    if (not m_active_tetromino) {
+    if (not m_state.active_tetromino) {
         return false;
     }
 
@@ -470,60 +565,49 @@ bool SimulatedTetrion::rotate(SimulatedTetrion::RotationDirection rotation_direc
         return false;
     }
 
-    const auto from_rotation = m_active_tetromino->rotation();
+    const auto from_rotation = m_state.active_tetromino->rotation();
     const auto to_rotation = from_rotation + static_cast<i8>(rotation_direction == RotationDirection::Left ? -1 : 1);
     const auto table_index = rotation_to_index(from_rotation, to_rotation);
+    const auto type = m_state.active_tetromino->type();
+    const auto position = m_state.active_tetromino->position();
 
-    if (rotation_direction == RotationDirection::Left) {
-        m_active_tetromino->rotate_left();
-    } else {
-        m_active_tetromino->rotate_right();
-    }
-
+    // the kicks are only tested against the shape masks, the tetromino itself is only touched on success
     for (const auto& translation : (*wall_kick_table)->at(table_index)) {
-        m_active_tetromino->move(translation);
-        if (is_active_tetromino_position_valid()) {
-            return true;
+        if (not is_shape_position_valid(type, to_rotation, position + translation)) {
+            continue;
         }
-        m_active_tetromino->move(-translation);
-    }
 
-    if (rotation_direction == RotationDirection::Left) {
-        m_active_tetromino->rotate_right();
-    } else {
-        m_active_tetromino->rotate_left();
+        if (rotation_direction == RotationDirection::Left) {
+            m_state.active_tetromino->rotate_left();
+        } else {
+            m_state.active_tetromino->rotate_right();
+        }
+        m_state.active_tetromino->move(translation);
+        return true;
     }
+
     return false;
 }
 
 bool SimulatedTetrion::move(const SimulatedTetrion::MoveDirection move_direction) {
-    if (not m_active_tetromino) {
+    if (not m_state.active_tetromino) {
         return false;
     }
 
-    switch (move_direction) {
-        case MoveDirection::Left:
-            m_active_tetromino->move_left();
-            if (not is_active_tetromino_position_valid()) {
-                m_active_tetromino->move_right();
-                return false;
-            }
-            return true;
-        case MoveDirection::Right:
-            m_active_tetromino->move_right();
-            if (not is_active_tetromino_position_valid()) {
-                m_active_tetromino->move_left();
-                return false;
-            }
-            return true;
+    const auto translation =
+            (move_direction == MoveDirection::Left ? grid::GridPoint{ -1, 0 } : grid::GridPoint{ 1, 0 });
+    const auto& tetromino = m_state.active_tetromino.value();
+    if (not is_shape_position_valid(tetromino.type(), tetromino.rotation(), tetromino.position() + translation)) {
+        return false;
     }
 
-    UNREACHABLE();
+    m_state.active_tetromino->move(translation);
+    return true;
 }
 
 std::optional<const SimulatedTetrion::WallKickTable*> SimulatedTetrion::get_wall_kick_table() const {
-    assert(m_active_tetromino.has_value() and "no active tetromino");
-    const auto type = m_active_tetromino->type(); // NOLINT(bugprone-unchecked-optional-access)
+    assert(m_state.active_tetromino.has_value() and "no active tetromino");
+    const auto type = m_state.active_tetromino->type(); // NOLINT(bugprone-unchecked-optional-access)
     switch (type) {
         case helper::TetrominoType::J:
         case helper::TetrominoType::L:
@@ -1,28 +1,24 @@
 #pragma once
 
-#include <core/game/mino_stack.hpp>
-#include <core/helper/random.hpp>
 #include <core/helper/types.hpp>
 #include <recordings/utility/recording_writer.hpp>
 #include <recordings/utility/tetrion_core_information.hpp>
 
-#include "bag.hpp"
+#include "engine_event.hpp"
 #include "grid.hpp"
 #include "helper/export_symbols.hpp"
 #include "input/game_input.hpp"
 #include "manager/service_provider.hpp"
-#include "tetromino.hpp"
+#include "piece_sequence.hpp"
+#include "tetrion_state.hpp"
 #include "ui/layouts/grid_layout.hpp"
 #include "ui/widget.hpp"
 
 #include <array>
+#include <span>
+#include <vector>
 
 
-enum class GameState : u8 {
-    Playing,
-    GameOver,
-};
-
 enum class MovementType : u8 {
     Gravity,
     Forced,
@@ -47,55 +43,36 @@ private:
     };
 
 
-    static constexpr u8 num_preview_tetrominos = 6;
-
-    bool m_is_accelerated_down_movement = false;
-    bool m_down_key_pressed = false;
-    bool m_allowed_to_hold = true;
-    bool m_is_in_lock_delay = false;
-
-    u32 m_num_executed_lock_delays = 0;
-    u64 m_lock_delay_step_index;
+    static constexpr u8 num_preview_tetrominos = TetrionState::num_preview_tetrominos;
+    static constexpr usize initial_event_capacity = 16;
 
 protected:
-    MinoStack
-            m_mino_stack; // NOLINT(misc-non-private-member-variables-in-classes,cppcoreguidelines-non-private-member-variables-in-classes)
-    u32 m_level; // NOLINT(misc-non-private-member-variables-in-classes,cppcoreguidelines-non-private-member-variables-in-classes)
-    u32 m_lines_cleared = // NOLINT(misc-non-private-member-variables-in-classes,cppcoreguidelines-non-private-member-variables-in-classes)
-            0;
-    u64 m_score = // NOLINT(misc-non-private-member-variables-in-classes,cppcoreguidelines-non-private-member-variables-in-classes)
-            0;
-
-
-    std::optional<Tetromino>
-            m_active_tetromino; // NOLINT(misc-non-private-member-variables-in-classes,cppcoreguidelines-non-private-member-variables-in-classes)
-    std::optional<Tetromino>
-            m_ghost_tetromino; // NOLINT(misc-non-private-member-variables-in-classes,cppcoreguidelines-non-private-member-variables-in-classes)
-    std::optional<Tetromino>
-            m_tetromino_on_hold; // NOLINT(misc-non-private-member-variables-in-classes,cppcoreguidelines-non-private-member-variables-in-classes)
-    std::array<std::optional<Tetromino>, num_preview_tetrominos>
-            m_preview_tetrominos{}; // NOLINT(misc-non-private-member-variables-in-classes,cppcoreguidelines-non-private-member-variables-in-classes)
+    TetrionState
+            m_state; // NOLINT(misc-non-private-member-variables-in-classes,cppcoreguidelines-non-private-member-variables-in-classes)
 
 private:
-    Random m_random;
-    GameState m_game_state = GameState::Playing;
-    int m_sequence_index = 0;
-    std::array<Bag, 2> m_sequence_bags{ Bag{ m_random }, Bag{ m_random } };
     u8 m_tetrion_index;
-    u64 m_next_gravity_simulation_step_index;
+    // always holds at least the previews after the next piece of m_state
+    PieceSequence m_piece_sequence;
     std::optional<std::shared_ptr<recorder::RecordingWriter>> m_recording_writer;
+    // only holds the events of the most recent step that emitted any
+    std::vector<engine::StepEvent> m_events;
 
 protected:
     ServiceProvider*
             m_service_provider; // NOLINT(misc-non-private-member-variables-in-classes,cppcoreguidelines-non-private-member-variables-in-classes)
 
 public:
+    // a recorded game stores the state hash of every tetrion at each multiple of this step, replays check against it
+    static constexpr SimulationStep state_hash_interval = 60;
+
     OOPETRIS_GRAPHICS_EXPORTED SimulatedTetrion(
             u8 tetrion_index,
             Random::Seed random_seed,
             u32 starting_level,
             ServiceProvider* service_provider,
-            std::optional<std::shared_ptr<recorder::RecordingWriter>> recording_writer
+            std::optional<std::shared_ptr<recorder::RecordingWriter>> recording_writer,
+            RandomAlgorithm random_algorithm = Random::default_algorithm
     );
 
     OOPETRIS_GRAPHICS_EXPORTED virtual ~SimulatedTetrion();
@@ -127,17 +104,44 @@ public:
     [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED u32 level() const;
     [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED u64 score() const;
     [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED u32 lines_cleared() const;
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED u32 num_locked_tetrominos() const;
     [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED const MinoStack& mino_stack() const;
     [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED std::unique_ptr<TetrionCoreInformation> core_information() const;
 
     [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED bool is_game_over() const;
 
+    // the step of the next gravity tick (this also covers the lock delay), nothing happens on its own before that
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED std::optional<SimulationStep> next_gravity_step() const;
+
+    // hash over everything that influences the further simulation (stack, pieces, sequence position, timers),
+    // derived state like the ghost tetromino is left out
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED u64 state_hash() const;
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED const TetrionState& state() const;
+
+    // the types of the next num_preview_tetrominos pieces, they are always generated already
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED std::span<const helper::TetrominoType> preview_tetromino_types() const;
+
+    // the types of any number of upcoming pieces, e.g. for a deep lookahead, missing ones are generated in bulk
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED std::span<const helper::TetrominoType>
+    upcoming_tetromino_types(usize count);
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED const std::vector<engine::StepEvent>& events() const;
+
+    // consumes the emitted events (e.g. writes the requested snapshots, state hashes and the end of the game to the
+    // recording), with a recording writer it has to be called after every step, otherwise the events of a step are
+    // dropped, as soon as a later step emits any, so drivers without a writer (e.g. a TetrionBatch) may skip it
+    OOPETRIS_GRAPHICS_EXPORTED virtual void dispatch_events();
+
+    // replaces the complete game state, e.g. to rewind to a previously saved state
+    OOPETRIS_GRAPHICS_EXPORTED virtual void restore_state(const TetrionState& state);
+
 private:
     template<typename Callable>
     bool with_lock_delay(Callable movement) {
         const auto result = movement();
-        if (result and m_is_in_lock_delay) {
-            ++m_num_executed_lock_delays;
+        if (result and m_state.is_in_lock_delay) {
+            ++m_state.num_executed_lock_delays;
         }
         return result;
     }
@@ -146,19 +150,21 @@ private:
     bool move(MoveDirection move_direction);
     [[nodiscard]] std::optional<const WallKickTable*> get_wall_kick_table() const;
     void reset_lock_delay(SimulationStep simulation_step_index);
-    virtual void refresh_texts();
-    void clear_fully_occupied_lines();
+    void emit(SimulationStep simulation_step_index, engine::Event event);
+    void clear_fully_occupied_lines(u8 first_row, u8 last_row, SimulationStep simulation_step_index);
     void lock_active_tetromino(SimulationStep simulation_step_index);
     [[nodiscard]] bool is_active_tetromino_position_valid() const;
-    [[nodiscard]] bool mino_can_move_down(grid::GridPoint position) const;
     [[nodiscard]] bool is_valid_mino_position(grid::GridPoint position) const;
 
     void refresh_ghost_tetromino();
-    void refresh_previews();
     helper::TetrominoType get_next_tetromino_type();
 
+    // tests the shape of the given type and rotation at that position against the row masks of the mino stack
+    [[nodiscard]] bool
+    is_shape_position_valid(helper::TetrominoType type, Rotation rotation, grid::GridPoint position) const;
     [[nodiscard]] bool is_tetromino_position_valid(const Tetromino& tetromino) const;
     [[nodiscard]] bool tetromino_can_move_down(const Tetromino& tetromino) const;
+    [[nodiscard]] u8 drop_distance(const Tetromino& tetromino) const;
 
     [[nodiscard]] u64 get_gravity_delay_frames() const;
 
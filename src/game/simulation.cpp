@@ -1,49 +1,69 @@
-
 #include <core/helper/expected.hpp>
 #include <core/helper/magic_enum_wrapper.hpp>
 #include <core/helper/utils.hpp>
 
 #include "input/replay_input.hpp"
+#include "keyframe.hpp"
 #include "simulation.hpp"
 
 #include "helper/spdlog_wrapper.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
 
-Simulation::Simulation(
-        const std::shared_ptr<input::ReplayGameInput>& input,
-        const tetrion::StartingParameters& starting_parameters
-)
-    : m_input{ input } {
 
+Simulation::Simulation(const std::vector<Parameters>& parameters, const u32 num_threads)
+    : m_num_threads{ num_threads == 0 ? std::max(1U, std::thread::hardware_concurrency()) : num_threads } {
 
-    spdlog::info("[simulation] starting level for tetrion {}", starting_parameters.starting_level);
+    m_tetrions.reserve(parameters.size());
 
-    m_tetrion = std::make_unique<SimulatedTetrion>(
-            starting_parameters.tetrion_index, starting_parameters.seed, starting_parameters.starting_level, nullptr,
-            starting_parameters.recording_writer
-    );
+    for (const auto& [input, starting_parameters] : parameters) {
+        spdlog::info(
+                "[simulation] starting level for tetrion {}: {}", starting_parameters.tetrion_index,
+                starting_parameters.starting_level
+        );
+
+        auto tetrion = std::make_unique<SimulatedTetrion>(
+                starting_parameters.tetrion_index, starting_parameters.seed, starting_parameters.starting_level,
+                nullptr, starting_parameters.recording_writer, starting_parameters.random_algorithm
+        );
+
+        tetrion->spawn_next_tetromino(0);
 
-    m_tetrion->spawn_next_tetromino(0);
+        input->set_target_tetrion(tetrion.get());
+        if (starting_parameters.recording_writer.has_value()) {
+            // the writer isn't thread safe
+            m_num_threads = 1;
 
-    m_input->set_target_tetrion(m_tetrion.get());
-    if (starting_parameters.recording_writer.has_value()) {
-        const auto recording_writer = starting_parameters.recording_writer.value();
-        const auto tetrion_index = starting_parameters.tetrion_index;
-        m_input->set_event_callback([recording_writer,
-                                     tetrion_index](InputEvent event, SimulationStep simulation_step_index) {
-            spdlog::debug("event: {} (step {})", magic_enum::enum_name(event), simulation_step_index);
+            const auto recording_writer = starting_parameters.recording_writer.value();
+            const auto tetrion_index = starting_parameters.tetrion_index;
+            input->set_event_callback([recording_writer,
+                                       tetrion_index](InputEvent event, SimulationStep simulation_step_index) {
+                spdlog::debug("event: {} (step {})", magic_enum::enum_name(event), simulation_step_index);
 
-            //TODO(Totto): Remove all occurrences of std::ignore, where we shouldn't ignore this return value
-            std::ignore = recording_writer->add_record(tetrion_index, simulation_step_index, event);
+                //TODO(Totto): Remove all occurrences of std::ignore, where we shouldn't ignore this return value
+                std::ignore = recording_writer->add_record(tetrion_index, simulation_step_index, event);
+            });
+        }
+
+        const auto initial_state = tetrion->state();
+        m_tetrions.push_back(ReplayedTetrion{
+                .simulation_step_index = 0,
+                .tetrion = std::move(tetrion),
+                .input = input,
+                .initial_state = initial_state,
         });
     }
 }
 
-helper::expected<Simulation, std::string> Simulation::get_replay_simulation(std::filesystem::path& recording_path) {
-
-    //TODO(Totto): Support multiple tetrions to be in the recorded file and simulated
+helper::expected<Simulation, std::string>
+Simulation::get_replay_simulation(std::filesystem::path& recording_path, const u32 num_threads) {
 
-    auto maybe_recording_reader = recorder::RecordingReader::from_path(recording_path);
+    auto maybe_recording_reader = recorder::RecordingReader::from_path(recording_path, num_threads);
 
     if (not maybe_recording_reader.has_value()) {
         return helper::unexpected<std::string>{
@@ -51,53 +71,241 @@ helper::expected<Simulation, std::string> Simulation::get_replay_simulation(std:
         };
     }
 
-    const auto recording_reader =
-            std::make_shared<recorder::RecordingReader>(std::move(maybe_recording_reader.value()));
-
+    return get_replay_simulation(
+            std::make_shared<recorder::RecordingReader>(std::move(maybe_recording_reader.value())), num_threads
+    );
+}
 
+helper::expected<Simulation, std::string> Simulation::get_replay_simulation(
+        const std::shared_ptr<recorder::RecordingReader>& recording_reader,
+        const u32 num_threads
+) {
     const auto tetrion_headers = recording_reader->tetrion_headers();
 
-    if (tetrion_headers.size() != 1) {
+    if (tetrion_headers.empty()) {
+        return helper::unexpected<std::string>{ "Expected at least 1 recording in the recording file, but got none" };
+    }
+
+    std::vector<Parameters> parameters{};
+    parameters.reserve(tetrion_headers.size());
+
+    for (u8 tetrion_index = 0; tetrion_index < static_cast<u8>(tetrion_headers.size()); ++tetrion_index) {
+        auto input = std::make_shared<input::ReplayGameInput>(recording_reader, nullptr);
+
+        const auto& header = tetrion_headers.at(tetrion_index);
+
+        const auto seed = header.seed;
+        const auto starting_level = header.starting_level;
+
+        parameters.emplace_back(
+                std::move(input),
+                tetrion::StartingParameters{
+                        0, seed, starting_level, tetrion_index, std::nullopt, header.random_algorithm }
+        );
+    }
+
+    return Simulation{ parameters, num_threads };
+}
+
+
+helper::expected<Simulation, std::string>
+Simulation::get_streaming_replay_simulation(const std::filesystem::path& recording_path) {
+
+    auto maybe_recording_stream = recorder::SharedRecordingStream::from_path(recording_path);
+
+    if (not maybe_recording_stream.has_value()) {
         return helper::unexpected<std::string>{
-            fmt::format("Expected 1 recording in the recording file, but got : {}", tetrion_headers.size())
+            fmt::format("an error occurred while reading recording: {}", maybe_recording_stream.error())
         };
     }
 
-    const auto tetrion_index = 0;
+    // every tetrion only gets its own entries, but the file is read just once
+    const auto recording_stream =
+            std::make_shared<recorder::SharedRecordingStream>(std::move(maybe_recording_stream.value()));
+
+    const auto& tetrion_headers = recording_stream->tetrion_headers();
+
+    if (tetrion_headers.empty()) {
+        return helper::unexpected<std::string>{ "Expected at least 1 recording in the recording file, but got none" };
+    }
 
-    auto input = std::make_shared<input::ReplayGameInput>(recording_reader, nullptr);
+    std::vector<Parameters> parameters{};
+    parameters.reserve(tetrion_headers.size());
 
-    const auto& header = tetrion_headers.at(tetrion_index);
+    for (u8 tetrion_index = 0; tetrion_index < static_cast<u8>(tetrion_headers.size()); ++tetrion_index) {
+        auto input = std::make_shared<input::ReplayGameInput>(recording_stream, nullptr);
 
-    const auto seed = header.seed;
-    const auto starting_level = header.starting_level;
+        const auto& header = tetrion_headers.at(tetrion_index);
 
-    const tetrion::StartingParameters starting_parameters = { 0, seed, starting_level, tetrion_index, std::nullopt };
+        parameters.emplace_back(
+                std::move(input),
+                tetrion::StartingParameters{
+                        0, header.seed, header.starting_level, tetrion_index, std::nullopt, header.random_algorithm }
+        );
+    }
 
-    return Simulation{ input, starting_parameters };
+    auto simulation = Simulation{ parameters, 1 };
+    simulation.m_is_streamed = true;
+    return simulation;
 }
 
 
 void Simulation::update() {
-    if (is_game_finished()) {
+    for (auto& replayed_tetrion : m_tetrions) {
+        if (is_finished(replayed_tetrion)) {
+            continue;
+        }
+
+        step(replayed_tetrion, replayed_tetrion.simulation_step_index + 1);
+    }
+}
+
+void Simulation::fast_forward() {
+    auto next_simulation_step_index = std::numeric_limits<SimulationStep>::max();
+    for (const auto& replayed_tetrion : m_tetrions) {
+        if (not is_finished(replayed_tetrion)) {
+            next_simulation_step_index = std::min(
+                    next_simulation_step_index,
+                    replayed_tetrion.input->next_active_step(replayed_tetrion.simulation_step_index)
+            );
+        }
+    }
+
+    for (auto& replayed_tetrion : m_tetrions) {
+        if (is_finished(replayed_tetrion)) {
+            continue;
+        }
+
+        // the other tetrions are idle at that step, so they just skip it
+        if (replayed_tetrion.input->next_active_step(replayed_tetrion.simulation_step_index)
+            == next_simulation_step_index) {
+            step(replayed_tetrion, next_simulation_step_index);
+        } else {
+            replayed_tetrion.simulation_step_index = next_simulation_step_index;
+        }
+    }
+}
+
+void Simulation::simulate_to_end() {
+    if (m_is_streamed) {
+        // a tetrion that runs ahead leaves the entries of the others pending in the shared stream, advancing all of
+        // them together keeps that to the entries around the current step
+        while (not is_game_finished()) {
+            fast_forward();
+        }
         return;
     }
 
-    ++m_simulation_step_index;
-    m_input->update(m_simulation_step_index);
-    m_tetrion->update_step(m_simulation_step_index);
-    m_input->late_update(m_simulation_step_index);
+    for_each_in_parallel([](ReplayedTetrion& replayed_tetrion) {
+        simulate_until(replayed_tetrion, std::numeric_limits<SimulationStep>::max());
+    });
+}
+
+void Simulation::seek(const SimulationStep simulation_step_index) {
+    for_each_in_parallel([simulation_step_index](ReplayedTetrion& replayed_tetrion) {
+        replayed_tetrion.simulation_step_index = keyframe::restore_closest(
+                *replayed_tetrion.tetrion, *replayed_tetrion.input, replayed_tetrion.initial_state,
+                replayed_tetrion.simulation_step_index, simulation_step_index
+        );
+
+        simulate_until(replayed_tetrion, simulation_step_index);
+    });
+}
+
+[[nodiscard]] SimulationStep Simulation::simulation_step_index() const {
+    SimulationStep result = 0;
+    for (const auto& replayed_tetrion : m_tetrions) {
+        result = std::max(result, replayed_tetrion.simulation_step_index);
+    }
+    return result;
+}
+
+[[nodiscard]] SimulationStep Simulation::simulation_step_index(const usize index) const {
+    return m_tetrions.at(index).simulation_step_index;
+}
+
+[[nodiscard]] usize Simulation::num_tetrions() const {
+    return m_tetrions.size();
+}
+
+[[nodiscard]] const SimulatedTetrion& Simulation::tetrion(const usize index) const {
+    return *m_tetrions.at(index).tetrion;
 }
 
 [[nodiscard]] bool Simulation::is_game_finished() const {
-    if (m_tetrion->is_game_over()) {
-        return true;
+    return std::ranges::all_of(m_tetrions, is_finished);
+}
+
+[[nodiscard]] bool Simulation::is_finished(const ReplayedTetrion& replayed_tetrion) {
+    return replayed_tetrion.tetrion->is_game_over() or replayed_tetrion.input->is_end_of_recording();
+}
+
+void Simulation::step(ReplayedTetrion& replayed_tetrion, const SimulationStep simulation_step_index) {
+    replayed_tetrion.simulation_step_index = simulation_step_index;
+    replayed_tetrion.input->update(simulation_step_index);
+    replayed_tetrion.tetrion->update_step(simulation_step_index);
+    replayed_tetrion.input->late_update(simulation_step_index);
+    replayed_tetrion.tetrion->dispatch_events();
+}
+
+void Simulation::simulate_until(ReplayedTetrion& replayed_tetrion, const SimulationStep target_simulation_step_index) {
+    while (replayed_tetrion.simulation_step_index < target_simulation_step_index and not is_finished(replayed_tetrion)
+    ) {
+        const auto next_simulation_step_index =
+                replayed_tetrion.input->next_active_step(replayed_tetrion.simulation_step_index);
+        if (next_simulation_step_index > target_simulation_step_index) {
+            replayed_tetrion.simulation_step_index = target_simulation_step_index;
+            break;
+        }
+
+        step(replayed_tetrion, next_simulation_step_index);
+    }
+}
+
+template<typename Function>
+void Simulation::for_each_in_parallel(Function function) {
+    // the tetrions of a recording never interact, so each one runs on its own without any synchronization, the
+    // threads just take the next tetrion as soon as they are done with one
+    const auto num_threads = std::min<usize>(m_num_threads, m_tetrions.size());
+    if (num_threads <= 1) {
+        for (auto& replayed_tetrion : m_tetrions) {
+            function(replayed_tetrion);
+        }
+        return;
+    }
+
+    // an exception (e.g. a diverged replay) can't leave a worker thread, so the first one is kept and rethrown here,
+    // after every thread stopped taking new tetrions
+    std::atomic<usize> next_index{ 0 };
+    std::atomic<bool> has_failed{ false };
+    std::mutex error_mutex;
+    std::exception_ptr error{};
+
+    const auto worker = [this, &function, &next_index, &has_failed, &error_mutex, &error]() {
+        for (auto index = next_index.fetch_add(1); index < m_tetrions.size() and not has_failed.load();
+             index = next_index.fetch_add(1)) {
+            try {
+                function(m_tetrions.at(index));
+            } catch (...) {
+                const std::lock_guard lock{ error_mutex };
+                if (error == nullptr) {
+                    error = std::current_exception();
+                }
+                has_failed.store(true);
+            }
+        }
     };
 
-    const auto input_as_replay = utils::is_child_class<input::ReplayGameInput>(m_input);
-    if (input_as_replay.has_value()) {
-        return input_as_replay.value()->is_end_of_recording();
+    {
+        std::vector<std::jthread> threads{};
+        threads.reserve(num_threads - 1);
+        for (usize i = 1; i < num_threads; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
     }
 
-    return false;
+    if (error != nullptr) {
+        std::rethrow_exception(error);
+    }
 }
@@ -8,25 +8,78 @@
 #include "input/replay_input.hpp"
 #include "simulated_tetrion.hpp"
 
+#include <vector>
+
 struct Simulation {
+public:
+    using Parameters = std::pair<std::shared_ptr<input::ReplayGameInput>, tetrion::StartingParameters>;
+
 private:
-    using TetrionHeaders = std::vector<recorder::TetrionHeader>;
+    struct ReplayedTetrion {
+        SimulationStep simulation_step_index{ 0 };
+        std::unique_ptr<SimulatedTetrion> tetrion;
+        std::shared_ptr<input::ReplayGameInput> input;
+        // seeking backwards without any keyframe has to start from here
+        TetrionState initial_state;
+    };
 
-    SimulationStep m_simulation_step_index{ 0 };
-    std::unique_ptr<SimulatedTetrion> m_tetrion;
-    std::shared_ptr<input::ReplayGameInput> m_input;
+    std::vector<ReplayedTetrion> m_tetrions;
+    u32 m_num_threads;
+    // the inputs share one stream, so the tetrions are simulated together on one thread
+    bool m_is_streamed{ false };
 
 public:
-    OOPETRIS_GRAPHICS_EXPORTED explicit Simulation(
-            const std::shared_ptr<input::ReplayGameInput>& input,
-            const tetrion::StartingParameters& starting_parameters
+    // a num_threads of 0 uses one thread per hardware thread
+    OOPETRIS_GRAPHICS_EXPORTED explicit Simulation(const std::vector<Parameters>& parameters, u32 num_threads = 0);
+
+    OOPETRIS_GRAPHICS_EXPORTED static helper::expected<Simulation, std::string> get_replay_simulation(
+            std::filesystem::path& recording_path,
+            u32 num_threads = 0
     );
 
     OOPETRIS_GRAPHICS_EXPORTED static helper::expected<Simulation, std::string> get_replay_simulation(
-            std::filesystem::path& recording_path
+            const std::shared_ptr<recorder::RecordingReader>& recording_reader,
+            u32 num_threads = 0
     );
 
+    // reads the recording once while replaying it, instead of loading it completely, so it can't be seeked, all
+    // tetrions are simulated on the calling thread
+    OOPETRIS_GRAPHICS_EXPORTED static helper::expected<Simulation, std::string> get_streaming_replay_simulation(
+            const std::filesystem::path& recording_path
+    );
+
+    // simulates the next step of every tetrion that isn't finished yet
     OOPETRIS_GRAPHICS_EXPORTED void update();
 
+    // skips all idle steps and simulates the next step at which anything can happen for any of the tetrions
+    OOPETRIS_GRAPHICS_EXPORTED void fast_forward();
+
+    // simulates every tetrion until its replay is finished, the tetrions don't interact, so they run in parallel, unless
+    // the recording is streamed
+    OOPETRIS_GRAPHICS_EXPORTED void simulate_to_end();
+
+    // continues the simulation at the given step, starting from the closest keyframe
+    OOPETRIS_GRAPHICS_EXPORTED void seek(SimulationStep simulation_step_index);
+
+    // the step of the tetrion that is furthest ahead, finished tetrions stay at their last step
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED SimulationStep simulation_step_index() const;
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED SimulationStep simulation_step_index(usize index) const;
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED usize num_tetrions() const;
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED const SimulatedTetrion& tetrion(usize index = 0) const;
+
     [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED bool is_game_finished() const;
+
+private:
+    [[nodiscard]] static bool is_finished(const ReplayedTetrion& replayed_tetrion);
+
+    static void step(ReplayedTetrion& replayed_tetrion, SimulationStep simulation_step_index);
+
+    static void simulate_until(ReplayedTetrion& replayed_tetrion, SimulationStep target_simulation_step_index);
+
+    // calls the function for every tetrion, spread over the worker threads
+    template<typename Function>
+    void for_each_in_parallel(Function function);
 };
@@ -3,7 +3,11 @@
 
 
 #include "game/simulated_tetrion.hpp"
+#include "helper/constants.hpp"
+#include "helper/graphic_utils.hpp"
+#include "helper/music_utils.hpp"
 #include "helper/platform.hpp"
+#include "manager/music_manager.hpp"
 #include "manager/resource_manager.hpp"
 #include "tetrion.hpp"
 #include "ui/components/label.hpp"
@@ -19,10 +23,12 @@ Tetrion::Tetrion(
         ServiceProvider* const service_provider,
         std::optional<std::shared_ptr<recorder::RecordingWriter>> recording_writer,
         const ui::Layout& layout,
-        bool is_top_level
+        bool is_top_level,
+        const RandomAlgorithm random_algorithm
 )
     : ui::Widget{ layout , ui::WidgetType::Component ,is_top_level},
-        SimulatedTetrion{tetrion_index,random_seed,starting_level, service_provider,std::move(recording_writer)},
+        SimulatedTetrion{tetrion_index,random_seed,starting_level, service_provider,std::move(recording_writer),
+                         random_algorithm},
       m_main_layout{
                 utils::SizeIdentity<2>(),
                 0,
@@ -77,34 +83,35 @@ void Tetrion::render(const ServiceProvider& service_provider) const {
     };
     const shapes::UPoint& tile_size = grid->tile_size();
 
-    helper::graphics::render_minos(m_mino_stack, service_provider, original_scale, to_screen_coords, tile_size);
-    if (m_active_tetromino.has_value()) {
-        m_active_tetromino->render(
+    helper::graphics::render_minos(m_state.mino_stack, service_provider, original_scale, to_screen_coords, tile_size);
+    if (m_state.active_tetromino.has_value()) {
+        m_state.active_tetromino->render(
                 service_provider, MinoTransparency::Solid, original_scale, to_screen_coords, tile_size,
                 grid::grid_position
         );
     }
-    if (m_ghost_tetromino.has_value()) {
-        m_ghost_tetromino->render(
+    if (m_state.ghost_tetromino.has_value()) {
+        m_state.ghost_tetromino->render(
                 service_provider, MinoTransparency::Ghost, original_scale, to_screen_coords, tile_size,
                 grid::grid_position
         );
     }
-    for (std::underlying_type_t<MinoTransparency> i = 0; i < static_cast<decltype(i)>(m_preview_tetrominos.size());
-         ++i) {
-        if (const auto current_preview_tetromino = m_preview_tetrominos.at(i); current_preview_tetromino.has_value()) {
-            static constexpr auto enum_index = magic_enum::enum_index(MinoTransparency::Preview0);
-            static_assert(enum_index.has_value());
-            const auto transparency = magic_enum::enum_value<MinoTransparency>(
-                    enum_index.value() + i // NOLINT(bugprone-unchecked-optional-access)
-            );
-            current_preview_tetromino->render(
-                    service_provider, transparency, original_scale, to_screen_coords, tile_size
-            );
-        }
+    const auto preview_tetromino_types = this->preview_tetromino_types();
+    for (std::underlying_type_t<MinoTransparency> i = 0;
+         i < static_cast<decltype(i)>(preview_tetromino_types.size()); ++i) {
+        static constexpr auto enum_index = magic_enum::enum_index(MinoTransparency::Preview0);
+        static_assert(enum_index.has_value());
+        const auto transparency = magic_enum::enum_value<MinoTransparency>(
+                enum_index.value() + i // NOLINT(bugprone-unchecked-optional-access)
+        );
+        const auto preview_tetromino = Tetromino{
+            grid::preview_tetromino_position + shapes::IPoint{ 0, grid::preview_padding * i },
+            preview_tetromino_types[i]
+        };
+        preview_tetromino.render(service_provider, transparency, original_scale, to_screen_coords, tile_size);
     }
-    if (m_tetromino_on_hold) {
-        m_tetromino_on_hold->render(
+    if (m_state.tetromino_on_hold) {
+        m_state.tetromino_on_hold->render(
                 service_provider, MinoTransparency::Solid, original_scale, to_screen_coords, tile_size
         );
     }
@@ -131,18 +138,61 @@ Tetrion::handle_event(const std::shared_ptr<input::InputManager>& /*input_manage
     return m_main_layout.get<ui::GridLayout>(1);
 }
 
+void Tetrion::dispatch_events() {
+    for (const auto& step_event : events()) {
+        std::visit(
+                helper::Overloaded{
+                        [this](const engine::Locked&) { refresh_texts(); },
+                        [](const engine::LinesCleared&) {},
+                        [this](const engine::LevelUp& level_up) {
+                            spdlog::info("new level: {}", level_up.level);
+                            play_music_for_level(level_up.previous_level, level_up.level);
+                        },
+                        [](const engine::GameOver&) { spdlog::info("game over"); },
+                        [](const engine::SnapshotRequested&) {},
+                        [](const engine::StateHashRequested&) {},
+                },
+                step_event.event
+        );
+    }
+
+    SimulatedTetrion::dispatch_events();
+}
+
+void Tetrion::restore_state(const TetrionState& state) {
+    SimulatedTetrion::restore_state(state);
+    refresh_texts();
+}
+
+void Tetrion::refresh_presentation(const u32 previous_level) {
+    refresh_texts();
+    play_music_for_level(previous_level, m_state.level);
+}
+
+void Tetrion::play_music_for_level(const u32 previous_level, const u32 level) {
+    if (previous_level < constants::music_change_level and level >= constants::music_change_level
+        and m_service_provider != nullptr) {
+        m_service_provider->music_manager()
+                .load_and_play_music(
+                        utils::get_assets_folder() / "music"
+                        / utils::get_supported_music_extension("03. Game Theme (50 Left)")
+                )
+                .and_then(utils::log_error);
+    }
+}
+
 void Tetrion::refresh_texts() {
     auto* text_layout = get_text_layout();
 
     std::stringstream stream;
-    stream << "score: " << m_score;
+    stream << "score: " << m_state.score;
     text_layout->get<ui::Label>(0)->set_text(*m_service_provider, stream.str());
 
     stream = std::stringstream{};
-    stream << "level: " << m_level;
+    stream << "level: " << m_state.level;
     text_layout->get<ui::Label>(1)->set_text(*m_service_provider, stream.str());
 
     stream = std::stringstream{};
-    stream << "lines: " << m_lines_cleared;
+    stream << "lines: " << m_state.lines_cleared;
     text_layout->get<ui::Label>(2)->set_text(*m_service_provider, stream.str());
 }
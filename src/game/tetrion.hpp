@@ -32,7 +32,8 @@ public:
             ServiceProvider* service_provider,
             std::optional<std::shared_ptr<recorder::RecordingWriter>> recording_writer,
             const ui::Layout& layout,
-            bool is_top_level
+            bool is_top_level,
+            RandomAlgorithm random_algorithm = Random::default_algorithm
     );
 
     OOPETRIS_GRAPHICS_EXPORTED ~Tetrion() override;
@@ -52,6 +53,15 @@ public:
     [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED ui::GridLayout* get_text_layout();
     [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED const ui::GridLayout* get_text_layout() const;
 
+    OOPETRIS_GRAPHICS_EXPORTED void dispatch_events() override;
+
+    OOPETRIS_GRAPHICS_EXPORTED void restore_state(const TetrionState& state) override;
+
+    // brings the texts and the music up to date, after steps whose events were only dispatched by the base class
+    OOPETRIS_GRAPHICS_EXPORTED void refresh_presentation(u32 previous_level);
+
 private:
-    void refresh_texts() override;
+    void refresh_texts();
+
+    void play_music_for_level(u32 previous_level, u32 level);
 };
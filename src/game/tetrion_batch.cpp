@@ -0,0 +1,184 @@
+#include "tetrion_batch.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+struct TetrionBatch::Workers {
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_work_available;
+    std::condition_variable m_work_done;
+    // the task of the current step, it's only valid until run_chunks returns
+    const std::function<void(usize)>* m_task{ nullptr };
+    u64 m_generation{ 0 };
+    usize m_num_chunks{ 0 };
+    usize m_num_pending{ 0 };
+    bool m_is_stopping{ false };
+
+    // started last, after everything they use is initialized
+    std::vector<std::thread> m_threads;
+
+public:
+    explicit Workers(const usize num_threads) {
+        m_threads.reserve(num_threads);
+        // chunk 0 is always run by the calling thread
+        for (usize chunk = 1; chunk <= num_threads; ++chunk) {
+            m_threads.emplace_back([this, chunk]() { run(chunk); });
+        }
+    }
+
+    Workers(const Workers&) = delete;
+    Workers(Workers&&) = delete;
+    Workers& operator=(const Workers&) = delete;
+    Workers& operator=(Workers&&) = delete;
+
+    ~Workers() {
+        {
+            const std::lock_guard lock{ m_mutex };
+            m_is_stopping = true;
+        }
+        m_work_available.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    // runs task(0) on the calling thread and task(1) to task(num_chunks - 1) on the workers, it returns once every
+    // chunk is done, so a step only wakes up the threads instead of creating them
+    void run_chunks(const std::function<void(usize)>& task, const usize num_chunks) {
+        assert(num_chunks <= m_threads.size() + 1 and "not enough worker threads for that many chunks");
+
+        {
+            const std::lock_guard lock{ m_mutex };
+            m_task = &task;
+            m_num_chunks = num_chunks;
+            m_num_pending = num_chunks - 1;
+            ++m_generation;
+        }
+        m_work_available.notify_all();
+
+        task(0);
+
+        std::unique_lock lock{ m_mutex };
+        m_work_done.wait(lock, [this]() { return m_num_pending == 0; });
+        m_task = nullptr;
+    }
+
+private:
+    void run(const usize chunk) {
+        u64 seen_generation = 0;
+        while (true) {
+            const std::function<void(usize)>* task = nullptr;
+            {
+                std::unique_lock lock{ m_mutex };
+                m_work_available.wait(lock, [this, seen_generation]() {
+                    return m_is_stopping or m_generation != seen_generation;
+                });
+                if (m_is_stopping) {
+                    return;
+                }
+
+                seen_generation = m_generation;
+                // steps with fewer games don't need every thread
+                if (chunk >= m_num_chunks) {
+                    continue;
+                }
+                task = m_task;
+            }
+
+            (*task)(chunk);
+
+            bool is_last = false;
+            {
+                const std::lock_guard lock{ m_mutex };
+                --m_num_pending;
+                is_last = m_num_pending == 0;
+            }
+            if (is_last) {
+                m_work_done.notify_one();
+            }
+        }
+    }
+};
+
+
+TetrionBatch::TetrionBatch(const std::span<const Random::Seed> seeds, const u32 starting_level, const u32 num_threads)
+    : m_num_threads{ num_threads == 0 ? std::max(1U, std::thread::hardware_concurrency()) : num_threads } {
+
+    // the SimulatedTetrion objects are stored in one vector, their piece sequence caches and event buffers are
+    // separate allocations
+    m_tetrions.reserve(seeds.size());
+    for (const auto seed : seeds) {
+        auto& tetrion = m_tetrions.emplace_back(0, seed, starting_level, nullptr, std::nullopt);
+        tetrion.spawn_next_tetromino(0);
+    }
+}
+
+TetrionBatch::TetrionBatch(TetrionBatch&& old) noexcept
+    : m_simulation_step_index{ old.m_simulation_step_index },
+      m_tetrions{ std::move(old.m_tetrions) },
+      m_num_threads{ old.m_num_threads },
+      m_workers{ std::move(old.m_workers) } { }
+
+TetrionBatch::~TetrionBatch() = default;
+
+void TetrionBatch::step(const std::span<const Command> commands) {
+    assert(commands.size() == m_tetrions.size() and "exactly one command slot per game is needed");
+
+    ++m_simulation_step_index;
+
+    // every game is independent, so the games can be split into contiguous chunks without any synchronization
+    static constexpr usize min_games_per_thread = 64;
+    const auto num_chunks = std::clamp<usize>(m_tetrions.size() / min_games_per_thread, 1, m_num_threads);
+    if (num_chunks == 1) {
+        step_range(commands, 0, m_tetrions.size());
+        return;
+    }
+
+    if (m_workers == nullptr) {
+        m_workers = std::make_unique<Workers>(m_num_threads - 1);
+    }
+
+    const auto chunk_size = (m_tetrions.size() + num_chunks - 1) / num_chunks;
+    const std::function<void(usize)> task = [this, commands, chunk_size](const usize chunk) {
+        const auto begin = std::min(chunk * chunk_size, m_tetrions.size());
+        const auto end = std::min(begin + chunk_size, m_tetrions.size());
+        step_range(commands, begin, end);
+    };
+    m_workers->run_chunks(task, num_chunks);
+}
+
+[[nodiscard]] usize TetrionBatch::size() const {
+    return m_tetrions.size();
+}
+
+[[nodiscard]] const SimulatedTetrion& TetrionBatch::at(const usize index) const {
+    return m_tetrions.at(index);
+}
+
+[[nodiscard]] SimulationStep TetrionBatch::simulation_step_index() const {
+    return m_simulation_step_index;
+}
+
+[[nodiscard]] bool TetrionBatch::all_games_over() const {
+    return std::ranges::all_of(m_tetrions, [](const SimulatedTetrion& tetrion) { return tetrion.is_game_over(); });
+}
+
+void TetrionBatch::step_range(const std::span<const Command> commands, const usize begin, const usize end) {
+    for (auto index = begin; index < end; ++index) {
+        auto& tetrion = m_tetrions.at(index);
+        if (tetrion.is_game_over()) {
+            continue;
+        }
+
+        if (const auto& command = commands[index]; command.has_value()) {
+            tetrion.handle_input_command(command.value(), m_simulation_step_index);
+        }
+        tetrion.update_step(m_simulation_step_index);
+    }
+}
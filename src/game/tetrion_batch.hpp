@@ -0,0 +1,61 @@
+#pragma once
+
+#include <core/helper/random.hpp>
+#include <core/helper/types.hpp>
+
+#include "helper/export_symbols.hpp"
+#include "input/game_input.hpp"
+#include "simulated_tetrion.hpp"
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+// a parallel batch runner, that advances many independent headless games in lockstep, e.g. for training bots or
+// validating recordings in bulk, every game is a complete SimulatedTetrion (an array of objects, not a structure of
+// arrays), that owns heap memory for its cached piece sequence and its pending events, the speedup only comes from
+// stepping the games on several threads
+struct TetrionBatch final {
+public:
+    using Command = std::optional<input::GameInputCommand>;
+
+private:
+    // threads that stay alive between steps, in their own allocation, so that the batch stays movable
+    struct Workers;
+
+    SimulationStep m_simulation_step_index{ 0 };
+    std::vector<SimulatedTetrion> m_tetrions;
+    u32 m_num_threads;
+    // only started, once there are enough games for more than one thread
+    std::unique_ptr<Workers> m_workers;
+
+public:
+    // a num_threads of 0 uses one thread per hardware thread
+    OOPETRIS_GRAPHICS_EXPORTED
+    TetrionBatch(std::span<const Random::Seed> seeds, u32 starting_level, u32 num_threads = 0);
+
+    OOPETRIS_GRAPHICS_EXPORTED TetrionBatch(TetrionBatch&& old) noexcept;
+
+    TetrionBatch(const TetrionBatch&) = delete;
+    TetrionBatch& operator=(const TetrionBatch&) = delete;
+    TetrionBatch& operator=(TetrionBatch&&) = delete;
+
+    // stops and joins the worker threads
+    OOPETRIS_GRAPHICS_EXPORTED ~TetrionBatch();
+
+    // applies commands[i] to game i and then simulates the next step of every game,
+    // this is the same as issuing the command from an input and calling update_step afterwards
+    OOPETRIS_GRAPHICS_EXPORTED void step(std::span<const Command> commands);
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED usize size() const;
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED const SimulatedTetrion& at(usize index) const;
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED SimulationStep simulation_step_index() const;
+
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED bool all_games_over() const;
+
+private:
+    void step_range(std::span<const Command> commands, usize begin, usize end);
+};
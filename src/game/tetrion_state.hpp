@@ -0,0 +1,60 @@
+#pragma once
+
+#include <core/game/mino_stack.hpp>
+#include <core/helper/random.hpp>
+#include <core/helper/types.hpp>
+
+#include "tetromino.hpp"
+
+#include <array>
+#include <optional>
+#include <type_traits>
+
+
+enum class GameState : u8 {
+    Playing,
+    GameOver,
+};
+
+// the complete mutable state of a tetrion, without any references to the outside world (recording, rendering, ...)
+// it is trivially copyable, so cloning, saving and restoring a game is a plain copy of this struct
+struct TetrionState final {
+    static constexpr u8 num_preview_tetrominos = 6;
+
+    MinoStack mino_stack;
+    u32 level;
+    u32 lines_cleared{ 0 };
+    u64 score{ 0 };
+    u32 num_locked_tetrominos{ 0 };
+
+    std::optional<Tetromino> active_tetromino;
+    std::optional<Tetromino> ghost_tetromino;
+    std::optional<Tetromino> tetromino_on_hold;
+
+    bool is_accelerated_down_movement{ false };
+    bool down_key_pressed{ false };
+    bool allowed_to_hold{ true };
+    bool is_in_lock_delay{ false };
+    u32 num_executed_lock_delays{ 0 };
+    u64 lock_delay_step_index;
+    u64 next_gravity_simulation_step_index{ 0 };
+
+    GameState game_state{ GameState::Playing };
+    // the pieces themselves come from the PieceSequence of this seed, this is the index of the next one
+    Random::Seed random_seed;
+    RandomAlgorithm random_algorithm;
+    u64 sequence_position{ 0 };
+
+    TetrionState(
+            const Random::Seed random_seed,
+            const u32 starting_level,
+            const u64 lock_delay_step_index,
+            const RandomAlgorithm random_algorithm = Random::default_algorithm
+    )
+        : level{ starting_level },
+          lock_delay_step_index{ lock_delay_step_index },
+          random_seed{ random_seed },
+          random_algorithm{ random_algorithm } { }
+};
+
+static_assert(std::is_trivially_copyable_v<TetrionState>, "TetrionState has to be cheap to clone");
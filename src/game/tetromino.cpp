@@ -10,6 +10,10 @@
     return m_rotation;
 }
 
+[[nodiscard]] const grid::GridPoint& Tetromino::position() const {
+    return m_position;
+}
+
 void Tetromino::render(
         const ServiceProvider& service_provider,
         MinoTransparency transparency,
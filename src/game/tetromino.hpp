@@ -6,7 +6,9 @@
 #include "helper/export_symbols.hpp"
 #include "rotation.hpp"
 
+#include <algorithm>
 #include <array>
+#include <bit>
 
 
 struct Tetromino final {
@@ -22,6 +24,14 @@ public:
     using TetrominoPoint = shapes::AbstractPoint<i8>;
     using Pattern = std::array<TetrominoPoint, 4>;
 
+    // the occupancy of a pattern as row bitmasks (same bit layout as MinoStack::RowMask), relative to the position
+    struct ShapeMask {
+        std::array<MinoStack::RowMask, 4> rows;
+        // inclusive bounding box of the pattern
+        TetrominoPoint min;
+        TetrominoPoint max;
+    };
+
     OOPETRIS_GRAPHICS_EXPORTED Tetromino(grid::GridPoint position, helper::TetrominoType type)
         : m_position{ position },
           m_type{ type },
@@ -29,6 +39,7 @@ public:
 
     [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED helper::TetrominoType type() const;
     [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED Rotation rotation() const;
+    [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED const grid::GridPoint& position() const;
 
     OOPETRIS_GRAPHICS_EXPORTED void render(
             const ServiceProvider& service_provider,
@@ -49,6 +60,10 @@ public:
 
     [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED const std::array<Mino, 4>& minos() const;
 
+    [[nodiscard]] static constexpr const ShapeMask& get_shape_mask(helper::TetrominoType type, Rotation rotation) {
+        return shape_masks.at(static_cast<usize>(type)).at(static_cast<usize>(rotation));
+    }
+
 
 private:
     void refresh_minos();
@@ -112,4 +127,42 @@ private:
                           },
     };
     // clang-format on
+
+    using ShapeMasks = std::array<std::array<ShapeMask, 4>, 7>;
+
+    // generated at compile time from the patterns above, so collision tests don't have to expand any pattern
+    static constexpr ShapeMasks shape_masks = [] {
+        ShapeMasks result{};
+        for (usize type = 0; type < tetrominos.size(); ++type) {
+            for (usize rotation = 0; rotation < tetrominos.at(type).size(); ++rotation) {
+                const auto& pattern = tetrominos.at(type).at(rotation);
+                auto& mask = result.at(type).at(rotation);
+
+                mask.min = pattern.front();
+                mask.max = pattern.front();
+                for (const auto& point : pattern) {
+                    mask.rows.at(static_cast<usize>(point.y)) |= static_cast<MinoStack::RowMask>(1U << point.x);
+                    mask.min = TetrominoPoint{ std::min(mask.min.x, point.x), std::min(mask.min.y, point.y) };
+                    mask.max = TetrominoPoint{ std::max(mask.max.x, point.x), std::max(mask.max.y, point.y) };
+                }
+            }
+        }
+        return result;
+    }();
+
+    static_assert(
+            std::ranges::all_of(
+                    shape_masks,
+                    [](const auto& masks) {
+                        return std::ranges::all_of(masks, [](const ShapeMask& mask) {
+                            return std::popcount(static_cast<u32>(mask.rows.at(0)))
+                                           + std::popcount(static_cast<u32>(mask.rows.at(1)))
+                                           + std::popcount(static_cast<u32>(mask.rows.at(2)))
+                                           + std::popcount(static_cast<u32>(mask.rows.at(3)))
+                                   == 4;
+                        });
+                    }
+            ),
+            "every pattern has to consist of 4 distinct minos"
+    );
 };
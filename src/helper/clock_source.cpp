@@ -14,7 +14,8 @@ namespace {
 
 LocalClock::LocalClock(const u32 target_frequency)
     : m_start_time{ elapsed_time() },
-      m_step_duration{ 1.0 / static_cast<double>(target_frequency) } {
+      m_target_step_duration{ 1.0 / static_cast<double>(target_frequency) },
+      m_step_duration{ m_target_step_duration } {
     assert(target_frequency >= 1);
 }
 
@@ -45,3 +46,19 @@ double LocalClock::resume() {
     spdlog::info("resuming clock (duration of pause: {} s)", duration);
     return duration;
 }
+
+void LocalClock::seek(const SimulationStep simulation_step_index) {
+    // while paused, the time that passes until resume() is added to the start time anyways
+    const auto now = m_paused_at.value_or(elapsed_time());
+    m_start_time = now - static_cast<double>(simulation_step_index) * m_step_duration;
+}
+
+void LocalClock::set_speed(const double speed) {
+    assert(speed > 0.0);
+
+    // the clock continues from the exact (fractional) step it is at right now
+    const auto now = m_paused_at.value_or(elapsed_time());
+    const auto position = (now - m_start_time) / m_step_duration;
+    m_step_duration = m_target_step_duration / speed;
+    m_start_time = now - position * m_step_duration;
+}
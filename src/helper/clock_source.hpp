@@ -25,11 +25,22 @@ struct ClockSource {
     OOPETRIS_GRAPHICS_EXPORTED virtual double resume() {
         throw std::runtime_error("not implemented");
     };
+
+    // moves the clock, so that it continues counting from the given step
+    OOPETRIS_GRAPHICS_EXPORTED virtual void seek(SimulationStep /*simulation_step_index*/) {
+        throw std::runtime_error("not implemented");
+    }
+
+    // changes how fast the steps advance compared to real time, e.g. 2.0 is twice the target frequency
+    OOPETRIS_GRAPHICS_EXPORTED virtual void set_speed(double /*speed*/) {
+        throw std::runtime_error("not implemented");
+    }
 };
 
 struct LocalClock : public ClockSource {
 private:
     double m_start_time;
+    double m_target_step_duration;
     double m_step_duration;
     std::optional<double> m_paused_at;
 
@@ -39,4 +50,6 @@ public:
     OOPETRIS_GRAPHICS_EXPORTED bool can_be_paused() override;
     OOPETRIS_GRAPHICS_EXPORTED void pause() override;
     OOPETRIS_GRAPHICS_EXPORTED double resume() override;
+    OOPETRIS_GRAPHICS_EXPORTED void seek(SimulationStep simulation_step_index) override;
+    OOPETRIS_GRAPHICS_EXPORTED void set_speed(double speed) override;
 };
@@ -4,6 +4,8 @@
 
 #include "helper/spdlog_wrapper.hpp"
 
+#include <algorithm>
+
 
 void input::GameInput::handle_event(const InputEvent event, const SimulationStep simulation_step_index) {
     if (m_on_event_callback) {
@@ -90,9 +92,10 @@ void input::GameInput::update(const SimulationStep simulation_step_index) {
 
     for (auto& [key, target_simulation_step_index] : m_keys_hold) {
         if (current_simulation_step_index >= target_simulation_step_index) {
-            while (target_simulation_step_index <= current_simulation_step_index) { // NOLINT(bugprone-infinite-loop)
-                target_simulation_step_index += auto_repeat_rate_frames;
-            }
+            // the target can be far behind, e.g. after both keys were held for a while, so it catches up in one go
+            target_simulation_step_index +=
+                    ((current_simulation_step_index - target_simulation_step_index) / auto_repeat_rate_frames + 1)
+                    * auto_repeat_rate_frames;
             if ((key == HoldableKey::Left
                  and not m_target_tetrion->handle_input_command(GameInputCommand::MoveLeft, simulation_step_index))
                 or (key == HoldableKey::Right
@@ -108,3 +111,53 @@ void input::GameInput::update(const SimulationStep simulation_step_index) {
 void input::GameInput::late_update(SimulationStep /*simulation_step*/) {
     //do nothing, is expected here, this is virtual, so if there is soemthing to do, it gets overridden
 }
+
+[[nodiscard]] SimulationStep input::GameInput::next_event_step(const SimulationStep simulation_step_index) const {
+    return simulation_step_index + 1;
+}
+
+[[nodiscard]] SimulationStep input::GameInput::next_active_step(const SimulationStep simulation_step_index) const {
+    auto result = next_event_step(simulation_step_index);
+
+    if (const auto gravity_step = m_target_tetrion->next_gravity_step(); gravity_step.has_value()) {
+        result = std::min(result, gravity_step.value());
+    }
+
+    return std::max(result, simulation_step_index + 1);
+}
+
+[[nodiscard]] std::optional<SimulationStep> input::GameInput::next_auto_shift_step() const {
+    // while both keys are held, update() doesn't shift at all
+    if (m_keys_hold.contains(HoldableKey::Left) and m_keys_hold.contains(HoldableKey::Right)) {
+        return std::nullopt;
+    }
+
+    std::optional<SimulationStep> result{};
+    for (const auto& [key, target_simulation_step_index] : m_keys_hold) {
+        if (not result.has_value() or target_simulation_step_index < result.value()) {
+            result = target_simulation_step_index;
+        }
+    }
+    return result;
+}
+
+[[nodiscard]] input::GameInput::HeldKeys input::GameInput::held_keys() const {
+    HeldKeys result{};
+    if (const auto left = m_keys_hold.find(HoldableKey::Left); left != m_keys_hold.end()) {
+        result.left = left->second;
+    }
+    if (const auto right = m_keys_hold.find(HoldableKey::Right); right != m_keys_hold.end()) {
+        result.right = right->second;
+    }
+    return result;
+}
+
+void input::GameInput::restore_held_keys(const HeldKeys& held_keys) {
+    m_keys_hold.clear();
+    if (held_keys.left.has_value()) {
+        m_keys_hold[HoldableKey::Left] = held_keys.left.value();
+    }
+    if (held_keys.right.has_value()) {
+        m_keys_hold[HoldableKey::Right] = held_keys.right.value();
+    }
+}
@@ -6,6 +6,7 @@
 
 #include <SDL.h>
 #include <functional>
+#include <optional>
 #include <unordered_map>
 
 #include "helper/export_symbols.hpp"
@@ -42,6 +43,12 @@ namespace input {
     public:
         using OnEventCallback = std::function<void(InputEvent, SimulationStep)>;
 
+        // the auto shift state, i.e. the next step at which each held key shifts again
+        struct HeldKeys {
+            std::optional<SimulationStep> left;
+            std::optional<SimulationStep> right;
+        };
+
     private:
         static constexpr u64 delayed_auto_shift_frames = 10;
         static constexpr u64 auto_repeat_rate_frames = 2;
@@ -64,6 +71,9 @@ namespace input {
             return m_on_event_callback;
         }
 
+        // the next step at which a held key auto shifts, if there is any
+        [[nodiscard]] std::optional<SimulationStep> next_auto_shift_step() const;
+
     public:
         GameInput(const GameInput&) = delete;
         GameInput& operator=(const GameInput&) = delete;
@@ -76,6 +86,17 @@ namespace input {
         OOPETRIS_GRAPHICS_EXPORTED virtual void update(SimulationStep simulation_step_index);
         OOPETRIS_GRAPHICS_EXPORTED virtual void late_update(SimulationStep simulation_step);
 
+        // the earliest step after the given one, at which this input might do anything
+        // live input can arrive at any time, so by default this is always the next step
+        [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED virtual SimulationStep next_event_step(
+                SimulationStep simulation_step_index
+        ) const;
+
+        // the earliest step after the given one, at which either this input or the target tetrion might change
+        // anything, all steps in between are idle and can be skipped
+        [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED SimulationStep next_active_step(SimulationStep simulation_step_index
+        ) const;
+
         [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED virtual std::optional<MenuEvent> get_menu_event(const SDL_Event& event
         ) const = 0;
 
@@ -98,6 +119,10 @@ namespace input {
             m_on_event_callback = std::move(on_event_callback);
         }
 
+        [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED HeldKeys held_keys() const;
+
+        OOPETRIS_GRAPHICS_EXPORTED void restore_held_keys(const HeldKeys& held_keys);
+
 
         [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED virtual const Input* underlying_input() const = 0;
     };
@@ -21,7 +21,7 @@ namespace {
 
     [[nodiscard]] recorder::TetrionHeader create_tetrion_headers_for_one(const input::AdditionalInfo& info) {
         const auto& needed_info = std::get<1>(info);
-        return recorder::TetrionHeader{ needed_info.seed, needed_info.starting_level };
+        return recorder::TetrionHeader{ needed_info.seed, needed_info.starting_level, needed_info.random_algorithm };
     }
 
     [[nodiscard]] u32 get_target_fps(ServiceProvider* const service_provider) {
@@ -86,8 +86,9 @@ input::get_game_parameters_for_replay(
         const auto seed = header.seed;
         const auto starting_level = header.starting_level;
 
-        const tetrion::StartingParameters starting_parameters = { target_fps, seed, starting_level, tetrion_index,
-                                                                  std::nullopt };
+        const tetrion::StartingParameters starting_parameters = {
+            target_fps, seed, starting_level, tetrion_index, std::nullopt, header.random_algorithm
+        };
 
         result.emplace_back(std::move(input), starting_parameters);
     }
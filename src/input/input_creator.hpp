@@ -17,19 +17,22 @@ namespace tetrion {
         u32 starting_level;
         u8 tetrion_index;
         std::optional<std::shared_ptr<recorder::RecordingWriter>> recording_writer;
+        RandomAlgorithm random_algorithm;
 
         StartingParameters(
                 u32 target_fps,
                 Random::Seed seed,
                 u32 starting_level, // NOLINT(bugprone-easily-swappable-parameters)
                 u8 tetrion_index,
-                std::optional<std::shared_ptr<recorder::RecordingWriter>> recording_writer = std::nullopt
+                std::optional<std::shared_ptr<recorder::RecordingWriter>> recording_writer = std::nullopt,
+                RandomAlgorithm random_algorithm = Random::default_algorithm
         )
             : target_fps{ target_fps },
               seed{ seed },
               starting_level{ starting_level },
               tetrion_index{ tetrion_index },
-              recording_writer{ std::move(recording_writer) } { }
+              recording_writer{ std::move(recording_writer) },
+              random_algorithm{ random_algorithm } { }
     };
 } // namespace tetrion
 
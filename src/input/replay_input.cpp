@@ -3,6 +3,11 @@
 #include "helper/spdlog_wrapper.hpp"
 #include <core/helper/magic_enum_wrapper.hpp>
 
+#include <algorithm>
+#include <limits>
+#include <ranges>
+#include <variant>
+
 input::ReplayGameInput::ReplayGameInput(
         std::shared_ptr<recorder::RecordingReader> recording_reader,
         const Input* underlying_input
@@ -11,7 +16,21 @@ input::ReplayGameInput::ReplayGameInput(
       m_recording_reader{ std::move(recording_reader) },
       m_underlying_input{ underlying_input } { }
 
+input::ReplayGameInput::ReplayGameInput(
+        std::shared_ptr<recorder::SharedRecordingStream> recording_stream,
+        const Input* underlying_input
+)
+    : GameInput{ GameInputType::Recording },
+      m_recording_stream{ std::move(recording_stream) },
+      m_underlying_input{ underlying_input } { }
+
 void input::ReplayGameInput::update(const SimulationStep simulation_step_index) {
+    if (m_recording_stream != nullptr) {
+        update_streamed(simulation_step_index);
+        GameInput::update(simulation_step_index);
+        return;
+    }
+
     while (true) {
         if (is_end_of_recording()) {
             break;
@@ -44,6 +63,16 @@ void input::ReplayGameInput::update(const SimulationStep simulation_step_index)
 void input::ReplayGameInput::late_update(const SimulationStep simulation_step_index) {
     GameInput::late_update(simulation_step_index);
 
+    if (m_recording_stream != nullptr) {
+        late_update_streamed(simulation_step_index);
+        return;
+    }
+
+    compare_snapshots(simulation_step_index);
+    compare_state_hashes(simulation_step_index);
+}
+
+void input::ReplayGameInput::compare_snapshots(const SimulationStep simulation_step_index) {
     while (true) {
         if (m_next_snapshot_index >= m_recording_reader->snapshots().size()) {
             break;
@@ -62,25 +91,194 @@ void input::ReplayGameInput::late_update(const SimulationStep simulation_step_in
             break;
         }
 
-        // create a snapshot from the current state of the tetrion and compare it to the loaded snapshot
-        const auto current_snapshot = TetrionSnapshot{ target_tetrion()->core_information(), simulation_step_index };
+        compare_snapshot(snapshot, simulation_step_index);
 
+        ++m_next_snapshot_index;
+    }
+}
 
-        spdlog::info("comparing tetrion snapshots at simulation_step {}", simulation_step_index);
+void input::ReplayGameInput::compare_state_hashes(const SimulationStep simulation_step_index) {
+    const auto tetrion_index = target_tetrion()->tetrion_index();
+    const auto& state_hashes = m_recording_reader->state_hashes();
 
-        const auto compare_result = current_snapshot.compare_to(snapshot);
-        if (compare_result.has_value()) {
-            spdlog::info("snapshots are equal");
-        } else {
-            spdlog::error("{}", compare_result.error());
-            throw std::runtime_error{ "snapshots are not equal" };
+    while (m_next_state_hash_index < state_hashes.size()) {
+        const auto& state_hash = state_hashes.at(m_next_state_hash_index);
+        if (state_hash.tetrion_index != tetrion_index) {
+            ++m_next_state_hash_index;
+            continue;
         }
 
-        ++m_next_snapshot_index;
+        if (state_hash.simulation_step_index != simulation_step_index) {
+            break;
+        }
+
+        compare_state_hash(state_hash, simulation_step_index);
+        ++m_next_state_hash_index;
+    }
+}
+
+
+void input::ReplayGameInput::compare_snapshot(const TetrionSnapshot& snapshot, const SimulationStep simulation_step_index)
+        const {
+    // create a snapshot from the current state of the tetrion and compare it to the loaded snapshot
+    const auto current_snapshot = TetrionSnapshot{ target_tetrion()->core_information(), simulation_step_index };
+
+
+    spdlog::info("comparing tetrion snapshots at simulation_step {}", simulation_step_index);
+
+    const auto compare_result = current_snapshot.compare_to(snapshot);
+    if (compare_result.has_value()) {
+        spdlog::info("snapshots are equal");
+    } else {
+        spdlog::error("{}", compare_result.error());
+        throw std::runtime_error{ fmt::format(
+                "snapshots at simulation step {} are not equal: {}", simulation_step_index, compare_result.error()
+        ) };
+    }
+}
+
+void input::ReplayGameInput::compare_state_hash(
+        const recorder::StateHash& state_hash,
+        const SimulationStep simulation_step_index
+) {
+    if (const auto hash = target_tetrion()->state_hash(); hash != state_hash.hash) {
+        const auto message = fmt::format(
+                "state hashes at simulation step {} are not equal: expected {:016x} but got {:016x}, the replay "
+                "diverged after simulation step {}",
+                simulation_step_index, state_hash.hash, hash, m_last_matching_simulation_step_index
+        );
+        spdlog::error("{}", message);
+        throw std::runtime_error{ message };
+    }
+
+    m_last_matching_simulation_step_index = simulation_step_index;
+}
+
+bool input::ReplayGameInput::read_pending_entry() const {
+    const auto tetrion_index = target_tetrion()->tetrion_index();
+
+    while (auto entry = m_recording_stream->next(tetrion_index)) {
+        // keyframes are only needed for seeking, which isn't possible in a stream
+        if (std::holds_alternative<TetrionKeyframe>(entry.value())) {
+            continue;
+        }
+
+        m_pending_entries.push_back(std::move(entry.value()));
+        return true;
+    }
+
+    if (const auto& error = m_recording_stream->error(); error.has_value()) {
+        throw std::runtime_error{ fmt::format("an error occurred while reading recording: {}", error.value()) };
+    }
+
+    return false;
+}
+
+void input::ReplayGameInput::read_pending_entries_until(const SimulationStep simulation_step_index) const {
+    // the entries of a tetrion are written in the order of their steps
+    while (m_pending_entries.empty()
+           or recorder::simulation_step_index_of(m_pending_entries.back()) <= simulation_step_index) {
+        if (not read_pending_entry()) {
+            break;
+        }
+    }
+}
+
+void input::ReplayGameInput::update_streamed(const SimulationStep simulation_step_index) {
+    read_pending_entries_until(simulation_step_index);
+
+    for (const auto& entry : m_pending_entries) {
+        const auto* record = std::get_if<recorder::Record>(&entry);
+        if (record == nullptr or record->simulation_step_index != simulation_step_index) {
+            continue;
+        }
+
+        spdlog::debug("replaying event {} at step {}", magic_enum::enum_name(record->event), simulation_step_index);
+
+        GameInput::handle_event(record->event, simulation_step_index);
+    }
+
+    std::erase_if(m_pending_entries, [simulation_step_index](const auto& entry) {
+        return std::holds_alternative<recorder::Record>(entry)
+               and recorder::simulation_step_index_of(entry) <= simulation_step_index;
+    });
+}
+
+void input::ReplayGameInput::late_update_streamed(const SimulationStep simulation_step_index) {
+    for (const auto& entry : m_pending_entries) {
+        if (recorder::simulation_step_index_of(entry) != simulation_step_index) {
+            continue;
+        }
+
+        if (const auto* snapshot = std::get_if<TetrionSnapshot>(&entry); snapshot != nullptr) {
+            compare_snapshot(*snapshot, simulation_step_index);
+        } else if (const auto* state_hash = std::get_if<recorder::StateHash>(&entry); state_hash != nullptr) {
+            compare_state_hash(*state_hash, simulation_step_index);
+        }
     }
+
+    // only records are left for later steps
+    std::erase_if(m_pending_entries, [simulation_step_index](const auto& entry) {
+        return recorder::simulation_step_index_of(entry) <= simulation_step_index;
+    });
 }
 
 
+[[nodiscard]] SimulationStep input::ReplayGameInput::next_event_step(const SimulationStep simulation_step_index
+) const {
+    auto result = next_recorded_step();
+
+    if (const auto auto_shift_step = next_auto_shift_step(); auto_shift_step.has_value()) {
+        result = std::min(result, auto_shift_step.value());
+    }
+
+    return std::max(result, simulation_step_index + 1);
+}
+
+[[nodiscard]] SimulationStep input::ReplayGameInput::next_recorded_step() const {
+    auto result = std::numeric_limits<SimulationStep>::max();
+
+    if (m_recording_stream != nullptr) {
+        if (m_pending_entries.empty()) {
+            std::ignore = read_pending_entry();
+        }
+        if (not m_pending_entries.empty()) {
+            result = recorder::simulation_step_index_of(m_pending_entries.front());
+        }
+        return result;
+    }
+
+    const auto tetrion_index = target_tetrion()->tetrion_index();
+
+    for (auto i = m_next_record_index; i < m_recording_reader->num_records(); ++i) {
+        const auto& record = m_recording_reader->at(i);
+        if (record.tetrion_index == tetrion_index) {
+            result = std::min(result, record.simulation_step_index);
+            break;
+        }
+    }
+
+    const auto& snapshots = m_recording_reader->snapshots();
+    for (auto i = m_next_snapshot_index; i < snapshots.size(); ++i) {
+        const auto& snapshot = snapshots.at(i);
+        if (snapshot.tetrion_index() == tetrion_index) {
+            result = std::min(result, snapshot.simulation_step_index());
+            break;
+        }
+    }
+
+    const auto& state_hashes = m_recording_reader->state_hashes();
+    for (auto i = m_next_state_hash_index; i < state_hashes.size(); ++i) {
+        const auto& state_hash = state_hashes.at(i);
+        if (state_hash.tetrion_index == tetrion_index) {
+            result = std::min(result, state_hash.simulation_step_index);
+            break;
+        }
+    }
+
+    return result;
+}
+
 [[nodiscard]] std::optional<input::MenuEvent> input::ReplayGameInput::get_menu_event(const SDL_Event& /*event*/) const {
     return std::nullopt;
 }
@@ -90,9 +288,66 @@ void input::ReplayGameInput::late_update(const SimulationStep simulation_step_in
 }
 
 [[nodiscard]] bool input::ReplayGameInput::is_end_of_recording() const {
+    if (m_recording_stream != nullptr) {
+        // the replay ends after the last record of the target tetrion, the stream knows that without reading ahead
+        return std::ranges::none_of(
+                       m_pending_entries,
+                       [](const auto& entry) { return std::holds_alternative<recorder::Record>(entry); }
+               )
+               and not m_recording_stream->has_unread_records(target_tetrion()->tetrion_index());
+    }
+
     return m_next_record_index >= m_recording_reader->num_records();
 }
 
 [[nodiscard]] const input::Input* input::ReplayGameInput::underlying_input() const {
     return m_underlying_input;
 }
+
+[[nodiscard]] const TetrionKeyframe* input::ReplayGameInput::keyframe_before(const SimulationStep simulation_step_index
+) const {
+    if (m_recording_stream != nullptr) {
+        return nullptr;
+    }
+
+    const auto tetrion_index = target_tetrion()->tetrion_index();
+
+    // the replay ends with the last record of the tetrion, keyframes written after that are never reached by it
+    const auto last_simulation_step_index = m_recording_reader->last_record_step(tetrion_index).value_or(0);
+
+    return m_recording_reader->keyframe_before(
+            tetrion_index, std::min(simulation_step_index, last_simulation_step_index)
+    );
+}
+
+[[nodiscard]] bool input::ReplayGameInput::matches_recorded_state_hash(const SimulationStep simulation_step_index
+) const {
+    // nothing is recorded before the first step
+    if (m_recording_stream != nullptr or simulation_step_index == 0) {
+        return true;
+    }
+
+    const auto tetrion_index = target_tetrion()->tetrion_index();
+    const auto& state_hashes = m_recording_reader->state_hashes();
+    const auto index = m_recording_reader->next_state_hash_index(tetrion_index, simulation_step_index - 1);
+    if (index >= state_hashes.size() or state_hashes.at(index).simulation_step_index != simulation_step_index) {
+        return true;
+    }
+
+    return state_hashes.at(index).hash == target_tetrion()->state_hash();
+}
+
+void input::ReplayGameInput::seek(const SimulationStep simulation_step_index, const HeldKeys& held_keys) {
+    assert(m_recording_stream == nullptr and "a streamed recording can't be seeked");
+
+    const auto tetrion_index = target_tetrion()->tetrion_index();
+
+    // everything of the target tetrion up to (and including) the given step was already consumed
+    m_next_record_index = m_recording_reader->next_record_index(tetrion_index, simulation_step_index);
+    m_next_snapshot_index = m_recording_reader->next_snapshot_index(tetrion_index, simulation_step_index);
+    m_next_state_hash_index = m_recording_reader->next_state_hash_index(tetrion_index, simulation_step_index);
+    // the restored state is trusted, a later mismatch happened after it
+    m_last_matching_simulation_step_index = simulation_step_index;
+
+    restore_held_keys(held_keys);
+}
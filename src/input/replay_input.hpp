@@ -1,10 +1,12 @@
 #pragma once
 
 #include <recordings/utility/recording_reader.hpp>
+#include <recordings/utility/recording_stream.hpp>
 
 #include "game_input.hpp"
 #include "helper/export_symbols.hpp"
 
+#include <deque>
 #include <memory>
 
 namespace input {
@@ -13,17 +15,36 @@ namespace input {
     struct ReplayGameInput : public GameInput {
     private:
         std::shared_ptr<recorder::RecordingReader> m_recording_reader;
+        // only set, if the recording is streamed instead of loaded at once, the entries are read on demand then, the
+        // stream is shared with the inputs of the other tetrions, so the recording is only read once
+        std::shared_ptr<recorder::SharedRecordingStream> m_recording_stream;
+        // already read entries of the target tetrion (without keyframes), in the order of the recording
+        mutable std::deque<recorder::RecordingStream::Entry> m_pending_entries;
         usize m_next_record_index{ 0 };
         usize m_next_snapshot_index{ 0 };
+        usize m_next_state_hash_index{ 0 };
+        // the replay is known to be in sync up to this step
+        SimulationStep m_last_matching_simulation_step_index{ 0 };
         const Input* m_underlying_input;
 
     public:
         OOPETRIS_GRAPHICS_EXPORTED
         ReplayGameInput(std::shared_ptr<recorder::RecordingReader> recording_reader, const Input* underlying_input);
 
+        // replays the recording forward only, while reading it, so neither keyframes nor seeking are available
+        OOPETRIS_GRAPHICS_EXPORTED
+        ReplayGameInput(
+                std::shared_ptr<recorder::SharedRecordingStream> recording_stream,
+                const Input* underlying_input
+        );
+
         OOPETRIS_GRAPHICS_EXPORTED void update(SimulationStep simulation_step_index) override;
         OOPETRIS_GRAPHICS_EXPORTED void late_update(SimulationStep simulation_step_index) override;
 
+        // the next step with either a record, a snapshot or a state hash for the target tetrion, or an auto shift
+        [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED SimulationStep next_event_step(SimulationStep simulation_step_index
+        ) const override;
+
         [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED std::optional<MenuEvent> get_menu_event(const SDL_Event& event
         ) const override;
 
@@ -31,7 +52,41 @@ namespace input {
 
         [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED bool is_end_of_recording() const;
 
+        // the latest keyframe of the target tetrion at or before the given step, if there is any (never when streaming)
+        [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED const TetrionKeyframe* keyframe_before(
+                SimulationStep simulation_step_index
+        ) const;
+
+        // false, if the recording has a state hash of the target tetrion at that step, that differs from its state
+        [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED bool matches_recorded_state_hash(SimulationStep simulation_step_index
+        ) const;
+
+        // continues the replay after the given (already simulated) step, with the given auto shift state
+        OOPETRIS_GRAPHICS_EXPORTED void seek(SimulationStep simulation_step_index, const HeldKeys& held_keys);
+
         [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED const Input* underlying_input() const override;
+
+    private:
+        void compare_snapshots(SimulationStep simulation_step_index);
+
+        void compare_state_hashes(SimulationStep simulation_step_index);
+
+        void compare_snapshot(const TetrionSnapshot& snapshot, SimulationStep simulation_step_index) const;
+
+        void compare_state_hash(const recorder::StateHash& state_hash, SimulationStep simulation_step_index);
+
+        // the next step with a record, a snapshot or a state hash of the target tetrion
+        [[nodiscard]] SimulationStep next_recorded_step() const;
+
+        // reads the next entry of the target tetrion from the stream, returns false after its last entry
+        bool read_pending_entry() const;
+
+        // reads, until every entry of the target tetrion up to (and including) the given step is pending
+        void read_pending_entries_until(SimulationStep simulation_step_index) const;
+
+        void update_streamed(SimulationStep simulation_step_index);
+
+        void late_update_streamed(SimulationStep simulation_step_index);
     };
 
 } // namespace input
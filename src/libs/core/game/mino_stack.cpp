@@ -1,78 +1,225 @@
 #include "./mino_stack.hpp"
 #include "./grid_properties.hpp"
+#include "./helper/hash.hpp"
 #include "./helper/magic_enum_wrapper.hpp"
 
 #include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace {
+    constexpr usize num_types = static_cast<usize>(helper::TetrominoType::LastType) + 1;
+
+    // one random key per cell and type
+    constexpr auto zobrist_keys = [] {
+        std::array<u64, MinoStack::width * MinoStack::height * num_types> result{};
+        for (usize i = 0; i < result.size(); ++i) {
+            result.at(i) = hash::mix(i);
+        }
+        return result;
+    }();
+
+    [[nodiscard]] u64 zobrist_key(const usize column, const usize row, const helper::TetrominoType type) {
+        return zobrist_keys.at(((row * MinoStack::width) + column) * num_types + static_cast<usize>(type));
+    }
+} // namespace
 
 void MinoStack::clear_row_and_let_sink(u8 row) {
-    m_minos.erase(
-            std::ranges::remove_if(m_minos, [&](const Mino& mino) { return mino.position().y == row; }).begin(),
-            m_minos.end()
-    );
-    for (Mino& mino : m_minos) {
-        if (mino.position().y < row) {
-            ++mino.position().y;
+    assert(row < height and "row out of bounds");
+
+    m_num_minos -= static_cast<u32>(std::popcount(m_occupancy.at(row)));
+
+    // every row above the cleared one sinks down by one
+    for (usize y = row; y > 0; --y) {
+        m_occupancy.at(y) = m_occupancy.at(y - 1);
+        m_types.at(y) = m_types.at(y - 1);
+    }
+    m_occupancy.front() = 0;
+    m_types.front() = 0;
+
+    refresh_columns(row);
+    refresh_hash();
+}
+
+u8 MinoStack::clear_full_rows(u8 first_row, u8 last_row) {
+    assert(first_row <= last_row and last_row < height and "row range out of bounds");
+
+    // rows below last_row are never moved, so the compaction starts there and walks upwards
+    usize write_row = last_row;
+    u8 num_cleared = 0;
+    for (usize read_row = last_row + 1; read_row-- > 0;) {
+        if (read_row >= first_row and is_row_full(static_cast<u8>(read_row))) {
+            m_num_minos -= static_cast<u32>(width);
+            ++num_cleared;
+            continue;
+        }
+
+        if (num_cleared > 0) {
+            m_occupancy.at(write_row) = m_occupancy.at(read_row);
+            m_types.at(write_row) = m_types.at(read_row);
         }
+        --write_row;
     }
+
+    for (usize y = 0; y < num_cleared; ++y) {
+        m_occupancy.at(y) = 0;
+        m_types.at(y) = 0;
+    }
+
+    if (num_cleared > 0) {
+        refresh_columns(last_row);
+        refresh_hash();
+    }
+
+    return num_cleared;
+}
+
+[[nodiscard]] bool MinoStack::is_row_full(u8 row) const {
+    return m_occupancy.at(row) == full_row_mask;
 }
 
 [[nodiscard]] bool MinoStack::is_empty(grid::GridPoint coordinates) const {
-    return not std::ranges::any_of(m_minos, [&coordinates](const Mino& mino) {
-        return mino.position() == coordinates;
-    });
+    if (not is_inside(coordinates)) {
+        return true;
+    }
+
+    const auto row = m_occupancy.at(static_cast<usize>(coordinates.y));
+    return (row & static_cast<RowMask>(RowMask{ 1 } << coordinates.x)) == 0;
 }
 
 void MinoStack::set(grid::GridPoint coordinates, helper::TetrominoType type) {
-    const Mino to_insert = Mino{ coordinates, type };
-    for (Mino& current : m_minos) {
-        if (current.position() == coordinates) {
-            current = to_insert;
-            return;
-        }
+    assert(is_inside(coordinates) and "mino out of bounds");
+
+    auto& occupancy = m_occupancy.at(static_cast<usize>(coordinates.y));
+    auto& types = m_types.at(static_cast<usize>(coordinates.y));
+
+    const auto column = static_cast<usize>(coordinates.x);
+    const auto row = static_cast<usize>(coordinates.y);
+
+    const auto column_bit = static_cast<RowMask>(RowMask{ 1 } << coordinates.x);
+    if ((occupancy & column_bit) == 0) {
+        occupancy |= column_bit;
+        m_columns.at(column) |= ColumnMask{ 1 } << coordinates.y;
+        ++m_num_minos;
+    } else {
+        m_hash ^= zobrist_key(column, row, type_at(static_cast<u8>(column), static_cast<u8>(row)));
     }
-    m_minos.push_back(to_insert);
+    m_hash ^= zobrist_key(column, row, type);
+
+    const auto shift = static_cast<u32>(coordinates.x) * bits_per_type;
+    types &= ~(type_mask << shift);
+    types |= (static_cast<PackedTypeRow>(type) & type_mask) << shift;
 }
 
 [[nodiscard]] u32 MinoStack::num_minos() const {
-    return static_cast<u32>(m_minos.size());
+    return m_num_minos;
 }
-[[nodiscard]] const std::vector<Mino>& MinoStack::minos() const {
-    return m_minos;
+
+[[nodiscard]] std::vector<Mino> MinoStack::minos() const {
+    std::vector<Mino> result{};
+    result.reserve(m_num_minos);
+
+    for (usize y = 0; y < height; ++y) {
+        auto occupancy = m_occupancy.at(y);
+        while (occupancy != 0) {
+            const auto x = static_cast<u8>(std::countr_zero(occupancy));
+            occupancy &= static_cast<RowMask>(occupancy - 1);
+            result.emplace_back(
+                    grid::GridPoint{ static_cast<grid::GridType>(x), static_cast<grid::GridType>(y) },
+                    type_at(x, static_cast<u8>(y))
+            );
+        }
+    }
+
+    return result;
 }
 
-[[nodiscard]] bool MinoStack::operator==(const MinoStack& other) const {
-    if (m_minos.size() != other.m_minos.size()) {
-        return false;
+[[nodiscard]] MinoStack::RowMask MinoStack::row_mask(u8 row) const {
+    return m_occupancy.at(row);
+}
+
+[[nodiscard]] u64 MinoStack::hash() const {
+    return m_hash;
+}
+
+[[nodiscard]] u8 MinoStack::column_height(u8 column) const {
+    const auto column_mask = m_columns.at(column);
+    if (column_mask == 0) {
+        return 0;
     }
 
-    const auto all_of_this_in_other = std::ranges::all_of(m_minos, [&](const auto& mino) {
-        return std::ranges::find(other.m_minos, mino) != end(other.m_minos);
-    });
+    return static_cast<u8>(height - static_cast<usize>(std::countr_zero(column_mask)));
+}
 
-    if (not all_of_this_in_other) {
-        return false;
+[[nodiscard]] u8 MinoStack::free_cells_below(grid::GridPoint coordinates) const {
+    assert(is_inside(coordinates) and "position out of bounds");
+
+    const auto below = m_columns.at(static_cast<usize>(coordinates.x)) >> (coordinates.y + 1);
+    if (below == 0) {
+        return static_cast<u8>(grid::height_in_tiles - 1 - coordinates.y);
     }
 
-    const auto all_of_other_in_this = std::ranges::all_of(other.m_minos, [this](const auto& mino) {
-        return std::ranges::find(m_minos, mino) != end(m_minos);
-    });
+    return static_cast<u8>(std::countr_zero(below));
+}
 
-    return all_of_other_in_this;
+[[nodiscard]] bool MinoStack::operator==(const MinoStack& other) const {
+    // the hash rejects almost all unequal stacks, the planes are only compared on a hash match
+    return m_hash == other.m_hash and m_num_minos == other.m_num_minos and m_occupancy == other.m_occupancy
+           and m_types == other.m_types;
 }
 
 [[nodiscard]] bool MinoStack::operator!=(const MinoStack& other) const {
     return not(*this == other);
 }
 
+[[nodiscard]] bool MinoStack::is_inside(grid::GridPoint coordinates) {
+    return coordinates.x >= 0 and coordinates.x < grid::width_in_tiles and coordinates.y >= 0
+           and coordinates.y < grid::height_in_tiles;
+}
+
+[[nodiscard]] helper::TetrominoType MinoStack::type_at(u8 column, u8 row) const {
+    const auto shift = static_cast<u32>(column) * bits_per_type;
+    return static_cast<helper::TetrominoType>((m_types.at(row) >> shift) & type_mask);
+}
+
+void MinoStack::refresh_columns(usize last_row) {
+    const auto rows_mask = static_cast<ColumnMask>((u64{ 1 } << (last_row + 1)) - 1);
+    for (auto& column : m_columns) {
+        column &= ~rows_mask;
+    }
+
+    for (usize y = 0; y <= last_row; ++y) {
+        auto occupancy = m_occupancy.at(y);
+        while (occupancy != 0) {
+            const auto x = static_cast<usize>(std::countr_zero(occupancy));
+            occupancy &= static_cast<RowMask>(occupancy - 1);
+            m_columns.at(x) |= ColumnMask{ 1 } << y;
+        }
+    }
+}
+
+void MinoStack::refresh_hash() {
+    m_hash = 0;
+    for (usize y = 0; y < height; ++y) {
+        auto occupancy = m_occupancy.at(y);
+        while (occupancy != 0) {
+            const auto x = static_cast<usize>(std::countr_zero(occupancy));
+            occupancy &= static_cast<RowMask>(occupancy - 1);
+            m_hash ^= zobrist_key(x, y, type_at(static_cast<u8>(x), static_cast<u8>(y)));
+        }
+    }
+}
+
 
 std::ostream& operator<<(std::ostream& ostream, const MinoStack& mino_stack) {
     ostream << "MinoStack(\n";
+    const auto minos = mino_stack.minos();
     for (i8 y = 0; y < grid::height_in_tiles; ++y) {
         for (i8 x = 0; x < grid::width_in_tiles; ++x) {
-            const auto find_iterator = std::ranges::find_if(mino_stack.minos(), [&](const auto& mino) {
+            const auto find_iterator = std::ranges::find_if(minos, [&](const auto& mino) {
                 return mino.position() == shapes::AbstractPoint<i8>{ x, y };
             });
-            const auto found = (find_iterator != mino_stack.minos().cend());
+            const auto found = (find_iterator != minos.cend());
             if (found) {
                 ostream << magic_enum::enum_name(find_iterator->type());
             } else {
@@ -2,30 +2,89 @@
 
 #include "../helper/export_symbols.hpp"
 #include "../helper/types.hpp"
+#include "./grid_properties.hpp"
 #include "./mino.hpp"
 
+#include <array>
 #include <vector>
 
 struct MinoStack final {
+public:
+    // one bit per column, bit 0 is the leftmost column
+    using RowMask = u16;
+    // one bit per row, bit 0 is the topmost row
+    using ColumnMask = u32;
+
+    static constexpr usize width = static_cast<usize>(grid::width_in_tiles);
+    static constexpr usize height = static_cast<usize>(grid::height_in_tiles);
+
+    static constexpr RowMask full_row_mask = static_cast<RowMask>((1U << width) - 1U);
+
 private:
     using ScreenCordsFunction = Mino::ScreenCordsFunction;
 
-    std::vector<Mino> m_minos;
+    // every cell stores its TetrominoType in 3 bits, so a whole row fits into 32 bits
+    using PackedTypeRow = u32;
+    static constexpr u32 bits_per_type = 3;
+    static constexpr PackedTypeRow type_mask = (PackedTypeRow{ 1 } << bits_per_type) - 1;
+
+    static_assert(width <= sizeof(RowMask) * 8, "a row has to fit into a RowMask");
+    static_assert(height <= sizeof(ColumnMask) * 8, "a column has to fit into a ColumnMask");
+    static_assert(width * bits_per_type <= sizeof(PackedTypeRow) * 8, "a row has to fit into a PackedTypeRow");
+    static_assert(static_cast<u32>(helper::TetrominoType::LastType) <= type_mask, "a type has to fit into 3 bits");
+
+    std::array<RowMask, height> m_occupancy{};
+    // invariant: the type bits of empty cells are always zero, so the planes can be compared directly
+    std::array<PackedTypeRow, height> m_types{};
+    // transposed occupancy plane, kept in sync with m_occupancy, used for the column heights and drop distances
+    std::array<ColumnMask, width> m_columns{};
+    u32 m_num_minos{ 0 };
+    // zobrist hash of all occupied cells and their types, kept in sync with the planes
+    u64 m_hash{ 0 };
 
 public:
     OOPETRIS_CORE_EXPORTED void clear_row_and_let_sink(u8 row);
 
+    // removes all fully occupied rows in the range [first_row, last_row] in a single compaction pass and lets the
+    // rows above sink down, returns the number of removed rows
+    OOPETRIS_CORE_EXPORTED u8 clear_full_rows(u8 first_row, u8 last_row);
+
+    [[nodiscard]] OOPETRIS_CORE_EXPORTED bool is_row_full(u8 row) const;
+
     [[nodiscard]] OOPETRIS_CORE_EXPORTED bool is_empty(grid::GridPoint coordinates) const;
 
     OOPETRIS_CORE_EXPORTED void set(grid::GridPoint coordinates, helper::TetrominoType type);
 
     [[nodiscard]] OOPETRIS_CORE_EXPORTED u32 num_minos() const;
 
-    [[nodiscard]] OOPETRIS_CORE_EXPORTED const std::vector<Mino>& minos() const;
+    // materializes all minos in row-major order
+    [[nodiscard]] OOPETRIS_CORE_EXPORTED std::vector<Mino> minos() const;
+
+    [[nodiscard]] OOPETRIS_CORE_EXPORTED RowMask row_mask(u8 row) const;
+
+    // equal stacks always have equal hashes, so this can be used for cheap inequality checks
+    [[nodiscard]] OOPETRIS_CORE_EXPORTED u64 hash() const;
+
+    // the height of the highest occupied cell in that column, measured from the floor (0 for an empty column)
+    [[nodiscard]] OOPETRIS_CORE_EXPORTED u8 column_height(u8 column) const;
+
+    // the number of empty cells directly below the given position, until either the floor or an occupied cell is hit
+    [[nodiscard]] OOPETRIS_CORE_EXPORTED u8 free_cells_below(grid::GridPoint coordinates) const;
 
     [[nodiscard]] OOPETRIS_CORE_EXPORTED bool operator==(const MinoStack& other) const;
 
     [[nodiscard]] OOPETRIS_CORE_EXPORTED bool operator!=(const MinoStack& other) const;
+
+private:
+    [[nodiscard]] static bool is_inside(grid::GridPoint coordinates);
+
+    [[nodiscard]] helper::TetrominoType type_at(u8 column, u8 row) const;
+
+    // rebuilds the column plane for the rows [0, last_row] from the occupancy plane
+    void refresh_columns(usize last_row);
+
+    // recomputes the hash from the planes, this is needed after rows have been moved
+    void refresh_hash();
 };
 
 OOPETRIS_CORE_EXPORTED std::ostream& operator<<(std::ostream& ostream, const MinoStack& mino_stack);
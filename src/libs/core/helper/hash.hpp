@@ -0,0 +1,19 @@
+#pragma once
+
+#include "./types.hpp"
+
+namespace hash {
+
+    // splitmix64 finalizer, used to generate well distributed constant keys and to mix state values
+    [[nodiscard]] constexpr u64 mix(u64 value) noexcept {
+        value += 0x9E3779B97F4A7C15ULL;
+        value = (value ^ (value >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27U)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31U);
+    }
+
+    [[nodiscard]] constexpr u64 combine(const u64 seed, const u64 value) noexcept {
+        return mix(seed ^ (value + 0x9E3779B97F4A7C15ULL + (seed << 6U) + (seed >> 2U)));
+    }
+
+} // namespace hash
@@ -1,26 +1,147 @@
 #include "./helper/random.hpp"
 
+#include <bit>
 #include <chrono>
+#include <limits>
+
+namespace {
+
+    // a few generators per thread, so that interleaved tetrions don't evict each other
+    struct CachedMersenneTwister {
+        Random::Seed seed{};
+        u64 position{ 0 };
+        std::mt19937_64 generator;
+        bool is_used{ false };
+    };
+
+    constexpr usize mersenne_twister_cache_size = 8;
+
+    thread_local std::array<CachedMersenneTwister, mersenne_twister_cache_size> mersenne_twister_cache{};
+    thread_local usize next_evicted_mersenne_twister = 0;
+
+    // returns the generator of that seed, after exactly `position` generated values
+    [[nodiscard]] CachedMersenneTwister& get_mersenne_twister(const Random::Seed seed, const u64 position) {
+        CachedMersenneTwister* behind = nullptr;
+        for (auto& entry : mersenne_twister_cache) {
+            if (not entry.is_used or entry.seed != seed or entry.position > position) {
+                continue;
+            }
+            if (entry.position == position) {
+                return entry;
+            }
+            if (behind == nullptr or entry.position > behind->position) {
+                behind = &entry;
+            }
+        }
+
+        if (behind == nullptr) {
+            // after restoring an older state the generator has to start from the beginning again
+            behind = &mersenne_twister_cache.at(next_evicted_mersenne_twister);
+            next_evicted_mersenne_twister = (next_evicted_mersenne_twister + 1) % mersenne_twister_cache.size();
+            behind->seed = seed;
+            behind->position = 0;
+            behind->generator.seed(seed);
+            behind->is_used = true;
+        }
+
+        behind->generator.discard(position - behind->position);
+        behind->position = position;
+        return *behind;
+    }
+
+    [[nodiscard]] u64 split_mix(u64& state) {
+        state += 0x9E3779B97F4A7C15ULL;
+        auto result = state;
+        result = (result ^ (result >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+        result = (result ^ (result >> 27U)) * 0x94D049BB133111EBULL;
+        return result ^ (result >> 31U);
+    }
+
+} // namespace
 
 Random::Random() : Random{ generate_seed() } { }
 
-Random::Random(const Seed seed) {
+Random::Random(const Seed seed, const RandomAlgorithm algorithm) : m_algorithm{ algorithm } {
     this->seed(seed);
 }
 
 double Random::random() {
-    return m_uniform_real_distribution(m_generator);
+    ++m_num_draws;
+
+    if (m_algorithm == RandomAlgorithm::MersenneTwister) {
+        auto distribution = std::uniform_real_distribution<double>{};
+        auto engine = mersenne_twister();
+        return distribution(engine);
+    }
+
+    // the upper 53 bits fill the whole mantissa
+    return static_cast<double>(next() >> 11U) * 0x1.0p-53;
 }
 
 Random::Seed Random::seed() const {
     return m_seed;
 }
 
+u64 Random::num_draws() const {
+    return m_num_draws;
+}
+
+RandomAlgorithm Random::algorithm() const {
+    return m_algorithm;
+}
+
 void Random::seed(Random::Seed seed) {
-    m_generator.seed(seed);
     m_seed = seed;
+    m_num_draws = 0;
+
+    if (m_algorithm == RandomAlgorithm::MersenneTwister) {
+        m_state = {};
+        return;
+    }
+
+    // splitmix64 is the recommended way to seed xoshiro, it never results in the forbidden all zero state
+    auto split_mix_state = seed;
+    for (auto& word : m_state) {
+        word = split_mix(split_mix_state);
+    }
 }
 
 Random::Seed Random::generate_seed() {
     return std::chrono::system_clock::now().time_since_epoch().count();
 }
+
+Random::MersenneTwisterEngine Random::mersenne_twister() {
+    auto& position = m_state.at(0);
+    auto& cached = get_mersenne_twister(m_seed, position);
+    // the cache entry and this Random advance together, so the next draw finds the entry again
+    return MersenneTwisterEngine{ .generator = &cached.generator,
+                                  .position = &position,
+                                  .cached_position = &cached.position };
+}
+
+u64 Random::next() {
+    // xoshiro256** 1.0, see https://prng.di.unimi.it/xoshiro256starstar.c
+    const auto result = std::rotl(m_state[1] * 5, 7) * 9;
+    const auto shifted = m_state[1] << 17U;
+
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+
+    m_state[2] ^= shifted;
+    m_state[3] = std::rotl(m_state[3], 45);
+
+    return result;
+}
+
+u64 Random::next_below(const u64 upper_bound_exclusive) {
+    // 2^64 % bound, the values below it would make the modulo biased towards small results
+    const auto threshold = (std::numeric_limits<u64>::max() - upper_bound_exclusive + 1) % upper_bound_exclusive;
+    while (true) {
+        const auto value = next();
+        if (value >= threshold) {
+            return value % upper_bound_exclusive;
+        }
+    }
+}
@@ -3,32 +3,92 @@
 #include "./export_symbols.hpp"
 #include "./utils.hpp"
 
+#include <array>
+#include <cassert>
+#include <concepts>
 #include <random>
 
+// the generator behind a Random, recordings store it, so that a replay draws the same numbers
+enum class RandomAlgorithm : u8 {
+    // std::mt19937_64 with the distributions of the standard library, so the numbers depend on the standard library
+    MersenneTwister = 0,
+    // xoshiro256** with a fixed algorithm for bounded numbers, so the numbers are the same on every platform
+    Xoshiro256 = 1,
+};
+
 struct Random {
 public:
-    using Seed = std::mt19937_64::result_type;
+    using Seed = u64;
+
+    static constexpr RandomAlgorithm default_algorithm = RandomAlgorithm::Xoshiro256;
 
 private:
-    std::mt19937_64 m_generator;
+    // hands out the numbers of a cached mersenne twister and counts them
+    struct MersenneTwisterEngine {
+        using result_type = std::mt19937_64::result_type; //NOLINT(readability-identifier-naming)
+
+        std::mt19937_64* generator;
+        u64* position;
+        u64* cached_position;
+
+        [[nodiscard]] static constexpr result_type min() {
+            return std::mt19937_64::min();
+        }
+
+        [[nodiscard]] static constexpr result_type max() {
+            return std::mt19937_64::max();
+        }
+
+        result_type operator()() {
+            ++*position;
+            ++*cached_position;
+            return (*generator)();
+        }
+    };
+
     Seed m_seed{};
-    std::uniform_real_distribution<double> m_uniform_real_distribution;
+    // number of values drawn since the last seeding, together with the seed this identifies the generator position
+    u64 m_num_draws{ 0 };
+    RandomAlgorithm m_algorithm;
+    // the xoshiro256** state, the mersenne twister only uses the first word for the number of generated values, its
+    // 2.5 KiB state lives in a per thread cache, so that copying a Random stays cheap with both algorithms
+    std::array<u64, 4> m_state{};
 
 public:
     OOPETRIS_CORE_EXPORTED Random();
-    OOPETRIS_CORE_EXPORTED explicit Random(std::mt19937_64::result_type seed);
+    OOPETRIS_CORE_EXPORTED explicit Random(Seed seed, RandomAlgorithm algorithm = default_algorithm);
 
     template<std::integral Integer>
     [[nodiscard]] Integer random(const Integer upper_bound_exclusive) {
-        auto distribution = std::uniform_int_distribution<Integer>{ 0, upper_bound_exclusive - 1 };
-        return distribution(m_generator);
+        assert(upper_bound_exclusive > 0);
+        ++m_num_draws;
+
+        if (m_algorithm == RandomAlgorithm::MersenneTwister) {
+            auto distribution = std::uniform_int_distribution<Integer>{ 0, upper_bound_exclusive - 1 };
+            auto engine = mersenne_twister();
+            return distribution(engine);
+        }
+
+        return static_cast<Integer>(next_below(static_cast<u64>(upper_bound_exclusive)));
     }
 
     [[nodiscard]] OOPETRIS_CORE_EXPORTED double random();
 
     [[nodiscard]] OOPETRIS_CORE_EXPORTED Seed seed() const;
 
+    [[nodiscard]] OOPETRIS_CORE_EXPORTED u64 num_draws() const;
+
+    [[nodiscard]] OOPETRIS_CORE_EXPORTED RandomAlgorithm algorithm() const;
+
     OOPETRIS_CORE_EXPORTED void seed(Seed seed);
 
     OOPETRIS_CORE_EXPORTED static Seed generate_seed();
+
+private:
+    [[nodiscard]] OOPETRIS_CORE_EXPORTED MersenneTwisterEngine mersenne_twister();
+
+    [[nodiscard]] OOPETRIS_CORE_EXPORTED u64 next();
+
+    // uniform in [0, upper_bound_exclusive), by rejecting the values that would make the modulo biased
+    [[nodiscard]] OOPETRIS_CORE_EXPORTED u64 next_below(u64 upper_bound_exclusive);
 };
@@ -6,11 +6,15 @@
 
 
 #include "./utility/additional_information.hpp"
+#include "./utility/block_codec.hpp"
 #include "./utility/checksum_helper.hpp"
 #include "./utility/helper.hpp"
+#include "./utility/mapped_file.hpp"
 #include "./utility/recording.hpp"
 #include "./utility/recording_json_wrapper.hpp"
 #include "./utility/recording_reader.hpp"
+#include "./utility/recording_stream.hpp"
 #include "./utility/recording_writer.hpp"
 #include "./utility/tetrion_core_information.hpp"
+#include "./utility/tetrion_keyframe.hpp"
 #include "./utility/tetrion_snapshot.hpp"
@@ -0,0 +1,176 @@
+#include "./block_codec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+// every sequence starts with a token, the upper four bits are the number of literals, the lower four bits the length
+// of the following match minus min_match_length, 15 means, that more length bytes follow, until one is below 255,
+// the literals follow, then the offset of the match as two little endian bytes, the last sequence has no match
+namespace {
+
+    constexpr usize min_match_length = 4;
+    constexpr usize max_offset = 0xFFFF;
+    constexpr u8 max_token_length = 0x0F;
+    constexpr usize hash_bits = 12;
+
+    [[nodiscard]] u32 load_u32(const std::span<const std::byte> input, const usize position) {
+        u32 result{};
+        std::memcpy(&result, input.data() + position, sizeof(result));
+        return result;
+    }
+
+    [[nodiscard]] usize hash_of(const u32 value) {
+        return static_cast<usize>((value * 2654435761U) >> (32U - hash_bits));
+    }
+
+    void append_length(std::vector<std::byte>& output, usize length) {
+        while (length >= 0xFF) {
+            output.push_back(std::byte{ 0xFF });
+            length -= 0xFF;
+        }
+        output.push_back(static_cast<std::byte>(length));
+    }
+
+    void append_sequence(
+            std::vector<std::byte>& output,
+            const std::span<const std::byte> literals,
+            const usize offset,
+            const usize match_length
+    ) {
+        const bool has_match = match_length >= min_match_length;
+        const usize extra_match_length = has_match ? match_length - min_match_length : 0;
+
+        const auto literal_token = static_cast<u8>(std::min<usize>(literals.size(), max_token_length));
+        const auto match_token = static_cast<u8>(std::min<usize>(extra_match_length, max_token_length));
+        output.push_back(static_cast<std::byte>((literal_token << 4U) | match_token));
+
+        if (literal_token == max_token_length) {
+            append_length(output, literals.size() - max_token_length);
+        }
+        output.insert(output.end(), literals.begin(), literals.end());
+
+        if (not has_match) {
+            return;
+        }
+
+        output.push_back(static_cast<std::byte>(offset & 0xFFU));
+        output.push_back(static_cast<std::byte>(offset >> 8U));
+        if (match_token == max_token_length) {
+            append_length(output, extra_match_length - max_token_length);
+        }
+    }
+
+    [[nodiscard]] bool read_length(const std::span<const std::byte> input, usize& position, usize& length) {
+        while (true) {
+            if (position >= input.size()) {
+                return false;
+            }
+            const auto value = static_cast<u8>(input[position++]);
+            length += value;
+            if (value != 0xFF) {
+                return true;
+            }
+        }
+    }
+
+} // namespace
+
+
+std::vector<std::byte> helper::block_codec::compress(const std::span<const std::byte> input) {
+    std::vector<std::byte> output{};
+    output.reserve(input.size() / 2 + 16);
+
+    // positions are stored plus one, so that zero means empty
+    std::array<u32, 1U << hash_bits> table{};
+
+    usize anchor = 0;
+    usize position = 0;
+    while (position + min_match_length <= input.size()) {
+        const auto value = load_u32(input, position);
+        auto& slot = table.at(hash_of(value));
+        const usize candidate = slot;
+        slot = static_cast<u32>(position + 1);
+
+        if (candidate == 0 or position - (candidate - 1) > max_offset or load_u32(input, candidate - 1) != value) {
+            ++position;
+            continue;
+        }
+
+        const usize match_start = candidate - 1;
+        usize match_length = min_match_length;
+        while (position + match_length < input.size()
+               and input[match_start + match_length] == input[position + match_length]) {
+            ++match_length;
+        }
+
+        append_sequence(output, input.subspan(anchor, position - anchor), position - match_start, match_length);
+        position += match_length;
+        anchor = position;
+    }
+
+    append_sequence(output, input.subspan(anchor), 0, 0);
+    return output;
+}
+
+helper::expected<void, std::string> helper::block_codec::decompress(
+        const std::span<const std::byte> input,
+        const usize uncompressed_size,
+        std::vector<std::byte>& output
+) {
+    output.clear();
+    output.reserve(uncompressed_size);
+
+    const auto corrupted = []() { return helper::unexpected<std::string>{ "corrupted compressed block" }; };
+
+    usize position = 0;
+    while (true) {
+        if (position >= input.size()) {
+            return corrupted();
+        }
+        const auto token = static_cast<u8>(input[position++]);
+
+        usize literal_length = token >> 4U;
+        if (literal_length == max_token_length and not read_length(input, position, literal_length)) {
+            return corrupted();
+        }
+        if (literal_length > input.size() - position or literal_length > uncompressed_size - output.size()) {
+            return corrupted();
+        }
+        output.insert(
+                output.end(), input.begin() + static_cast<std::ptrdiff_t>(position),
+                input.begin() + static_cast<std::ptrdiff_t>(position + literal_length)
+        );
+        position += literal_length;
+
+        // the last sequence only has literals
+        if (output.size() == uncompressed_size) {
+            if (position != input.size()) {
+                return corrupted();
+            }
+            return {};
+        }
+
+        if (input.size() - position < 2) {
+            return corrupted();
+        }
+        const usize offset = static_cast<usize>(input[position]) | (static_cast<usize>(input[position + 1]) << 8U);
+        position += 2;
+
+        usize match_length = token & max_token_length;
+        if (match_length == max_token_length and not read_length(input, position, match_length)) {
+            return corrupted();
+        }
+        match_length += min_match_length;
+
+        if (offset == 0 or offset > output.size() or match_length > uncompressed_size - output.size()) {
+            return corrupted();
+        }
+
+        // the match may overlap the bytes it produces, so it is copied one byte at a time
+        const usize match_start = output.size() - offset;
+        for (usize i = 0; i < match_length; ++i) {
+            output.push_back(output[match_start + i]);
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <core/helper/expected.hpp>
+#include <core/helper/types.hpp>
+
+#include "./export_symbols.hpp"
+
+#include <span>
+#include <string>
+#include <vector>
+
+// a small LZ77 codec in the style of LZ4, fast enough to compress every block of a recording while it's written
+namespace helper::block_codec {
+
+    // the compressed data doesn't contain its size, it has to be stored next to it
+    [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED std::vector<std::byte> compress(std::span<const std::byte> input);
+
+    // replaces the content of output, fails on corrupted data instead of reading or writing out of bounds
+    [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED helper::expected<void, std::string>
+    decompress(std::span<const std::byte> input, usize uncompressed_size, std::vector<std::byte>& output);
+
+} // namespace helper::block_codec
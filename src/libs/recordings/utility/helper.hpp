@@ -7,9 +7,13 @@
 #include <core/helper/types.hpp>
 #include <core/helper/utils.hpp>
 
+#include <cassert>
+#include <cstring>
 #include <filesystem>
 #include <fmt/format.h>
 #include <fstream>
+#include <optional>
+#include <span>
 #include <string>
 #include <utility>
 #include <vector>
@@ -30,7 +34,7 @@ namespace helper {
         using ReadResult = helper::expected<Result, ReadError>;
 
         template<std::integral Integral>
-        [[nodiscard]] ReadResult<std::remove_cv_t<Integral>> read_integral_from_file(std::ifstream& file) {
+        [[nodiscard]] ReadResult<std::remove_cv_t<Integral>> read_integral_from_file(std::istream& file) {
             if (not file) {
                 return helper::unexpected<ReadError>{
                     { ReadErrorType::InvalidStream, "failed to read data from file (before reading)" }
@@ -53,7 +57,7 @@ namespace helper {
         }
 
         template<typename Type, usize Size>
-        [[nodiscard]] ReadResult<std::array<Type, Size>> read_array_from_file(std::ifstream& file) {
+        [[nodiscard]] ReadResult<std::array<Type, Size>> read_array_from_file(std::istream& file) {
             if (not file) {
                 return helper::unexpected<ReadError>{
                     { ReadErrorType::InvalidStream, "failed to read data from file (before reading)" }
@@ -78,6 +82,33 @@ namespace helper {
             return result;
         }
 
+        // the bytes have to contain at least sizeof(Integral) bytes after the offset
+        template<std::integral Integral>
+        [[nodiscard]] Integral load_little_endian(const std::span<const std::byte> bytes, const usize offset) {
+            assert(offset + sizeof(Integral) <= bytes.size());
+
+            Integral little_endian_data{};
+            std::memcpy(&little_endian_data, bytes.subspan(offset).data(), sizeof(little_endian_data));
+            return utils::from_little_endian(little_endian_data);
+        }
+
+        // unsigned LEB128, returns the value and the number of bytes it used, if the bytes contain a complete one
+        [[nodiscard]] inline std::optional<std::pair<u64, usize>>
+        load_varint(const std::span<const std::byte> bytes, const usize offset) {
+            constexpr usize max_varint_size = 10;
+
+            u64 result = 0;
+            for (usize i = 0; i < max_varint_size and offset + i < bytes.size(); ++i) {
+                const auto byte = static_cast<u64>(bytes[offset + i]);
+                result |= (byte & 0x7FU) << (7U * i);
+                if ((byte & 0x80U) == 0) {
+                    return std::pair{ result, i + 1 };
+                }
+            }
+
+            return std::nullopt;
+        }
+
         template<std::integral Integral>
         [[nodiscard]] std::optional<Integral> read_from_istream(std::istream& istream) {
             if (not istream) {
@@ -161,12 +192,19 @@ namespace helper {
                     reinterpret_cast<const char*>( // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
                             &little_endian_value
                     );
-            const char* const end =
-                    start + sizeof(little_endian_value); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-            for (const char* pointer = start; pointer < end;
-                 ++pointer) { // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-                vector.push_back(*pointer);
+            vector.insert(
+                    vector.end(), start,
+                    start + sizeof(little_endian_value) // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            );
+        }
+
+        // unsigned LEB128, small values only take one byte
+        inline void append_varint(std::vector<char>& vector, u64 value) {
+            while (value >= 0x80U) {
+                vector.push_back(static_cast<char>((value & 0x7FU) | 0x80U));
+                value >>= 7U;
             }
+            vector.push_back(static_cast<char>(value));
         }
 
         template<typename T>
@@ -0,0 +1,163 @@
+#include "./mapped_file.hpp"
+
+#include <fmt/format.h>
+#include <fstream>
+#include <tuple>
+
+#if defined(_MSC_VER) || defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#define OOPETRIS_MAPPED_FILE_WINDOWS
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif !defined(__CONSOLE__)
+#define OOPETRIS_MAPPED_FILE_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+helper::expected<helper::MappedFile, std::string> helper::MappedFile::from_path(const std::filesystem::path& path) {
+    MappedFile result{};
+
+#if defined(OOPETRIS_MAPPED_FILE_WINDOWS)
+    HANDLE file = CreateFileW(
+            path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        return helper::unexpected<std::string>{ fmt::format("unable to open file \"{}\"", path.string()) };
+    }
+
+    LARGE_INTEGER size{};
+    if (not GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return helper::unexpected<std::string>{ fmt::format("unable to get the size of file \"{}\"", path.string()) };
+    }
+
+    if (size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        // the view keeps the file and the mapping alive on its own
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            return helper::unexpected<std::string>{ fmt::format("unable to map file \"{}\"", path.string()) };
+        }
+
+        const auto* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (data == nullptr) {
+            return helper::unexpected<std::string>{ fmt::format("unable to map file \"{}\"", path.string()) };
+        }
+
+        result.m_data = static_cast<const std::byte*>(data);
+        result.m_size = static_cast<usize>(size.QuadPart);
+        result.m_is_mapped = true;
+    } else {
+        CloseHandle(file);
+    }
+#elif defined(OOPETRIS_MAPPED_FILE_POSIX)
+    const int file = open(path.c_str(), O_RDONLY); // NOLINT(cppcoreguidelines-pro-type-vararg)
+    if (file < 0) {
+        return helper::unexpected<std::string>{ fmt::format("unable to open file \"{}\"", path.string()) };
+    }
+
+    struct stat file_stat { };
+    if (fstat(file, &file_stat) != 0) {
+        close(file);
+        return helper::unexpected<std::string>{ fmt::format("unable to get the size of file \"{}\"", path.string()) };
+    }
+
+    // mapping zero bytes is an error, an empty file is just an empty view
+    if (file_stat.st_size > 0) {
+        const auto size = static_cast<usize>(file_stat.st_size);
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+        // the mapping stays valid after closing the file
+        close(file);
+        if (data == MAP_FAILED) { // NOLINT(cppcoreguidelines-pro-type-cstyle-cast,performance-no-int-to-ptr)
+            return helper::unexpected<std::string>{ fmt::format("unable to map file \"{}\"", path.string()) };
+        }
+
+        // recordings are read from the start to the end
+        std::ignore = madvise(data, size, MADV_SEQUENTIAL);
+
+        result.m_data = static_cast<const std::byte*>(data);
+        result.m_size = size;
+        result.m_is_mapped = true;
+    } else {
+        close(file);
+    }
+#else
+    // without mmap the memory usage grows with the length of the recording, the readers only see a span of bytes
+    std::ifstream file{ path, std::ios::in | std::ios::binary | std::ios::ate };
+    if (not file) {
+        return helper::unexpected<std::string>{ fmt::format("unable to open file \"{}\"", path.string()) };
+    }
+
+    result.m_buffer.resize(static_cast<usize>(file.tellg()));
+    file.seekg(0);
+    file.read(
+            reinterpret_cast<char*>(result.m_buffer.data()), // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+            static_cast<std::streamsize>(result.m_buffer.size())
+    );
+    if (not file) {
+        return helper::unexpected<std::string>{ fmt::format("unable to read file \"{}\"", path.string()) };
+    }
+
+    result.m_data = result.m_buffer.data();
+    result.m_size = result.m_buffer.size();
+#endif
+
+    return result;
+}
+
+helper::MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data{ other.m_data },
+      m_size{ other.m_size },
+      m_is_mapped{ other.m_is_mapped },
+      m_buffer{ std::move(other.m_buffer) } {
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_is_mapped = false;
+}
+
+helper::MappedFile& helper::MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_is_mapped = other.m_is_mapped;
+        m_buffer = std::move(other.m_buffer);
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_is_mapped = false;
+    }
+    return *this;
+}
+
+helper::MappedFile::~MappedFile() {
+    unmap();
+}
+
+[[nodiscard]] std::span<const std::byte> helper::MappedFile::bytes() const {
+    return { m_data, m_size };
+}
+
+void helper::MappedFile::unmap() {
+    if (not m_is_mapped) {
+        return;
+    }
+
+#if defined(OOPETRIS_MAPPED_FILE_WINDOWS)
+    UnmapViewOfFile(m_data);
+#elif defined(OOPETRIS_MAPPED_FILE_POSIX)
+    munmap(const_cast<std::byte*>(m_data), m_size); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_is_mapped = false;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <core/helper/expected.hpp>
+#include <core/helper/types.hpp>
+
+#include "./export_symbols.hpp"
+
+#include <filesystem>
+#include <span>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace helper {
+
+    // read only view of a whole file, memory mapped where the platform supports it, otherwise read at once, so on
+    // those platforms (the consoles) streaming a recording still keeps the whole file in memory
+    struct MappedFile {
+    private:
+        const std::byte* m_data{ nullptr };
+        usize m_size{ 0 };
+        bool m_is_mapped{ false };
+        // only used, if the file can't be mapped
+        std::vector<std::byte> m_buffer;
+
+        MappedFile() = default;
+
+    public:
+        OOPETRIS_RECORDINGS_EXPORTED static helper::expected<MappedFile, std::string> from_path(
+                const std::filesystem::path& path
+        );
+
+        OOPETRIS_RECORDINGS_EXPORTED MappedFile(MappedFile&& other) noexcept;
+        OOPETRIS_RECORDINGS_EXPORTED MappedFile& operator=(MappedFile&& other) noexcept;
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        OOPETRIS_RECORDINGS_EXPORTED ~MappedFile();
+
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED std::span<const std::byte> bytes() const;
+
+    private:
+        void unmap();
+    };
+
+    // lets the readers of istreams decode bytes in memory, without copying them first
+    struct ByteStreamBuffer : public std::streambuf {
+        explicit ByteStreamBuffer(const std::span<const std::byte> bytes) {
+            // the get area is never written to, the streambuf interface just isn't const correct
+            auto* const begin = const_cast<char*>( // NOLINT(cppcoreguidelines-pro-type-const-cast)
+                    reinterpret_cast<const char*>(bytes.data()) // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+            );
+            setg(begin, begin, begin + bytes.size()); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+
+        // the number of bytes read so far
+        [[nodiscard]] usize position() const {
+            return static_cast<usize>(gptr() - eback());
+        }
+    };
+
+} // namespace helper
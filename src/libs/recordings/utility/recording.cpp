@@ -4,9 +4,14 @@
 #include <stdexcept>
 
 
-recorder::TetrionHeader::TetrionHeader(Random::Seed seed, u32 starting_level)
+recorder::TetrionHeader::TetrionHeader(
+        Random::Seed seed,
+        u32 starting_level,
+        RandomAlgorithm random_algorithm
+)
     : seed{ seed },
-      starting_level{ starting_level } { }
+      starting_level{ starting_level },
+      random_algorithm{ random_algorithm } { }
 
 
 [[nodiscard]] const std::vector<recorder::TetrionHeader>& recorder::Recording::tetrion_headers() const {
@@ -35,6 +40,10 @@ recorder::TetrionHeader::TetrionHeader(Random::Seed seed, u32 starting_level)
         sha256_creator << header.seed;
         static_assert(sizeof(decltype(header.starting_level)) == 4);
         sha256_creator << header.starting_level;
+        if (version_number >= 2) {
+            static_assert(sizeof(decltype(header.random_algorithm)) == 1);
+            sha256_creator << static_cast<u8>(header.random_algorithm);
+        }
     }
 
     const auto information_checksum = information.get_checksum();
@@ -4,6 +4,7 @@
 #include <core/helper/input_event.hpp>
 #include <core/helper/random.hpp>
 #include <core/helper/types.hpp>
+#include <core/helper/utils.hpp>
 
 #include "./additional_information.hpp"
 #include "./checksum_helper.hpp"
@@ -28,16 +29,85 @@ namespace recorder {
         InputEvent event;
     };
 
+    // a cheap checkpoint of the complete tetrion state, see SimulatedTetrion::state_hash
+    struct StateHash final {
+        u8 tetrion_index;
+        u64 simulation_step_index;
+        u64 hash;
+    };
+
     enum class MagicByte : u8 {
         Record = 42,
         Snapshot = 43,
+        Keyframe = 44,
+        StateHash = 45,
+        // since version 3, see compact_record
+        CompactRecord = 46,
+        // since version 4, see block
+        Block = 47,
+        BlockIndex = 48,
     };
 
+    // since version 4 the entries are written in blocks, each compressed on its own with helper::block_codec: the
+    // magic byte, the uncompressed and the compressed size (u32 each) and the compressed entries, compact records only
+    // refer to earlier records of the same block, so that every block can be decoded without the ones before it
+    // after the last block follows the index: the magic byte, the number of blocks (u32) and a BlockIndexEntry for
+    // each, the file ends with the offset of the index (u64) and the magic file bytes
+    namespace block {
+
+        constexpr u8 first_version_number = 4;
+
+        constexpr usize header_size = sizeof(MagicByte) + sizeof(u32) + sizeof(u32);
+        constexpr usize index_header_size = sizeof(MagicByte) + sizeof(u32);
+        constexpr usize index_entry_size = 3 * sizeof(u64);
+        constexpr usize trailer_size = sizeof(u64) + sizeof(constants::recording::magic_file_byte);
+
+        // more than any block the writer produces, so that corrupted sizes don't lead to huge allocations
+        constexpr usize max_uncompressed_size = 64 * 1024 * 1024;
+
+    } // namespace block
+
+    struct BlockIndexEntry final {
+        // of the magic byte of the block
+        u64 offset;
+        // the smallest and largest step of the entries in the block
+        u64 first_simulation_step;
+        u64 last_simulation_step;
+    };
+
+    // most records are stored in one byte for the tetrion index and the event (4 bits each) and the difference to the
+    // step of the previous record of the same tetrion as varint, only the others are stored as full Record
+    namespace compact_record {
+
+        constexpr u8 max_tetrion_index = 0x0F;
+
+        static_assert(utils::to_underlying(InputEvent::HoldReleased) <= 0x0F, "every event has to fit into 4 bits");
+
+        [[nodiscard]] constexpr u8 pack(const u8 tetrion_index, const InputEvent event) {
+            return static_cast<u8>((tetrion_index << 4U) | utils::to_underlying(event));
+        }
+
+        [[nodiscard]] constexpr u8 tetrion_index(const u8 packed) {
+            return static_cast<u8>(packed >> 4U);
+        }
+
+        [[nodiscard]] constexpr u8 event(const u8 packed) {
+            return static_cast<u8>(packed & 0x0FU);
+        }
+
+    } // namespace compact_record
+
     struct TetrionHeader final {
         Random::Seed seed;
         u32 starting_level;
+        // version 1 recordings have no such field, they always used the mersenne twister
+        RandomAlgorithm random_algorithm;
 
-        OOPETRIS_RECORDINGS_EXPORTED TetrionHeader(Random::Seed seed, u32 starting_level);
+        OOPETRIS_RECORDINGS_EXPORTED TetrionHeader(
+                Random::Seed seed,
+                u32 starting_level,
+                RandomAlgorithm random_algorithm = Random::default_algorithm
+        );
     };
 
     struct Recording {
@@ -50,7 +120,9 @@ namespace recorder {
               m_information{ std::move(information) } { }
 
     public:
-        constexpr const static u8 current_supported_version_number = 1;
+        constexpr const static u8 current_supported_version_number = 4;
+        // older versions can still be read and replayed
+        constexpr const static u8 oldest_supported_version_number = 1;
 
         Recording(const Recording&) = delete;
         Recording(Recording&&) = delete;
@@ -9,6 +9,7 @@
 #include "./additional_information.hpp"
 #include "./recording.hpp"
 #include "./recording_reader.hpp"
+#include "./tetrion_keyframe.hpp"
 #include "./tetrion_snapshot.hpp"
 
 namespace nlohmann {
@@ -65,8 +66,9 @@ namespace nlohmann {
 
         static void to_json(json& obj, const recorder::TetrionHeader& tetrion_header) {
             obj = nlohmann::json::object({
-                    {           "seed",           tetrion_header.seed },
-                    { "starting_level", tetrion_header.starting_level }
+                    {             "seed",                                    tetrion_header.seed },
+                    {   "starting_level",                          tetrion_header.starting_level },
+                    { "random_algorithm", magic_enum::enum_name(tetrion_header.random_algorithm) }
             });
         }
     };
@@ -102,6 +104,24 @@ namespace nlohmann {
     };
 
 
+    template<>
+    struct adl_serializer<recorder::StateHash> {
+        static recorder::StateHash from_json(const json& /* obj */) {
+            //TODO(Totto): Implement
+            throw std::runtime_error{ "NOT IMPLEMENTED" };
+        }
+
+        static void to_json(json& obj, const recorder::StateHash& state_hash) {
+
+            obj = nlohmann::json::object({
+                    {         "tetrion_index",         state_hash.tetrion_index },
+                    { "simulation_step_index", state_hash.simulation_step_index },
+                    {                  "hash",                  state_hash.hash }
+            });
+        }
+    };
+
+
     template<typename T>
     struct adl_serializer<shapes::AbstractPoint<T>> {
         static shapes::AbstractPoint<T> from_json(const json& /* obj */) {
@@ -172,6 +192,24 @@ namespace nlohmann {
     };
 
 
+    template<>
+    struct adl_serializer<TetrionKeyframe> {
+        static TetrionKeyframe from_json(const json& /* obj */) {
+            //TODO(Totto): Implement
+            throw std::runtime_error{ "NOT IMPLEMENTED" };
+        }
+
+        // the state is engine specific, so only its size is exported
+        static void to_json(json& obj, const TetrionKeyframe& keyframe) {
+            obj = nlohmann::json::object({
+                    {         "tetrion_index",         keyframe.tetrion_index() },
+                    { "simulation_step_index", keyframe.simulation_step_index() },
+                    {            "state_size",         keyframe.state().size() }
+            });
+        }
+    };
+
+
     template<>
     struct adl_serializer<recorder::RecordingReader> {
         static recorder::RecordingReader from_json(const json& /* obj */) {
@@ -199,12 +237,24 @@ namespace nlohmann {
                     snapshots_json, recording_reader.snapshots()
             );
 
+            json keyframes_json;
+            nlohmann::adl_serializer<std::vector<TetrionKeyframe>>::to_json(
+                    keyframes_json, recording_reader.keyframes()
+            );
+
+            json state_hashes_json;
+            nlohmann::adl_serializer<std::vector<recorder::StateHash>>::to_json(
+                    state_hashes_json, recording_reader.state_hashes()
+            );
+
             obj = nlohmann::json::object({
                     {         "version", recorder::Recording::current_supported_version_number },
                     {     "information",                                      information_json },
                     { "tetrion_headers",                                  tetrion_headers_json },
                     {         "records",                                          records_json },
                     {       "snapshots",                                        snapshots_json },
+                    {       "keyframes",                                        keyframes_json },
+                    {    "state_hashes",                                     state_hashes_json },
             });
         }
     };
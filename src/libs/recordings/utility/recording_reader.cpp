@@ -3,38 +3,78 @@
 
 #include "./additional_information.hpp"
 #include "./recording_reader.hpp"
+#include "./recording_stream.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <fmt/format.h>
 #include <fmt/ranges.h>
+#include <thread>
 #include <tuple>
+#include <variant>
+
+namespace {
+
+    template<typename Entry, typename Projection>
+    [[nodiscard]] usize next_index_after(
+            const std::vector<usize>& indices,
+            const std::vector<Entry>& entries,
+            const SimulationStep simulation_step_index,
+            Projection projection
+    ) {
+        const auto after = std::ranges::upper_bound(
+                indices, simulation_step_index, std::less{},
+                [&entries, &projection](const usize index) { return projection(entries.at(index)); }
+        );
+        return after == indices.end() ? entries.size() : *after;
+    }
+
+} // namespace
 
 recorder::RecordingReader::RecordingReader(
         std::vector<TetrionHeader>&& tetrion_headers,
         AdditionalInformation&& information,
         UnderlyingContainer&& records,
-        std::vector<TetrionSnapshot>&& snapshots
+        std::vector<TetrionSnapshot>&& snapshots,
+        std::vector<TetrionKeyframe>&& keyframes,
+        std::vector<StateHash>&& state_hashes
 )
     : Recording{ std::move(tetrion_headers), std::move(information) },
       m_records{ std::move(records) },
-      m_snapshots{ std::move(snapshots) } { }
+      m_snapshots{ std::move(snapshots) },
+      m_keyframes{ std::move(keyframes) },
+      m_state_hashes{ std::move(state_hashes) },
+      m_tetrion_entry_indices(m_tetrion_headers.size()) {
+
+    for (usize index = 0; index < m_records.size(); ++index) {
+        if (const auto tetrion_index = m_records.at(index).tetrion_index;
+            tetrion_index < m_tetrion_entry_indices.size()) {
+            m_tetrion_entry_indices.at(tetrion_index).records.push_back(index);
+        }
+    }
+    for (usize index = 0; index < m_snapshots.size(); ++index) {
+        if (const auto tetrion_index = m_snapshots.at(index).tetrion_index();
+            tetrion_index < m_tetrion_entry_indices.size()) {
+            m_tetrion_entry_indices.at(tetrion_index).snapshots.push_back(index);
+        }
+    }
+    for (usize index = 0; index < m_state_hashes.size(); ++index) {
+        if (const auto tetrion_index = m_state_hashes.at(index).tetrion_index;
+            tetrion_index < m_tetrion_entry_indices.size()) {
+            m_tetrion_entry_indices.at(tetrion_index).state_hashes.push_back(index);
+        }
+    }
+}
 
 
 recorder::RecordingReader::RecordingReader(RecordingReader&& old) noexcept
     : recorder::RecordingReader{ std::move(old.m_tetrion_headers), std::move(old.m_information),
-                                 std::move(old.m_records), std::move(old.m_snapshots) } { }
+                                 std::move(old.m_records), std::move(old.m_snapshots),
+                                 std::move(old.m_keyframes), std::move(old.m_state_hashes) } { }
 
 
-helper::expected<
-        std::tuple<std::ifstream, std::vector<recorder::TetrionHeader>, recorder::AdditionalInformation>,
-        std::string>
-recorder::RecordingReader::get_header_from_path(const std::filesystem::path& path) {
-
-    std::ifstream file{ path, std::ios::in | std::ios::binary };
-    if (not file) {
-        return helper::unexpected<std::string>{
-            fmt::format("unable to load recording from file \"{}\"", path.string())
-        };
-    }
+helper::expected<std::tuple<u8, std::vector<recorder::TetrionHeader>, recorder::AdditionalInformation>, std::string>
+recorder::RecordingReader::get_header_from_istream(std::istream& file) {
 
     const auto magic_bytes =
             helper::reader::read_integral_from_file<decltype(constants::recording::magic_file_byte)>(file);
@@ -51,9 +91,11 @@ recorder::RecordingReader::get_header_from_path(const std::filesystem::path& pat
     if (not version_number.has_value()) {
         return helper::unexpected<std::string>{ "unable to read recording version from recorded game" };
     }
-    if (version_number.value() != Recording::current_supported_version_number) {
+    if (version_number.value() < Recording::oldest_supported_version_number
+        or version_number.value() > Recording::current_supported_version_number) {
         return helper::unexpected<std::string>{ fmt::format(
-                "only supported version at the moment is {}, but got {}", Recording::current_supported_version_number,
+                "only supported versions at the moment are {} to {}, but got {}",
+                Recording::oldest_supported_version_number, Recording::current_supported_version_number,
                 version_number.value()
         ) };
     }
@@ -67,7 +109,7 @@ recorder::RecordingReader::get_header_from_path(const std::filesystem::path& pat
 
     tetrion_headers.reserve(num_tetrions.value());
     for (u8 i = 0; i < num_tetrions.value(); ++i) {
-        auto header = read_tetrion_header_from_file(file);
+        auto header = read_tetrion_header_from_file(file, version_number.value());
         if (not header.has_value()) {
             return helper::unexpected<std::string>{ "failed to read tetrion header from recorded game" };
         }
@@ -98,64 +140,94 @@ recorder::RecordingReader::get_header_from_path(const std::filesystem::path& pat
         ) };
     }
 
-    return std::make_tuple<std::ifstream, std::vector<TetrionHeader>, AdditionalInformation>(
-            std::move(file), std::move(tetrion_headers), std::move(information.value())
-    );
+    return std::tuple<u8, std::vector<TetrionHeader>, AdditionalInformation>{
+        version_number.value(), std::move(tetrion_headers), std::move(information.value())
+    };
 }
 
 helper::expected<recorder::RecordingReader, std::string> recorder::RecordingReader::from_path(
-        const std::filesystem::path& path
+        const std::filesystem::path& path,
+        const u32 num_threads
 ) {
 
-    auto header = get_header_from_path(path);
-    if (not header.has_value()) {
-        return helper::unexpected<std::string>{ header.error() };
+    auto stream = RecordingStream::from_path(path);
+    if (not stream.has_value()) {
+        return helper::unexpected<std::string>{ stream.error() };
     }
 
-
-    auto [file, tetrion_headers, information] = std::move(header.value());
-
-
     std::vector<Record> records{};
     std::vector<TetrionSnapshot> snapshots{};
-    //TODO(Totto): when using larger files and recordings, we should stream the data and discard used, to far away data, to not load everything into memory at once
+    std::vector<TetrionKeyframe> keyframes{};
+    std::vector<StateHash> state_hashes{};
+
+    const auto add_entry = [&](RecordingStream::Entry&& entry) {
+        std::visit(
+                helper::Overloaded{
+                        [&records](Record&& record) { records.push_back(record); },
+                        [&snapshots](TetrionSnapshot&& snapshot) { snapshots.push_back(std::move(snapshot)); },
+                        [&keyframes](TetrionKeyframe&& keyframe) { keyframes.push_back(std::move(keyframe)); },
+                        [&state_hashes](StateHash&& state_hash) { state_hashes.push_back(state_hash); },
+                },
+                std::move(entry)
+        );
+    };
 
-    while (true) {
+    // every block can be decoded on its own, the entries are still added in the order of the file
+    const auto& blocks = stream->block_index();
+    const auto num_workers =
+            std::min<usize>(num_threads == 0 ? std::max(1U, std::thread::hardware_concurrency()) : num_threads,
+                            blocks.size());
+    if (num_workers > 1) {
+        std::vector<helper::expected<std::vector<RecordingStream::Entry>, std::string>> decoded_blocks(blocks.size());
+
+        std::atomic<usize> next_index{ 0 };
+        const auto worker = [&stream, &blocks, &decoded_blocks, &next_index]() {
+            for (auto index = next_index.fetch_add(1); index < blocks.size(); index = next_index.fetch_add(1)) {
+                decoded_blocks.at(index) = stream->decode_block(blocks.at(index));
+            }
+        };
 
-        const auto magic_byte = helper::reader::read_integral_from_file<std::underlying_type_t<MagicByte>>(file);
-        if (not magic_byte.has_value()) {
-            // we have finished and it's not an error, if we detect an end here (due to the lazy nature of filestreams, the end is only detected after trying to read, and not earlier  after the whole record is read)
-            if (magic_byte.error().first == helper::reader::ReadErrorType::Incomplete) {
-                break;
+        {
+            std::vector<std::jthread> threads{};
+            threads.reserve(num_workers - 1);
+            for (usize i = 1; i < num_workers; ++i) {
+                threads.emplace_back(worker);
             }
-            return helper::unexpected<std::string>{ "unable to read magic byte" };
+            worker();
         }
 
-        if (magic_byte.value() == utils::to_underlying(MagicByte::Record)) {
-            const auto record = read_record_from_file(file);
-            if (not record.has_value()) {
-                return helper::unexpected<std::string>{ "invalid record while reading recorded game" };
+        for (auto& decoded_block : decoded_blocks) {
+            if (not decoded_block.has_value()) {
+                return helper::unexpected<std::string>{ decoded_block.error() };
             }
-            records.push_back(record.value());
-        } else if (magic_byte.value() == utils::to_underlying(MagicByte::Snapshot)) {
-            auto snapshot = TetrionSnapshot::from_istream(file);
-            if (not snapshot.has_value()) {
-                return helper::unexpected<std::string>{ "error while reading TetrionSnapshot" };
+            for (auto& entry : decoded_block.value()) {
+                add_entry(std::move(entry));
             }
-            snapshots.push_back(std::move(snapshot.value()));
-        } else {
-            return helper::unexpected<std::string>{
-                fmt::format("invalid magic byte: {}", static_cast<int>(magic_byte.value()))
-            };
         }
-
-        if (not file) {
-            break;
+    } else {
+        // forward only consumers should use the RecordingStream directly, this keeps everything for random access
+        while (auto entry = stream->next()) {
+            add_entry(std::move(entry.value()));
         }
     }
 
-    return RecordingReader{ std::move(tetrion_headers), std::move(information), std::move(records),
-                            std::move(snapshots) };
+    if (const auto& error = stream->error(); error.has_value()) {
+        return helper::unexpected<std::string>{ error.value() };
+    }
+
+    // the tetrions of a multiplayer game are not simulated in lockstep, so keyframes of different tetrions can be
+    // interleaved in any order
+    std::ranges::stable_sort(keyframes, [](const TetrionKeyframe& lhs, const TetrionKeyframe& rhs) {
+        return std::pair{ lhs.tetrion_index(), lhs.simulation_step_index() }
+               < std::pair{ rhs.tetrion_index(), rhs.simulation_step_index() };
+    });
+
+    return RecordingReader{ std::move(stream->m_tetrion_headers),
+                            std::move(stream->m_information),
+                            std::move(records),
+                            std::move(snapshots),
+                            std::move(keyframes),
+                            std::move(state_hashes) };
 }
 
 [[nodiscard]] const recorder::Record& recorder::RecordingReader::at(const usize index) const {
@@ -190,15 +262,103 @@ helper::expected<recorder::RecordingReader, std::string> recorder::RecordingRead
     return m_snapshots;
 }
 
+[[nodiscard]] const std::vector<TetrionKeyframe>& recorder::RecordingReader::keyframes() const {
+    return m_keyframes;
+}
+
+[[nodiscard]] const std::vector<recorder::StateHash>& recorder::RecordingReader::state_hashes() const {
+    return m_state_hashes;
+}
+
+[[nodiscard]] usize recorder::RecordingReader::next_record_index(
+        const u8 tetrion_index,
+        const SimulationStep simulation_step_index
+) const {
+    if (tetrion_index >= m_tetrion_entry_indices.size()) {
+        return m_records.size();
+    }
+    return next_index_after(
+            m_tetrion_entry_indices.at(tetrion_index).records, m_records, simulation_step_index,
+            [](const Record& record) { return record.simulation_step_index; }
+    );
+}
+
+[[nodiscard]] usize recorder::RecordingReader::next_snapshot_index(
+        const u8 tetrion_index,
+        const SimulationStep simulation_step_index
+) const {
+    if (tetrion_index >= m_tetrion_entry_indices.size()) {
+        return m_snapshots.size();
+    }
+    return next_index_after(
+            m_tetrion_entry_indices.at(tetrion_index).snapshots, m_snapshots, simulation_step_index,
+            [](const TetrionSnapshot& snapshot) { return SimulationStep{ snapshot.simulation_step_index() }; }
+    );
+}
+
+[[nodiscard]] usize recorder::RecordingReader::next_state_hash_index(
+        const u8 tetrion_index,
+        const SimulationStep simulation_step_index
+) const {
+    if (tetrion_index >= m_tetrion_entry_indices.size()) {
+        return m_state_hashes.size();
+    }
+    return next_index_after(
+            m_tetrion_entry_indices.at(tetrion_index).state_hashes, m_state_hashes, simulation_step_index,
+            [](const StateHash& state_hash) { return state_hash.simulation_step_index; }
+    );
+}
+
+[[nodiscard]] std::optional<SimulationStep> recorder::RecordingReader::last_record_step(const u8 tetrion_index
+) const {
+    if (tetrion_index >= m_tetrion_entry_indices.size()
+        or m_tetrion_entry_indices.at(tetrion_index).records.empty()) {
+        return std::nullopt;
+    }
+    return m_records.at(m_tetrion_entry_indices.at(tetrion_index).records.back()).simulation_step_index;
+}
+
+[[nodiscard]] const TetrionKeyframe* recorder::RecordingReader::keyframe_before(
+        const u8 tetrion_index,
+        const SimulationStep simulation_step_index
+) const {
+    // first keyframe that is after the given step (or belongs to a later tetrion)
+    const auto after = std::ranges::upper_bound(
+            m_keyframes, std::pair{ tetrion_index, simulation_step_index }, std::less{},
+            [](const TetrionKeyframe& keyframe) {
+                return std::pair{ keyframe.tetrion_index(), keyframe.simulation_step_index() };
+            }
+    );
+
+    if (after == m_keyframes.begin()) {
+        return nullptr;
+    }
+
+    const auto& keyframe = *std::prev(after);
+    if (keyframe.tetrion_index() != tetrion_index) {
+        return nullptr;
+    }
+
+    return &keyframe;
+}
+
 
 [[nodiscard]] helper::
         expected<std::pair<recorder::AdditionalInformation, std::vector<recorder::TetrionHeader>>, std::string>
         recorder::RecordingReader::is_header_valid(const std::filesystem::path& path) {
 
-    auto header = get_header_from_path(path);
+    std::ifstream file{ path, std::ios::in | std::ios::binary };
+    if (not file) {
+        return helper::unexpected<std::string>{
+            fmt::format("unable to load recording from file \"{}\"", path.string())
+        };
+    }
+
+    auto header = get_header_from_istream(file);
 
     if (header.has_value()) {
-        auto [_, headers, information] = std::move(header.value());
+        auto [version_number, headers, information] = std::move(header.value());
+        std::ignore = version_number;
         return std::make_pair<recorder::AdditionalInformation, std::vector<recorder::TetrionHeader>>(
                 std::move(information), std::move(headers)
         );
@@ -209,7 +369,7 @@ helper::expected<recorder::RecordingReader, std::string> recorder::RecordingRead
 
 
 [[nodiscard]] helper::reader::ReadResult<recorder::TetrionHeader>
-recorder::RecordingReader::read_tetrion_header_from_file(std::ifstream& file) {
+recorder::RecordingReader::read_tetrion_header_from_file(std::istream& file, const u8 version_number) {
     if (not file) {
         return helper::unexpected<helper::reader::ReadError>{
             { helper::reader::ReadErrorType::InvalidStream, "failed to read data from file" }
@@ -231,56 +391,25 @@ recorder::RecordingReader::read_tetrion_header_from_file(std::ifstream& file) {
         };
     }
 
-    return TetrionHeader{ seed.value(), starting_level.value() };
-}
-
-[[nodiscard]] helper::reader::ReadResult<recorder::Record> recorder::RecordingReader::read_record_from_file(
-        std::ifstream& file
-) {
-    if (not file) {
-        return helper::unexpected<helper::reader::ReadError>{
-            { helper::reader::ReadErrorType::InvalidStream, "invalid input file stream while trying to read record" }
-        };
-    }
-
-    const auto tetrion_index = helper::reader::read_integral_from_file<decltype(Record::tetrion_index)>(file);
-    if (not tetrion_index.has_value()) {
-        return helper::unexpected<helper::reader::ReadError>{
-            { helper::reader::ReadErrorType::EndOfFile, "the field 'tetrion_index' is missing" }
-        };
-    }
-
-    const auto simulation_step_index =
-            helper::reader::read_integral_from_file<decltype(Record::simulation_step_index)>(file);
-    if (not simulation_step_index.has_value()) {
-        return helper::unexpected<helper::reader::ReadError>{
-            { helper::reader::ReadErrorType::Incomplete, "the field 'simulation_step_index' is missing" }
-        };
+    if (version_number < 2) {
+        return TetrionHeader{ seed.value(), starting_level.value(), RandomAlgorithm::MersenneTwister };
     }
 
-    const auto event = helper::reader::read_integral_from_file<std::underlying_type_t<InputEvent>>(file);
-    if (not event.has_value()) {
+    const auto random_algorithm =
+            helper::reader::read_integral_from_file<std::underlying_type_t<RandomAlgorithm>>(file);
+    if (not random_algorithm.has_value()) {
         return helper::unexpected<helper::reader::ReadError>{
-            { helper::reader::ReadErrorType::Incomplete, "the field 'InputEvent' is missing" }
-        };
-    }
-    if (not file) {
-        return helper::unexpected<helper::reader::ReadError>{
-            { helper::reader::ReadErrorType::Incomplete, "failed to read data from file" }
+            { helper::reader::ReadErrorType::Incomplete, "field 'random_algorithm' has no value" }
         };
     }
 
-    const auto maybe_event = magic_enum::enum_cast<InputEvent>(event.value());
-    if (not maybe_event.has_value()) {
+    const auto maybe_random_algorithm = magic_enum::enum_cast<RandomAlgorithm>(random_algorithm.value());
+    if (not maybe_random_algorithm.has_value()) {
         return helper::unexpected<helper::reader::ReadError>{
             { helper::reader::ReadErrorType::Incomplete,
-             fmt::format("got invalid enum value for InputEvent: {}", event.value()) }
+             fmt::format("got invalid enum value for RandomAlgorithm: {}", random_algorithm.value()) }
         };
     }
 
-    return Record{
-        .tetrion_index = tetrion_index.value(),
-        .simulation_step_index = simulation_step_index.value(),
-        .event = maybe_event.value(),
-    };
+    return TetrionHeader{ seed.value(), starting_level.value(), maybe_random_algorithm.value() };
 }
@@ -5,31 +5,57 @@
 #include "./helper.hpp"
 
 #include "./recording.hpp"
+#include "./tetrion_keyframe.hpp"
 #include "./tetrion_snapshot.hpp"
 
 #include <filesystem>
+#include <optional>
+#include <tuple>
 
 namespace recorder {
 
+    struct RecordingStream;
+
     struct RecordingReader : public Recording {
     private:
+        // shares the reading of the header
+        friend struct RecordingStream;
+
         using UnderlyingContainer = std::vector<Record>;
 
         UnderlyingContainer m_records;
         std::vector<TetrionSnapshot> m_snapshots;
+        // sorted by tetrion index and simulation step
+        std::vector<TetrionKeyframe> m_keyframes;
+        std::vector<StateHash> m_state_hashes;
+
+        // the positions of the entries of one tetrion in m_records, m_snapshots and m_state_hashes, the entries of a
+        // tetrion are written in the order of their steps, so these are sorted by step as well
+        struct TetrionEntryIndices {
+            std::vector<usize> records;
+            std::vector<usize> snapshots;
+            std::vector<usize> state_hashes;
+        };
+
+        // one for every tetrion header, entries of other tetrions aren't in any of them
+        std::vector<TetrionEntryIndices> m_tetrion_entry_indices;
 
         explicit RecordingReader(
                 std::vector<TetrionHeader>&& tetrion_headers,
                 AdditionalInformation&& information,
                 UnderlyingContainer&& records,
-                std::vector<TetrionSnapshot>&& snapshots
+                std::vector<TetrionSnapshot>&& snapshots,
+                std::vector<TetrionKeyframe>&& keyframes,
+                std::vector<StateHash>&& state_hashes
         );
 
     public:
         OOPETRIS_RECORDINGS_EXPORTED RecordingReader(RecordingReader&& old) noexcept;
 
+        // the blocks of a recording (version 4 and newer) are decoded by num_threads threads, 0 uses every core
         OOPETRIS_RECORDINGS_EXPORTED static helper::expected<RecordingReader, std::string> from_path(
-                const std::filesystem::path& path
+                const std::filesystem::path& path,
+                u32 num_threads = 0
         );
 
         [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED const Record& at(usize index) const;
@@ -40,6 +66,29 @@ namespace recorder {
 
         [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED const std::vector<TetrionSnapshot>& snapshots() const;
 
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED const std::vector<TetrionKeyframe>& keyframes() const;
+
+        // the latest keyframe of that tetrion at or before the given step (binary search)
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED const TetrionKeyframe*
+        keyframe_before(u8 tetrion_index, SimulationStep simulation_step_index) const;
+
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED const std::vector<StateHash>& state_hashes() const;
+
+        // the position of the first record, snapshot or state hash of that tetrion after the given step, or the size of
+        // the container, if there is none (binary search)
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED usize
+        next_record_index(u8 tetrion_index, SimulationStep simulation_step_index) const;
+
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED usize
+        next_snapshot_index(u8 tetrion_index, SimulationStep simulation_step_index) const;
+
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED usize
+        next_state_hash_index(u8 tetrion_index, SimulationStep simulation_step_index) const;
+
+        // the step of the last record of that tetrion, if it has any
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED std::optional<SimulationStep> last_record_step(u8 tetrion_index
+        ) const;
+
         [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED static helper::
                 expected<std::pair<recorder::AdditionalInformation, std::vector<recorder::TetrionHeader>>, std::string>
                 is_header_valid(const std::filesystem::path& path);
@@ -62,16 +111,14 @@ namespace recorder {
         [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED const_iterator end() const;
 
     private:
-        [[nodiscard]] static helper::expected<
-                std::tuple<std::ifstream, std::vector<TetrionHeader>, recorder::AdditionalInformation>,
-                std::string>
-        get_header_from_path(const std::filesystem::path& path);
-
+        // reads and validates everything up to the first entry, returns the version number as well
+        [[nodiscard]] static helper::
+                expected<std::tuple<u8, std::vector<TetrionHeader>, recorder::AdditionalInformation>, std::string>
+                get_header_from_istream(std::istream& file);
 
-        [[nodiscard]] static helper::reader::ReadResult<TetrionHeader> read_tetrion_header_from_file(std::ifstream& file
-        );
 
-        [[nodiscard]] static helper::reader::ReadResult<Record> read_record_from_file(std::ifstream& file);
+        [[nodiscard]] static helper::reader::ReadResult<TetrionHeader>
+        read_tetrion_header_from_file(std::istream& file, u8 version_number);
     };
 
     STATIC_ASSERT_WITH_MESSAGE(utils::IsIterator<RecordingReader>::value, "RecordingReader has to be an iterator");
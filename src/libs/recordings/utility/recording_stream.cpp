@@ -0,0 +1,716 @@
+#include <core/helper/magic_enum_wrapper.hpp>
+
+#include "./block_codec.hpp"
+#include "./recording_reader.hpp"
+#include "./recording_stream.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <fmt/format.h>
+#include <ranges>
+#include <tuple>
+
+namespace {
+
+    void add_last_entry(std::optional<recorder::LastEntries>& last_entries, const SimulationStep simulation_step_index) {
+        if (not last_entries.has_value() or simulation_step_index > last_entries->simulation_step_index) {
+            last_entries = recorder::LastEntries{ .simulation_step_index = simulation_step_index, .num_entries = 1 };
+        } else if (simulation_step_index == last_entries->simulation_step_index) {
+            ++last_entries->num_entries;
+        }
+    }
+
+} // namespace
+
+recorder::RecordingStream::RecordingStream(
+        helper::MappedFile&& file,
+        const u8 version_number,
+        const usize position,
+        std::vector<TetrionHeader>&& tetrion_headers,
+        AdditionalInformation&& information
+)
+    : Recording{ std::move(tetrion_headers), std::move(information) },
+      m_file{ std::move(file) },
+      m_version_number{ version_number },
+      m_first_entry_position{ position },
+      m_decoder{ .bytes = {}, .position = 0, .previous_record_steps = std::vector<u64>(m_tetrion_headers.size(), 0) },
+      m_next_block_position{ position } {
+    if (m_version_number < block::first_version_number) {
+        m_decoder.bytes = m_file.bytes().subspan(position);
+    } else {
+        m_block_index = read_block_index(m_file.bytes(), position);
+    }
+}
+
+recorder::RecordingStream::RecordingStream(RecordingStream&& old) noexcept
+    : Recording{ std::move(old.m_tetrion_headers), std::move(old.m_information) },
+      m_file{ std::move(old.m_file) },
+      m_version_number{ old.m_version_number },
+      m_first_entry_position{ old.m_first_entry_position },
+      m_decoder{ std::move(old.m_decoder) },
+      m_next_block_position{ old.m_next_block_position },
+      m_block{ std::move(old.m_block) },
+      m_block_index{ std::move(old.m_block_index) },
+      m_next_entry{ std::move(old.m_next_entry) },
+      m_error{ std::move(old.m_error) },
+      m_is_finished{ old.m_is_finished } { }
+
+helper::expected<recorder::RecordingStream, std::string> recorder::RecordingStream::from_path(
+        const std::filesystem::path& path
+) {
+    auto file = helper::MappedFile::from_path(path);
+    if (not file.has_value()) {
+        return helper::unexpected<std::string>{
+            fmt::format("unable to load recording from file \"{}\"", path.string())
+        };
+    }
+
+    // the header has variable length fields, so it's read through a stream over the mapped bytes
+    auto buffer = helper::ByteStreamBuffer{ file->bytes() };
+    auto istream = std::istream{ &buffer };
+
+    auto header = RecordingReader::get_header_from_istream(istream);
+    if (not header.has_value()) {
+        return helper::unexpected<std::string>{ header.error() };
+    }
+
+    auto [version_number, tetrion_headers, information] = std::move(header.value());
+
+    return RecordingStream{ std::move(file.value()), version_number, buffer.position(), std::move(tetrion_headers),
+                            std::move(information) };
+}
+
+[[nodiscard]] const recorder::RecordingStream::Entry* recorder::RecordingStream::peek() {
+    if (m_next_entry.has_value()) {
+        return &m_next_entry.value();
+    }
+
+    if (m_is_finished) {
+        return nullptr;
+    }
+
+    auto entry = read_entry();
+    if (not entry.has_value()) {
+        m_error = std::move(entry.error());
+        m_is_finished = true;
+        return nullptr;
+    }
+
+    if (not entry->has_value()) {
+        m_is_finished = true;
+        return nullptr;
+    }
+
+    m_next_entry = std::move(entry->value());
+    return &m_next_entry.value();
+}
+
+[[nodiscard]] std::optional<recorder::RecordingStream::Entry> recorder::RecordingStream::next() {
+    if (peek() == nullptr) {
+        return std::nullopt;
+    }
+
+    auto result = std::move(m_next_entry);
+    m_next_entry = std::nullopt;
+    return result;
+}
+
+[[nodiscard]] const std::optional<std::string>& recorder::RecordingStream::error() const {
+    return m_error;
+}
+
+[[nodiscard]] const std::vector<recorder::BlockIndexEntry>& recorder::RecordingStream::block_index() const {
+    return m_block_index;
+}
+
+void recorder::RecordingStream::skip_to(const SimulationStep simulation_step_index) {
+    if (m_is_finished or m_block_index.empty()) {
+        return;
+    }
+
+    // every block before the first one, that reaches the step, can be skipped
+    const auto first_needed = std::ranges::find_if(m_block_index, [simulation_step_index](const auto& entry) {
+        return entry.last_simulation_step >= simulation_step_index;
+    });
+    const auto target_position =
+            first_needed == m_block_index.end() ? m_file.bytes().size() : static_cast<usize>(first_needed->offset);
+
+    // only ever skips forward, the current block might already be partially consumed
+    if (target_position < m_next_block_position) {
+        return;
+    }
+
+    m_next_block_position = target_position;
+    m_decoder.bytes = {};
+    m_decoder.position = 0;
+    m_next_entry = std::nullopt;
+}
+
+[[nodiscard]] helper::expected<std::vector<recorder::RecordingStream::Entry>, std::string>
+recorder::RecordingStream::decode_block(const BlockIndexEntry& block) const {
+    std::vector<std::byte> buffer{};
+    if (const auto result = load_block(static_cast<usize>(block.offset), buffer); not result.has_value()) {
+        return helper::unexpected<std::string>{ result.error() };
+    }
+
+    auto decoder = EntryDecoder{ .bytes = buffer,
+                                 .position = 0,
+                                 .previous_record_steps = std::vector<u64>(m_tetrion_headers.size(), 0) };
+
+    std::vector<Entry> entries{};
+    while (true) {
+        auto entry = decoder.next();
+        if (not entry.has_value()) {
+            return helper::unexpected<std::string>{ entry.error() };
+        }
+        if (not entry->has_value()) {
+            return entries;
+        }
+        entries.push_back(std::move(entry->value()));
+    }
+}
+
+[[nodiscard]] helper::expected<std::vector<recorder::TetrionEnd>, std::string>
+recorder::RecordingStream::tetrion_ends() const {
+    std::vector<TetrionEnd> result(m_tetrion_headers.size());
+
+    const auto add_entry = [&result](const Entry& entry) {
+        const auto tetrion_index = tetrion_index_of(entry);
+        if (tetrion_index >= result.size()) {
+            return;
+        }
+
+        auto& end = result.at(tetrion_index);
+        const auto simulation_step_index = simulation_step_index_of(entry);
+        add_last_entry(end.entries, simulation_step_index);
+        if (std::holds_alternative<Record>(entry)) {
+            add_last_entry(end.records, simulation_step_index);
+        }
+    };
+
+    const auto add_entries = [&add_entry](EntryDecoder& decoder) -> helper::expected<void, std::string> {
+        while (true) {
+            auto entry = decoder.next();
+            if (not entry.has_value()) {
+                return helper::unexpected<std::string>{ entry.error() };
+            }
+            if (not entry->has_value()) {
+                return {};
+            }
+            add_entry(entry->value());
+        }
+    };
+
+    if (not m_block_index.empty()) {
+        // a block, whose steps are all before the last record of every tetrion, can't change any of the ends
+        const auto is_needed = [&result](const BlockIndexEntry& block) {
+            return std::ranges::any_of(result, [&block](const TetrionEnd& end) {
+                return not end.records.has_value() or block.last_simulation_step >= end.records->simulation_step_index;
+            });
+        };
+
+        for (const auto& block : std::views::reverse(m_block_index)) {
+            if (not is_needed(block)) {
+                continue;
+            }
+
+            const auto entries = decode_block(block);
+            if (not entries.has_value()) {
+                return helper::unexpected<std::string>{ entries.error() };
+            }
+            std::ranges::for_each(entries.value(), add_entry);
+        }
+
+        return result;
+    }
+
+    const auto bytes = m_file.bytes();
+    auto decoder = EntryDecoder{ .bytes = {},
+                                 .position = 0,
+                                 .previous_record_steps = std::vector<u64>(m_tetrion_headers.size(), 0) };
+
+    if (m_version_number < block::first_version_number) {
+        decoder.bytes = bytes.subspan(m_first_entry_position);
+        if (const auto added = add_entries(decoder); not added.has_value()) {
+            return helper::unexpected<std::string>{ added.error() };
+        }
+        return result;
+    }
+
+    // without an index, the blocks can only be found one after another
+    std::vector<std::byte> buffer{};
+    auto position = m_first_entry_position;
+    while (position < bytes.size()
+           and helper::reader::load_little_endian<std::underlying_type_t<MagicByte>>(bytes, position)
+                       != utils::to_underlying(MagicByte::BlockIndex)) {
+        const auto next_position = load_block(position, buffer);
+        if (not next_position.has_value()) {
+            return helper::unexpected<std::string>{ next_position.error() };
+        }
+
+        decoder.bytes = buffer;
+        decoder.position = 0;
+        std::ranges::fill(decoder.previous_record_steps, 0);
+        if (const auto added = add_entries(decoder); not added.has_value()) {
+            return helper::unexpected<std::string>{ added.error() };
+        }
+
+        position = next_position.value();
+    }
+
+    return result;
+}
+
+[[nodiscard]] const recorder::RecordingStream::Entry& recorder::RecordingStream::Iterator::operator*() const {
+    const auto* entry = stream->peek();
+    assert(entry != nullptr and "the end can't be dereferenced");
+    return *entry;
+}
+
+recorder::RecordingStream::Iterator& recorder::RecordingStream::Iterator::operator++() {
+    std::ignore = stream->next();
+    return *this;
+}
+
+void recorder::RecordingStream::Iterator::operator++(int) {
+    ++*this;
+}
+
+[[nodiscard]] bool recorder::RecordingStream::Iterator::operator==(std::default_sentinel_t /*sentinel*/) const {
+    return stream->peek() == nullptr;
+}
+
+[[nodiscard]] recorder::RecordingStream::Iterator recorder::RecordingStream::begin() {
+    return Iterator{ .stream = this };
+}
+
+[[nodiscard]] std::default_sentinel_t recorder::RecordingStream::end() const {
+    return std::default_sentinel;
+}
+
+[[nodiscard]] helper::expected<std::optional<recorder::RecordingStream::Entry>, std::string>
+recorder::RecordingStream::read_entry() {
+    while (true) {
+        auto entry = m_decoder.next();
+        if (not entry.has_value() or entry->has_value() or m_version_number < block::first_version_number) {
+            return entry;
+        }
+
+        // the end of the last block is either the end of the file or the start of the index
+        const auto bytes = m_file.bytes();
+        if (m_next_block_position >= bytes.size()
+            or helper::reader::load_little_endian<std::underlying_type_t<MagicByte>>(bytes, m_next_block_position)
+                       == utils::to_underlying(MagicByte::BlockIndex)) {
+            return std::nullopt;
+        }
+
+        const auto next_block_position = load_block(m_next_block_position, m_block);
+        if (not next_block_position.has_value()) {
+            return helper::unexpected<std::string>{ next_block_position.error() };
+        }
+
+        m_next_block_position = next_block_position.value();
+        m_decoder.bytes = m_block;
+        m_decoder.position = 0;
+        std::ranges::fill(m_decoder.previous_record_steps, 0);
+    }
+}
+
+[[nodiscard]] helper::expected<usize, std::string>
+recorder::RecordingStream::load_block(const usize offset, std::vector<std::byte>& buffer) const {
+    const auto bytes = m_file.bytes();
+    if (offset > bytes.size() or bytes.size() - offset < block::header_size) {
+        return helper::unexpected<std::string>{ "invalid block while reading recorded game" };
+    }
+
+    using helper::reader::load_little_endian;
+
+    const auto magic_byte = load_little_endian<std::underlying_type_t<MagicByte>>(bytes, offset);
+    if (magic_byte != utils::to_underlying(MagicByte::Block)) {
+        return helper::unexpected<std::string>{ fmt::format("invalid magic byte: {}", static_cast<int>(magic_byte)) };
+    }
+
+    const auto uncompressed_size = load_little_endian<u32>(bytes, offset + sizeof(magic_byte));
+    const auto compressed_size = load_little_endian<u32>(bytes, offset + sizeof(magic_byte) + sizeof(u32));
+    if (uncompressed_size > block::max_uncompressed_size
+        or compressed_size > bytes.size() - offset - block::header_size) {
+        return helper::unexpected<std::string>{ "invalid block while reading recorded game" };
+    }
+
+    const auto decompressed = helper::block_codec::decompress(
+            bytes.subspan(offset + block::header_size, compressed_size), uncompressed_size, buffer
+    );
+    if (not decompressed.has_value()) {
+        return helper::unexpected<std::string>{ "invalid block while reading recorded game" };
+    }
+
+    return offset + block::header_size + compressed_size;
+}
+
+[[nodiscard]] std::vector<recorder::BlockIndexEntry> recorder::RecordingStream::read_block_index(
+        const std::span<const std::byte> bytes,
+        const usize first_block_position
+) {
+    if (bytes.size() < first_block_position + block::index_header_size + block::trailer_size) {
+        return {};
+    }
+
+    using helper::reader::load_little_endian;
+
+    const auto trailer_position = bytes.size() - block::trailer_size;
+    if (load_little_endian<u32>(bytes, trailer_position + sizeof(u64)) != constants::recording::magic_file_byte) {
+        return {};
+    }
+
+    const auto index_position = load_little_endian<u64>(bytes, trailer_position);
+    if (index_position < first_block_position or index_position > trailer_position - block::index_header_size) {
+        return {};
+    }
+
+    const auto offset = static_cast<usize>(index_position);
+    if (load_little_endian<std::underlying_type_t<MagicByte>>(bytes, offset)
+        != utils::to_underlying(MagicByte::BlockIndex)) {
+        return {};
+    }
+
+    const auto num_blocks = load_little_endian<u32>(bytes, offset + sizeof(MagicByte));
+    if (offset + block::index_header_size + (static_cast<u64>(num_blocks) * block::index_entry_size)
+        != trailer_position) {
+        return {};
+    }
+
+    // the blocks have to be exactly the bytes between the header and the index, otherwise skipping or decoding them
+    // in parallel would silently miss or misplace entries, so only the block headers are read to check that
+    std::vector<BlockIndexEntry> result{};
+    result.reserve(num_blocks);
+    u64 expected_offset = first_block_position;
+    for (usize i = 0; i < num_blocks; ++i) {
+        const auto entry_position = offset + block::index_header_size + (i * block::index_entry_size);
+        const auto entry = BlockIndexEntry{
+            .offset = load_little_endian<u64>(bytes, entry_position),
+            .first_simulation_step = load_little_endian<u64>(bytes, entry_position + sizeof(u64)),
+            .last_simulation_step = load_little_endian<u64>(bytes, entry_position + (2 * sizeof(u64))),
+        };
+
+        if (entry.offset != expected_offset or index_position - entry.offset < block::header_size
+            or load_little_endian<std::underlying_type_t<MagicByte>>(bytes, static_cast<usize>(entry.offset))
+                       != utils::to_underlying(MagicByte::Block)) {
+            return {};
+        }
+
+        const auto compressed_size = load_little_endian<u32>(
+                bytes, static_cast<usize>(entry.offset) + sizeof(MagicByte) + sizeof(u32)
+        );
+        expected_offset = entry.offset + block::header_size + compressed_size;
+        if (expected_offset > index_position) {
+            return {};
+        }
+
+        if (entry.first_simulation_step > entry.last_simulation_step) {
+            return {};
+        }
+
+        result.push_back(entry);
+    }
+
+    if (expected_offset != index_position) {
+        return {};
+    }
+
+    return result;
+}
+
+[[nodiscard]] helper::expected<std::optional<recorder::RecordingStream::Entry>, std::string>
+recorder::RecordingStream::EntryDecoder::next() {
+    if (position >= bytes.size()) {
+        return std::nullopt;
+    }
+
+    const auto magic_byte = helper::reader::load_little_endian<std::underlying_type_t<MagicByte>>(bytes, position);
+    const auto entry_bytes = bytes.subspan(position + sizeof(magic_byte));
+
+    if (magic_byte == utils::to_underlying(MagicByte::CompactRecord)) {
+        const auto record = decode_compact_record(entry_bytes);
+        if (not record.has_value()) {
+            return helper::unexpected<std::string>{ "invalid record while reading recorded game" };
+        }
+        const auto& [value, size] = record.value();
+        previous_record_steps.at(value.tetrion_index) = value.simulation_step_index;
+        position += sizeof(magic_byte) + size;
+        return Entry{ value };
+    }
+
+    if (magic_byte == utils::to_underlying(MagicByte::Record)) {
+        const auto record = decode_record(entry_bytes);
+        if (not record.has_value()) {
+            return helper::unexpected<std::string>{ "invalid record while reading recorded game" };
+        }
+        if (record->tetrion_index < previous_record_steps.size()) {
+            previous_record_steps.at(record->tetrion_index) = record->simulation_step_index;
+        }
+        position += sizeof(magic_byte) + record_size;
+        return Entry{ record.value() };
+    }
+
+    if (magic_byte == utils::to_underlying(MagicByte::StateHash)) {
+        const auto state_hash = decode_state_hash(entry_bytes);
+        if (not state_hash.has_value()) {
+            return helper::unexpected<std::string>{ "invalid state hash while reading recorded game" };
+        }
+        position += sizeof(magic_byte) + state_hash_size;
+        return Entry{ state_hash.value() };
+    }
+
+    // snapshots and keyframes have a variable length, so they are decoded by their stream readers
+    auto buffer = helper::ByteStreamBuffer{ entry_bytes };
+    auto istream = std::istream{ &buffer };
+
+    if (magic_byte == utils::to_underlying(MagicByte::Snapshot)) {
+        auto snapshot = TetrionSnapshot::from_istream(istream);
+        if (not snapshot.has_value()) {
+            return helper::unexpected<std::string>{ "error while reading TetrionSnapshot" };
+        }
+        position += sizeof(magic_byte) + buffer.position();
+        return Entry{ std::move(snapshot.value()) };
+    }
+
+    if (magic_byte == utils::to_underlying(MagicByte::Keyframe)) {
+        auto keyframe = TetrionKeyframe::from_istream(istream);
+        if (not keyframe.has_value()) {
+            return helper::unexpected<std::string>{ "error while reading TetrionKeyframe" };
+        }
+        position += sizeof(magic_byte) + buffer.position();
+        return Entry{ std::move(keyframe.value()) };
+    }
+
+    return helper::unexpected<std::string>{ fmt::format("invalid magic byte: {}", static_cast<int>(magic_byte)) };
+}
+
+[[nodiscard]] helper::expected<recorder::Record, std::string> recorder::RecordingStream::decode_record(
+        const std::span<const std::byte> bytes
+) {
+    if (bytes.size() < record_size) {
+        return helper::unexpected<std::string>{ "the record is incomplete" };
+    }
+
+    using helper::reader::load_little_endian;
+
+    const auto tetrion_index = load_little_endian<decltype(Record::tetrion_index)>(bytes, 0);
+    const auto simulation_step_index =
+            load_little_endian<decltype(Record::simulation_step_index)>(bytes, sizeof(tetrion_index));
+    const auto event = load_little_endian<std::underlying_type_t<InputEvent>>(
+            bytes, sizeof(tetrion_index) + sizeof(simulation_step_index)
+    );
+
+    const auto maybe_event = magic_enum::enum_cast<InputEvent>(event);
+    if (not maybe_event.has_value()) {
+        return helper::unexpected<std::string>{ fmt::format("got invalid enum value for InputEvent: {}", event) };
+    }
+
+    return Record{
+        .tetrion_index = tetrion_index,
+        .simulation_step_index = simulation_step_index,
+        .event = maybe_event.value(),
+    };
+}
+
+[[nodiscard]] helper::expected<std::pair<recorder::Record, usize>, std::string>
+recorder::RecordingStream::EntryDecoder::decode_compact_record(const std::span<const std::byte> entry_bytes) const {
+    if (entry_bytes.empty()) {
+        return helper::unexpected<std::string>{ "the record is incomplete" };
+    }
+
+    const auto packed = helper::reader::load_little_endian<u8>(entry_bytes, 0);
+
+    const auto tetrion_index = compact_record::tetrion_index(packed);
+    if (tetrion_index >= previous_record_steps.size()) {
+        return helper::unexpected<std::string>{ fmt::format("the record has an invalid tetrion index {}", tetrion_index)
+        };
+    }
+
+    const auto maybe_event = magic_enum::enum_cast<InputEvent>(compact_record::event(packed));
+    if (not maybe_event.has_value()) {
+        return helper::unexpected<std::string>{
+            fmt::format("got invalid enum value for InputEvent: {}", compact_record::event(packed))
+        };
+    }
+
+    const auto step_difference = helper::reader::load_varint(entry_bytes, sizeof(packed));
+    if (not step_difference.has_value()) {
+        return helper::unexpected<std::string>{ "the step of the record is incomplete" };
+    }
+
+    const auto [difference, difference_size] = step_difference.value();
+
+    const auto record = Record{
+        .tetrion_index = tetrion_index,
+        .simulation_step_index = previous_record_steps.at(tetrion_index) + difference,
+        .event = maybe_event.value(),
+    };
+
+    return std::pair{ record, sizeof(packed) + difference_size };
+}
+
+[[nodiscard]] helper::expected<recorder::StateHash, std::string> recorder::RecordingStream::decode_state_hash(
+        const std::span<const std::byte> bytes
+) {
+    if (bytes.size() < state_hash_size) {
+        return helper::unexpected<std::string>{ "the state hash is incomplete" };
+    }
+
+    using helper::reader::load_little_endian;
+
+    const auto tetrion_index = load_little_endian<decltype(StateHash::tetrion_index)>(bytes, 0);
+    const auto simulation_step_index =
+            load_little_endian<decltype(StateHash::simulation_step_index)>(bytes, sizeof(tetrion_index));
+    const auto hash = load_little_endian<decltype(StateHash::hash)>(
+            bytes, sizeof(tetrion_index) + sizeof(simulation_step_index)
+    );
+
+    return StateHash{
+        .tetrion_index = tetrion_index,
+        .simulation_step_index = simulation_step_index,
+        .hash = hash,
+    };
+}
+
+recorder::SharedRecordingStream::SharedRecordingStream(
+        RecordingStream&& stream,
+        std::vector<TetrionEnd>&& tetrion_ends
+)
+    : m_stream{ std::move(stream) } {
+    m_tetrions.reserve(tetrion_ends.size());
+    for (const auto& end : tetrion_ends) {
+        m_tetrions.push_back(TetrionEntries{ .end = end, .pending_entries = {} });
+    }
+}
+
+helper::expected<recorder::SharedRecordingStream, std::string> recorder::SharedRecordingStream::from_path(
+        const std::filesystem::path& path
+) {
+    auto stream = RecordingStream::from_path(path);
+    if (not stream.has_value()) {
+        return helper::unexpected<std::string>{ stream.error() };
+    }
+
+    auto tetrion_ends = stream->tetrion_ends();
+    if (not tetrion_ends.has_value()) {
+        return helper::unexpected<std::string>{ tetrion_ends.error() };
+    }
+
+    return SharedRecordingStream{ std::move(stream.value()), std::move(tetrion_ends.value()) };
+}
+
+[[nodiscard]] std::optional<recorder::RecordingStream::Entry> recorder::SharedRecordingStream::next(
+        const u8 tetrion_index
+) {
+    // the end of the tetrion is known, reading on would only move the entries of the others into their queues
+    if (not has_unread_entries(tetrion_index)) {
+        return std::nullopt;
+    }
+
+    auto& pending_entries = m_tetrions.at(tetrion_index).pending_entries;
+    if (not pending_entries.empty()) {
+        auto entry = std::move(pending_entries.front());
+        pending_entries.pop_front();
+        handed_out(entry);
+        return entry;
+    }
+
+    while (not m_error.has_value()) {
+        auto entry = m_stream.next();
+        if (not entry.has_value()) {
+            break;
+        }
+
+        const auto entry_tetrion_index = tetrion_index_of(entry.value());
+        if (entry_tetrion_index == tetrion_index) {
+            handed_out(entry.value());
+            return entry;
+        }
+
+        // nobody reads the entries of tetrions that aren't in the header
+        if (entry_tetrion_index >= m_tetrions.size()) {
+            continue;
+        }
+
+        auto& other_pending_entries = m_tetrions.at(entry_tetrion_index).pending_entries;
+        if (other_pending_entries.size() >= max_pending_entries) {
+            m_error = fmt::format(
+                    "tetrion {} is more than {} entries behind tetrion {}", entry_tetrion_index, max_pending_entries,
+                    tetrion_index
+            );
+            break;
+        }
+        other_pending_entries.push_back(std::move(entry.value()));
+    }
+
+    return std::nullopt;
+}
+
+[[nodiscard]] bool recorder::SharedRecordingStream::has_unread_records(const u8 tetrion_index) const {
+    if (tetrion_index >= m_tetrions.size()) {
+        return false;
+    }
+
+    const auto& tetrion = m_tetrions.at(tetrion_index);
+    return tetrion.end.records.has_value() and tetrion.num_last_records_read < tetrion.end.records->num_entries;
+}
+
+[[nodiscard]] const std::optional<std::string>& recorder::SharedRecordingStream::error() const {
+    if (m_error.has_value()) {
+        return m_error;
+    }
+    return m_stream.error();
+}
+
+[[nodiscard]] const std::vector<recorder::TetrionHeader>& recorder::SharedRecordingStream::tetrion_headers() const {
+    return m_stream.tetrion_headers();
+}
+
+[[nodiscard]] bool recorder::SharedRecordingStream::has_unread_entries(const u8 tetrion_index) const {
+    if (tetrion_index >= m_tetrions.size()) {
+        return false;
+    }
+
+    const auto& tetrion = m_tetrions.at(tetrion_index);
+    return tetrion.end.entries.has_value() and tetrion.num_last_entries_read < tetrion.end.entries->num_entries;
+}
+
+void recorder::SharedRecordingStream::handed_out(const RecordingStream::Entry& entry) {
+    auto& tetrion = m_tetrions.at(tetrion_index_of(entry));
+    const auto simulation_step_index = simulation_step_index_of(entry);
+
+    if (tetrion.end.entries.has_value() and simulation_step_index == tetrion.end.entries->simulation_step_index) {
+        ++tetrion.num_last_entries_read;
+    }
+
+    if (std::holds_alternative<Record>(entry) and tetrion.end.records.has_value()
+        and simulation_step_index == tetrion.end.records->simulation_step_index) {
+        ++tetrion.num_last_records_read;
+    }
+}
+
+[[nodiscard]] u8 recorder::tetrion_index_of(const RecordingStream::Entry& entry) {
+    return std::visit(
+            helper::Overloaded{
+                    [](const Record& record) { return record.tetrion_index; },
+                    [](const TetrionSnapshot& snapshot) { return snapshot.tetrion_index(); },
+                    [](const TetrionKeyframe& keyframe) { return keyframe.tetrion_index(); },
+                    [](const StateHash& state_hash) { return state_hash.tetrion_index; },
+            },
+            entry
+    );
+}
+
+[[nodiscard]] SimulationStep recorder::simulation_step_index_of(const RecordingStream::Entry& entry) {
+    return std::visit(
+            helper::Overloaded{
+                    [](const Record& record) { return record.simulation_step_index; },
+                    [](const TetrionSnapshot& snapshot) { return SimulationStep{ snapshot.simulation_step_index() }; },
+                    [](const TetrionKeyframe& keyframe) { return keyframe.simulation_step_index(); },
+                    [](const StateHash& state_hash) { return state_hash.simulation_step_index; },
+            },
+            entry
+    );
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include "./export_symbols.hpp"
+
+#include "./helper.hpp"
+#include "./mapped_file.hpp"
+
+#include "./recording.hpp"
+#include "./tetrion_keyframe.hpp"
+#include "./tetrion_snapshot.hpp"
+
+#include <deque>
+#include <filesystem>
+#include <iterator>
+#include <optional>
+#include <variant>
+
+namespace recorder {
+
+    // the last step, at which a tetrion has entries, and how many it has there
+    struct LastEntries {
+        SimulationStep simulation_step_index;
+        usize num_entries;
+    };
+
+    // where the entries of a tetrion end, std::nullopt if it has none
+    struct TetrionEnd {
+        std::optional<LastEntries> entries;
+        // the same, but only counting the records
+        std::optional<LastEntries> records;
+    };
+
+    // reads the entries of a recording one after another, straight out of the memory mapped file (one decompressed
+    // block at a time), so the memory usage and the time until the first entry don't depend on the length of the
+    // recording
+    struct RecordingStream : public Recording {
+    public:
+        using Entry = std::variant<Record, TetrionSnapshot, TetrionKeyframe, StateHash>;
+
+    private:
+        // the encoded sizes of the fixed size entries, without the magic byte
+        static constexpr usize record_size = sizeof(Record::tetrion_index) + sizeof(Record::simulation_step_index)
+                                             + sizeof(std::underlying_type_t<InputEvent>);
+        static constexpr usize state_hash_size = sizeof(StateHash::tetrion_index)
+                                                 + sizeof(StateHash::simulation_step_index) + sizeof(StateHash::hash);
+
+        // decodes the entries of a contiguous range of bytes, that is the rest of the file before version 4, afterwards
+        // a single decompressed block
+        struct EntryDecoder {
+            std::span<const std::byte> bytes;
+            usize position{ 0 };
+            // compact records only store the difference to the previous record of the tetrion
+            std::vector<u64> previous_record_steps;
+
+            [[nodiscard]] helper::expected<std::optional<Entry>, std::string> next();
+
+            // returns the record and its encoded size
+            [[nodiscard]] helper::expected<std::pair<Record, usize>, std::string> decode_compact_record(
+                    std::span<const std::byte> entry_bytes
+            ) const;
+        };
+
+        // takes over the header, after reading all entries
+        friend struct RecordingReader;
+
+        helper::MappedFile m_file;
+        u8 m_version_number;
+        // offset of the first entry (or the first block since version 4)
+        usize m_first_entry_position;
+        EntryDecoder m_decoder;
+        // offset of the block after the one in m_block, only used since version 4
+        usize m_next_block_position;
+        std::vector<std::byte> m_block;
+        // empty, if the writer didn't finish the file, the blocks can still be read one after another then
+        std::vector<BlockIndexEntry> m_block_index;
+        // read by peek, but not consumed yet
+        std::optional<Entry> m_next_entry;
+        std::optional<std::string> m_error;
+        bool m_is_finished{ false };
+
+        explicit RecordingStream(
+                helper::MappedFile&& file,
+                u8 version_number,
+                usize position,
+                std::vector<TetrionHeader>&& tetrion_headers,
+                AdditionalInformation&& information
+        );
+
+    public:
+        OOPETRIS_RECORDINGS_EXPORTED RecordingStream(RecordingStream&& old) noexcept;
+
+        // only reads and validates the header, the entries are read on demand
+        OOPETRIS_RECORDINGS_EXPORTED static helper::expected<RecordingStream, std::string> from_path(
+                const std::filesystem::path& path
+        );
+
+        // the next entry without consuming it, nullptr at the end of the recording or after an error
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED const Entry* peek();
+
+        // consumes the next entry, std::nullopt at the end of the recording or after an error
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED std::optional<Entry> next();
+
+        // set, if the stream stopped at an invalid entry instead of the end of the file
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED const std::optional<std::string>& error() const;
+
+        // empty for recordings without blocks or without an index
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED const std::vector<BlockIndexEntry>& block_index() const;
+
+        // skips every block, that only has entries before the given step, only whole blocks are skipped, so some of the
+        // following entries may still be before that step, does nothing without an index
+        OOPETRIS_RECORDINGS_EXPORTED void skip_to(SimulationStep simulation_step_index);
+
+        // independent of the position of the stream, so different blocks can be decoded by different threads
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED helper::expected<std::vector<Entry>, std::string> decode_block(
+                const BlockIndexEntry& block
+        ) const;
+
+        // independent of the position of the stream, with an index only the blocks at the end of the file are decoded,
+        // otherwise all of them, but never more than one block is kept at a time
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED helper::expected<std::vector<TetrionEnd>, std::string>
+        tetrion_ends() const;
+
+        // a single pass over the remaining entries, that consumes them
+        struct Iterator {
+            using difference_type = std::ptrdiff_t; //NOLINT(readability-identifier-naming)
+            using value_type = Entry;               //NOLINT(readability-identifier-naming)
+
+            RecordingStream* stream;
+
+            [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED const Entry& operator*() const;
+
+            OOPETRIS_RECORDINGS_EXPORTED Iterator& operator++();
+
+            OOPETRIS_RECORDINGS_EXPORTED void operator++(int);
+
+            [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED bool operator==(std::default_sentinel_t /*sentinel*/) const;
+        };
+
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED Iterator begin();
+
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED std::default_sentinel_t end() const;
+
+    private:
+        [[nodiscard]] helper::expected<std::optional<Entry>, std::string> read_entry();
+
+        // decompresses the block at that offset, returns the offset after it
+        [[nodiscard]] helper::expected<usize, std::string> load_block(usize offset, std::vector<std::byte>& buffer
+        ) const;
+
+        // an index that doesn't fit to the file is ignored, as if the writer didn't finish it
+        [[nodiscard]] static std::vector<BlockIndexEntry> read_block_index(
+                std::span<const std::byte> bytes,
+                usize first_block_position
+        );
+
+        // the fixed size entries are decoded straight from the bytes, the bytes start after the magic byte
+        [[nodiscard]] static helper::expected<Record, std::string> decode_record(std::span<const std::byte> bytes);
+
+        [[nodiscard]] static helper::expected<StateHash, std::string> decode_state_hash(std::span<const std::byte> bytes
+        );
+    };
+
+    static_assert(std::input_iterator<RecordingStream::Iterator>);
+
+    // reads a recording once for all of its tetrions and hands every reader only the entries of its tetrion, the
+    // entries of the other tetrions are kept until their reader asks for them, so the readers should advance together,
+    // it isn't thread safe
+    struct SharedRecordingStream {
+    private:
+        // more pending entries than this only happen, if a reader stopped reading long before the end of its tetrion
+        static constexpr usize max_pending_entries = 1U << 16U;
+
+        struct TetrionEntries {
+            TetrionEnd end;
+            std::deque<RecordingStream::Entry> pending_entries;
+            // the entries (and records) at the last step of the tetrion, that were already handed out
+            usize num_last_entries_read{ 0 };
+            usize num_last_records_read{ 0 };
+        };
+
+        RecordingStream m_stream;
+        // indexed by tetrion
+        std::vector<TetrionEntries> m_tetrions;
+        std::optional<std::string> m_error;
+
+        SharedRecordingStream(RecordingStream&& stream, std::vector<TetrionEnd>&& tetrion_ends);
+
+    public:
+        // knows where the entries of every tetrion end before reading any of them, so a reader never has to read ahead
+        // to find out, that its tetrion has no more entries
+        OOPETRIS_RECORDINGS_EXPORTED static helper::expected<SharedRecordingStream, std::string> from_path(
+                const std::filesystem::path& path
+        );
+
+        // consumes the next entry of the tetrion, std::nullopt at the end of its entries or after an error
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED std::optional<RecordingStream::Entry> next(u8 tetrion_index);
+
+        // false, once the last record of the tetrion was handed out, without reading any further
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED bool has_unread_records(u8 tetrion_index) const;
+
+        // set, if the stream stopped at an invalid entry instead of the end of the file
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED const std::optional<std::string>& error() const;
+
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED const std::vector<TetrionHeader>& tetrion_headers() const;
+
+    private:
+        [[nodiscard]] bool has_unread_entries(u8 tetrion_index) const;
+
+        // counts the entry, if it's at the last step of its tetrion
+        void handed_out(const RecordingStream::Entry& entry);
+    };
+
+    // the tetrion and step every entry has
+    [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED u8 tetrion_index_of(const RecordingStream::Entry& entry);
+
+    [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED SimulationStep simulation_step_index_of(
+            const RecordingStream::Entry& entry
+    );
+
+} // namespace recorder
@@ -1,89 +1,346 @@
 #include "./recording_writer.hpp"
+#include "./block_codec.hpp"
 #include "./recording.hpp"
+#include "./tetrion_keyframe.hpp"
 #include "./tetrion_snapshot.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
+#if defined(_MSC_VER) || defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#define OOPETRIS_RECORDING_WRITER_WINDOWS
+#include <io.h>
+#elif !defined(__CONSOLE__)
+#include <unistd.h>
+#endif
+
+namespace {
+
+    [[nodiscard]] std::FILE* open_file(const std::filesystem::path& path) {
+#if defined(OOPETRIS_RECORDING_WRITER_WINDOWS)
+        std::FILE* file = nullptr;
+        if (_wfopen_s(&file, path.c_str(), L"wb") != 0) {
+            return nullptr;
+        }
+        return file;
+#else
+        return std::fopen(path.c_str(), "wb"); // NOLINT(cppcoreguidelines-owning-memory)
+#endif
+    }
+
+    // fflush only hands the data to the operating system, this waits until it's on the storage device
+    [[nodiscard]] bool sync_to_storage(std::FILE* file) {
+#if defined(OOPETRIS_RECORDING_WRITER_WINDOWS)
+        return _commit(_fileno(file)) == 0;
+#elif defined(__CONSOLE__)
+        std::ignore = file;
+        return true;
+#else
+        return fsync(fileno(file)) == 0;
+#endif
+    }
+
+} // namespace
+
+struct recorder::RecordingWriter::Output {
+private:
+    // written blocks are kept for reuse, so that appending doesn't allocate once the writer is running
+    static constexpr usize max_free_blocks = 4;
+
+    struct PendingBlock {
+        std::vector<char> bytes;
+        u64 first_simulation_step;
+        u64 last_simulation_step;
+    };
+
+    std::FILE* m_file;
+    std::optional<std::chrono::milliseconds> m_sync_interval;
+    // only used by the thread, until it's joined
+    u64 m_file_size;
+    std::vector<BlockIndexEntry> m_block_index;
+
+    std::mutex m_mutex;
+    std::condition_variable m_work_available;
+    std::condition_variable m_work_done;
+    std::vector<PendingBlock> m_pending_blocks;
+    std::vector<std::vector<char>> m_free_blocks;
+    u64 m_num_submitted{ 0 };
+    u64 m_num_written{ 0 };
+    u64 m_num_sync_requests{ 0 };
+    u64 m_num_syncs{ 0 };
+    bool m_is_stopping{ false };
+    std::optional<std::string> m_error;
+    // set together with m_error, so that adding entries doesn't need the lock to check for it
+    std::atomic<bool> m_has_error{ false };
+
+    // started last, after everything it uses is initialized
+    std::thread m_thread;
+
+public:
+    Output(std::FILE* file, const std::optional<std::chrono::milliseconds> sync_interval, const u64 header_size)
+        : m_file{ file },
+          m_sync_interval{ sync_interval },
+          m_file_size{ header_size },
+          m_thread{ [this]() { run(); } } { }
+
+    Output(const Output&) = delete;
+    Output(Output&&) = delete;
+    Output& operator=(const Output&) = delete;
+    Output& operator=(Output&&) = delete;
+
+    // writes everything that is still pending and the index, before closing the file
+    ~Output() {
+        {
+            const std::lock_guard lock{ m_mutex };
+            m_is_stopping = true;
+        }
+        m_work_available.notify_one();
+        m_thread.join();
+
+        std::vector<char> index{};
+        index.reserve(
+                block::index_header_size + (m_block_index.size() * block::index_entry_size) + block::trailer_size
+        );
+
+        static_assert(sizeof(std::underlying_type_t<MagicByte>) == 1);
+        helper::writer::append_value(index, utils::to_underlying(MagicByte::BlockIndex));
+        helper::writer::append_value(index, static_cast<u32>(m_block_index.size()));
+        for (const auto& entry : m_block_index) {
+            helper::writer::append_value(index, entry.offset);
+            helper::writer::append_value(index, entry.first_simulation_step);
+            helper::writer::append_value(index, entry.last_simulation_step);
+        }
+
+        helper::writer::append_value(index, m_file_size);
+        helper::writer::append_value(index, constants::recording::magic_file_byte);
+
+        // without the index the blocks can still be read one after another, an index after a failed write could
+        // point to the wrong places though
+        if (not m_error.has_value()) {
+            std::ignore = std::fwrite(index.data(), 1, index.size(), m_file);
+        }
+        std::ignore = std::fclose(m_file); // NOLINT(cppcoreguidelines-owning-memory)
+    }
+
+    [[nodiscard]] bool has_error() const {
+        return m_has_error.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] helper::expected<void, std::string> error() {
+        const std::lock_guard lock{ m_mutex };
+        if (m_error.has_value()) {
+            return helper::unexpected<std::string>{ m_error.value() };
+        }
+        return {};
+    }
+
+    // hands the block to the thread, returns an empty block to continue with
+    [[nodiscard]] std::vector<char>
+    submit(std::vector<char>&& block, const u64 first_simulation_step, const u64 last_simulation_step) {
+        std::vector<char> result{};
+        {
+            const std::lock_guard lock{ m_mutex };
+            m_pending_blocks.push_back(PendingBlock{ .bytes = std::move(block),
+                                                     .first_simulation_step = first_simulation_step,
+                                                     .last_simulation_step = last_simulation_step });
+            ++m_num_submitted;
+            if (not m_free_blocks.empty()) {
+                result = std::move(m_free_blocks.back());
+                m_free_blocks.pop_back();
+            }
+        }
+        m_work_available.notify_one();
+        return result;
+    }
+
+    [[nodiscard]] helper::expected<void, std::string> wait(const bool sync) {
+        std::unique_lock lock{ m_mutex };
+        const auto num_submitted = m_num_submitted;
+        if (sync) {
+            ++m_num_sync_requests;
+            m_work_available.notify_one();
+        }
+        const auto num_sync_requests = m_num_sync_requests;
+
+        m_work_done.wait(lock, [this, num_submitted, num_sync_requests]() {
+            return m_num_written >= num_submitted and m_num_syncs >= num_sync_requests;
+        });
+
+        if (m_error.has_value()) {
+            return helper::unexpected<std::string>{ m_error.value() };
+        }
+        return {};
+    }
+
+private:
+    void run() {
+        auto last_sync = std::chrono::steady_clock::now();
+        std::vector<PendingBlock> blocks{};
+        std::vector<char> header{};
+
+        while (true) {
+            u64 num_sync_requests = 0;
+            {
+                std::unique_lock lock{ m_mutex };
+                m_work_available.wait(lock, [this]() {
+                    return m_is_stopping or not m_pending_blocks.empty() or m_num_sync_requests != m_num_syncs;
+                });
+                if (m_pending_blocks.empty() and m_num_sync_requests == m_num_syncs) {
+                    break;
+                }
+                std::swap(blocks, m_pending_blocks);
+                num_sync_requests = m_num_sync_requests;
+            }
+
+            // the disk is only touched (and the blocks only compressed) without holding the lock, so that adding
+            // entries never waits for it
+            std::optional<std::string> error{};
+            for (const auto& block : blocks) {
+                const auto compressed = helper::block_codec::compress(std::as_bytes(std::span{ block.bytes }));
+
+                header.clear();
+                static_assert(sizeof(std::underlying_type_t<MagicByte>) == 1);
+                helper::writer::append_value(header, utils::to_underlying(MagicByte::Block));
+                helper::writer::append_value(header, static_cast<u32>(block.bytes.size()));
+                helper::writer::append_value(header, static_cast<u32>(compressed.size()));
+
+                if (std::fwrite(header.data(), 1, header.size(), m_file) != header.size()
+                    or std::fwrite(compressed.data(), 1, compressed.size(), m_file) != compressed.size()) {
+                    error = "failed to write to the recording file";
+                }
+
+                m_block_index.push_back(BlockIndexEntry{ .offset = m_file_size,
+                                                         .first_simulation_step = block.first_simulation_step,
+                                                         .last_simulation_step = block.last_simulation_step });
+                m_file_size += header.size() + compressed.size();
+            }
+            if (std::fflush(m_file) != 0) {
+                error = "failed to flush the recording file";
+            }
+
+            // m_num_syncs is only changed by this thread
+            const auto now = std::chrono::steady_clock::now();
+            if (num_sync_requests != m_num_syncs
+                or (m_sync_interval.has_value() and now - last_sync >= m_sync_interval.value())) {
+                if (not sync_to_storage(m_file)) {
+                    error = "failed to sync the recording file to the storage device";
+                }
+                last_sync = now;
+            }
+
+            {
+                const std::lock_guard lock{ m_mutex };
+                m_num_written += blocks.size();
+                m_num_syncs = num_sync_requests;
+                if (error.has_value() and not m_error.has_value()) {
+                    m_error = std::move(error);
+                    m_has_error.store(true, std::memory_order_relaxed);
+                }
+                for (auto& block : blocks) {
+                    if (m_free_blocks.size() < max_free_blocks) {
+                        block.bytes.clear();
+                        m_free_blocks.push_back(std::move(block.bytes));
+                    }
+                }
+            }
+            blocks.clear();
+            m_work_done.notify_all();
+        }
+    }
+};
+
 recorder::RecordingWriter::RecordingWriter(
-        std::ofstream&& output_file,
+        std::unique_ptr<Output> output,
         std::vector<TetrionHeader>&& tetrion_headers,
-        AdditionalInformation&& information
+        AdditionalInformation&& information,
+        const DurabilityPolicy policy
 )
     : Recording{ std::move(tetrion_headers), std::move(information) },
-      m_output_file{ std::move(output_file) } { }
+      m_output{ std::move(output) },
+      m_previous_record_steps(m_tetrion_headers.size(), 0),
+      m_policy{ policy },
+      m_last_flush{ std::chrono::steady_clock::now() } {
+    m_block.reserve(block_size);
+}
 
 
 recorder::RecordingWriter::RecordingWriter(RecordingWriter&& old) noexcept
-    : recorder::RecordingWriter{ std::move(old.m_output_file), std::move(old.m_tetrion_headers),
-                                 std::move(old.m_information) } { }
+    : Recording{ std::move(old.m_tetrion_headers), std::move(old.m_information) },
+      m_output{ std::move(old.m_output) },
+      m_block{ std::move(old.m_block) },
+      m_num_block_entries{ old.m_num_block_entries },
+      m_block_first_step{ old.m_block_first_step },
+      m_block_last_step{ old.m_block_last_step },
+      m_previous_record_steps{ std::move(old.m_previous_record_steps) },
+      m_policy{ old.m_policy },
+      m_last_flush{ old.m_last_flush } { }
+
+recorder::RecordingWriter::~RecordingWriter() {
+    if (m_output != nullptr) {
+        // destroying the output writes all pending blocks
+        std::ignore = submit_block();
+    }
+}
 
 
 helper::expected<recorder::RecordingWriter, std::string> recorder::RecordingWriter::get_writer(
         const std::filesystem::path& path,
         std::vector<TetrionHeader>&& tetrion_headers,
         AdditionalInformation&& information,
-        bool overwrite
+        bool overwrite,
+        const DurabilityPolicy policy
 ) {
-    auto mode = std::ios::out | std::ios::binary;
     if (overwrite) {
         if (std::filesystem::exists(path)) {
             return helper::unexpected<std::string>{
                 fmt::format("file already exists, not overwriting it: \"{}\"", path.string())
             };
         }
-    } else {
-        mode |= std::ios::trunc;
-    }
-
-
-    auto output_file = std::ofstream{ path, mode };
-
-    if (not output_file) {
-        return helper::unexpected<std::string>{ fmt::format("failed to open output file \"{}\"", path.string()) };
     }
 
-    helper::expected<void, std::string> result{};
+    std::vector<char> header{};
 
     static_assert(sizeof(constants::recording::magic_file_byte) == 4);
-    result = helper::writer::write_integral_to_file(output_file, constants::recording::magic_file_byte);
-    if (not result.has_value()) {
-        return helper::unexpected<std::string>{ fmt::format("error while writing: {}", result.error()) };
-    }
+    helper::writer::append_value(header, constants::recording::magic_file_byte);
 
     static_assert(sizeof(Recording::current_supported_version_number) == 1);
-    result = helper::writer::write_integral_to_file(output_file, Recording::current_supported_version_number);
-    if (not result.has_value()) {
-        return helper::unexpected<std::string>{ fmt::format("error while writing: {}", result.error()) };
-    }
+    helper::writer::append_value(header, Recording::current_supported_version_number);
 
-    result = helper::writer::write_integral_to_file<u8>(output_file, static_cast<u8>(tetrion_headers.size()));
-    if (not result.has_value()) {
-        return helper::unexpected<std::string>{ fmt::format("error while writing: {}", result.error()) };
-    }
+    helper::writer::append_value(header, static_cast<u8>(tetrion_headers.size()));
 
-    for (const auto& header : tetrion_headers) {
-        result = write_tetrion_header_to_file(output_file, header);
-        if (not result.has_value()) {
-            return helper::unexpected<std::string>{ result.error() };
-        }
+    for (const auto& tetrion_header : tetrion_headers) {
+        append_tetrion_header(header, tetrion_header);
     }
 
-
     const auto information_bytes = information.to_bytes();
     if (not information_bytes.has_value()) {
         return helper::unexpected<std::string>{ information_bytes.error() };
     }
+    header.insert(header.end(), information_bytes->begin(), information_bytes->end());
 
-    result = helper::writer::write_vector_to_file(output_file, information_bytes.value());
+    append_checksum(header, tetrion_headers, information);
 
-    if (not result.has_value()) {
-        return helper::unexpected<std::string>{ fmt::format("error while writing: {}", result.error()) };
+    auto* file = open_file(path);
+    if (file == nullptr) {
+        return helper::unexpected<std::string>{ fmt::format("failed to open output file \"{}\"", path.string()) };
     }
 
-    result = write_checksum_to_file(output_file, tetrion_headers, information);
-    if (not result.has_value()) {
-        return helper::unexpected<std::string>{ fmt::format("error while writing: {}", result.error()) };
+    // the header is written right away, so that an unwritable file is reported here
+    if (std::fwrite(header.data(), 1, header.size(), file) != header.size() or std::fflush(file) != 0) {
+        std::ignore = std::fclose(file); // NOLINT(cppcoreguidelines-owning-memory)
+        return helper::unexpected<std::string>{
+            fmt::format("error while writing: failed to write header to \"{}\"", path.string())
+        };
     }
 
-    return RecordingWriter{ std::move(output_file), std::move(tetrion_headers), std::move(information) };
+    return RecordingWriter{ std::make_unique<Output>(file, policy.sync_interval, header.size()),
+                            std::move(tetrion_headers), std::move(information), policy };
 }
 
 helper::expected<void, std::string> recorder::RecordingWriter::add_record(
@@ -93,76 +350,150 @@ helper::expected<void, std::string> recorder::RecordingWriter::add_record(
 ) {
     assert(tetrion_index < m_tetrion_headers.size());
 
-    helper::expected<void, std::string> result{};
+    auto& previous_step = m_previous_record_steps.at(tetrion_index);
 
     static_assert(sizeof(std::underlying_type_t<MagicByte>) == 1);
-    result = write(utils::to_underlying(MagicByte::Record));
-    if (not result.has_value()) {
-        return helper::unexpected<std::string>{ result.error() };
-    }
+    if (tetrion_index <= compact_record::max_tetrion_index and simulation_step_index >= previous_step) {
+        helper::writer::append_value(m_block, utils::to_underlying(MagicByte::CompactRecord));
+        helper::writer::append_value(m_block, compact_record::pack(tetrion_index, event));
+        helper::writer::append_varint(m_block, simulation_step_index - previous_step);
+    } else {
+        helper::writer::append_value(m_block, utils::to_underlying(MagicByte::Record));
 
-    static_assert(sizeof(decltype(tetrion_index)) == 1);
-    result = write(tetrion_index);
-    if (not result.has_value()) {
-        return helper::unexpected<std::string>{ result.error() };
-    }
+        static_assert(sizeof(decltype(tetrion_index)) == 1);
+        helper::writer::append_value(m_block, tetrion_index);
 
-    static_assert(sizeof(decltype(simulation_step_index)) == 8);
-    result = write(simulation_step_index);
-    if (not result.has_value()) {
-        return helper::unexpected<std::string>{ result.error() };
-    }
+        static_assert(sizeof(decltype(simulation_step_index)) == 8);
+        helper::writer::append_value(m_block, simulation_step_index);
 
-    static_assert(sizeof(std::underlying_type_t<InputEvent>) == 1);
-    result = write(utils::to_underlying(event));
+        static_assert(sizeof(std::underlying_type_t<InputEvent>) == 1);
+        helper::writer::append_value(m_block, utils::to_underlying(event));
+    }
+    previous_step = simulation_step_index;
 
-    return result;
+    return entry_added(simulation_step_index);
 }
 
 helper::expected<void, std::string> recorder::RecordingWriter::add_snapshot(
         const u64 simulation_step_index,
         std::unique_ptr<TetrionCoreInformation> information
 ) {
+    static_assert(sizeof(std::underlying_type_t<MagicByte>) == 1);
+    helper::writer::append_value(m_block, utils::to_underlying(MagicByte::Snapshot));
+
+    const auto snapshot = TetrionSnapshot{ information->tetrion_index, information->level,    information->score,
+                                           information->lines_cleared, simulation_step_index, information->mino_stack };
 
-    helper::expected<void, std::string> result{};
+    snapshot.append_bytes(m_block);
+
+    return entry_added(simulation_step_index);
+}
+
+helper::expected<void, std::string> recorder::RecordingWriter::add_keyframe(
+        const u8 tetrion_index,
+        const u64 simulation_step_index,
+        std::vector<char> state
+) {
+    assert(tetrion_index < m_tetrion_headers.size());
 
     static_assert(sizeof(std::underlying_type_t<MagicByte>) == 1);
-    result = write(utils::to_underlying(MagicByte::Snapshot));
+    helper::writer::append_value(m_block, utils::to_underlying(MagicByte::Keyframe));
+
+    const auto keyframe = TetrionKeyframe{ tetrion_index, simulation_step_index, std::move(state) };
+
+    keyframe.append_bytes(m_block);
+
+    return entry_added(simulation_step_index);
+}
+
+helper::expected<void, std::string> recorder::RecordingWriter::add_state_hash(
+        const u8 tetrion_index, // NOLINT(bugprone-easily-swappable-parameters)
+        const u64 simulation_step_index,
+        const u64 hash
+) {
+    assert(tetrion_index < m_tetrion_headers.size());
+
+    static_assert(sizeof(std::underlying_type_t<MagicByte>) == 1);
+    helper::writer::append_value(m_block, utils::to_underlying(MagicByte::StateHash));
+
+    static_assert(sizeof(decltype(tetrion_index)) == 1);
+    helper::writer::append_value(m_block, tetrion_index);
+
+    static_assert(sizeof(decltype(simulation_step_index)) == 8);
+    helper::writer::append_value(m_block, simulation_step_index);
+
+    static_assert(sizeof(decltype(hash)) == 8);
+    helper::writer::append_value(m_block, hash);
+
+    return entry_added(simulation_step_index);
+}
+
+helper::expected<void, std::string> recorder::RecordingWriter::game_over() {
+    if (not m_policy.flush_on_game_over) {
+        return m_output->error();
+    }
+
+    return submit_block();
+}
+
+helper::expected<void, std::string> recorder::RecordingWriter::flush(const bool sync) {
+    const auto result = submit_block();
     if (not result.has_value()) {
-        return helper::unexpected<std::string>{ result.error() };
+        return result;
     }
 
-    const auto snapshot = TetrionSnapshot{ information->tetrion_index, information->level,    information->score,
-                                           information->lines_cleared, simulation_step_index, information->mino_stack };
+    return m_output->wait(sync);
+}
 
-    const auto bytes = snapshot.to_bytes();
-    result = helper::writer::write_vector_to_file(m_output_file, bytes);
+helper::expected<void, std::string> recorder::RecordingWriter::entry_added(const u64 simulation_step_index) {
+    ++m_num_block_entries;
+    m_block_first_step = std::min(m_block_first_step, simulation_step_index);
+    m_block_last_step = std::max(m_block_last_step, simulation_step_index);
+
+    const auto is_due = m_block.size() >= block_size
+                        or (m_policy.flush_after_entries != 0 and m_num_block_entries >= m_policy.flush_after_entries)
+                        or (m_policy.sync_interval.has_value()
+                            and std::chrono::steady_clock::now() - m_last_flush >= m_policy.sync_interval.value());
+    if (is_due) {
+        return submit_block();
+    }
+
+    if (m_output->has_error()) {
+        return m_output->error();
+    }
 
-    return result;
+    return {};
 }
 
+helper::expected<void, std::string> recorder::RecordingWriter::submit_block() {
+    if (not m_block.empty()) {
+        m_block = m_output->submit(std::move(m_block), m_block_first_step, m_block_last_step);
+        m_block.reserve(block_size);
+        m_num_block_entries = 0;
+        m_block_first_step = std::numeric_limits<u64>::max();
+        m_block_last_step = 0;
+        // every block is decoded on its own
+        std::ranges::fill(m_previous_record_steps, 0);
+        m_last_flush = std::chrono::steady_clock::now();
+    }
+
+    return m_output->error();
+}
 
-helper::expected<void, std::string>
-recorder::RecordingWriter::write_tetrion_header_to_file(std::ofstream& file, const TetrionHeader& header) {
-    helper::expected<void, std::string> result{};
 
+void recorder::RecordingWriter::append_tetrion_header(std::vector<char>& bytes, const TetrionHeader& header) {
     static_assert(sizeof(decltype(header.seed)) == 8);
-    result = helper::writer::write_integral_to_file(file, header.seed);
-    if (not result.has_value()) {
-        return helper::unexpected<std::string>{ result.error() };
-    }
+    helper::writer::append_value(bytes, header.seed);
 
     static_assert(sizeof(decltype(header.starting_level)) == 4);
-    result = helper::writer::write_integral_to_file(file, header.starting_level);
-    if (not result.has_value()) {
-        return helper::unexpected<std::string>{ result.error() };
-    }
+    helper::writer::append_value(bytes, header.starting_level);
 
-    return result;
+    static_assert(sizeof(decltype(header.random_algorithm)) == 1);
+    helper::writer::append_value(bytes, static_cast<std::underlying_type_t<RandomAlgorithm>>(header.random_algorithm));
 }
 
-helper::expected<void, std::string> recorder::RecordingWriter::write_checksum_to_file(
-        std::ofstream& file,
+void recorder::RecordingWriter::append_checksum(
+        std::vector<char>& bytes,
         const std::vector<TetrionHeader>& tetrion_headers,
         const AdditionalInformation& information
 ) {
@@ -171,14 +502,7 @@ helper::expected<void, std::string> recorder::RecordingWriter::write_checksum_to
             Recording::get_header_checksum(Recording::current_supported_version_number, tetrion_headers, information);
     static_assert(sizeof(decltype(checksum)) == 32);
 
-    helper::expected<void, std::string> result{};
-
     for (const auto& checksum_byte : checksum) {
-        result = helper::writer::write_integral_to_file<u8>(file, checksum_byte);
-        if (not result.has_value()) {
-            return helper::unexpected<std::string>{ result.error() };
-        }
+        helper::writer::append_value<u8>(bytes, checksum_byte);
     }
-
-    return result;
 }
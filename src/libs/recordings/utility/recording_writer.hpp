@@ -8,30 +8,72 @@
 #include "./export_symbols.hpp"
 #include <core/helper/expected.hpp>
 
+#include <chrono>
 #include <filesystem>
+#include <limits>
+#include <memory>
+#include <optional>
 
 namespace recorder {
 
+    // when the recorded data has to be handed to the disk, everything is written at the latest when the writer is
+    // destroyed
+    struct DurabilityPolicy {
+        // after that many entries, 0 only writes full blocks
+        usize flush_after_entries{ 0 };
+        // as soon as any tetrion is game over
+        bool flush_on_game_over{ true };
+        // syncs the file to the storage device after this time, otherwise it's up to the operating system
+        std::optional<std::chrono::milliseconds> sync_interval{ std::nullopt };
+    };
+
+    // the entries are appended to an in memory block, a background thread compresses the full blocks and writes them to
+    // the file, so adding entries never waits for the disk
     struct RecordingWriter : public Recording {
+    public:
+        static constexpr usize block_size = 64 * 1024;
+
     private:
-        std::ofstream m_output_file;
+        // the file and the thread that writes to it, in its own allocation, so that the writer stays movable
+        struct Output;
+
+        std::unique_ptr<Output> m_output;
+        std::vector<char> m_block;
+        usize m_num_block_entries{ 0 };
+        // the range of steps of the entries in the block, for the index
+        u64 m_block_first_step{ std::numeric_limits<u64>::max() };
+        u64 m_block_last_step{ 0 };
+        // compact records only store the difference to the previous record of the tetrion
+        std::vector<u64> m_previous_record_steps;
+        DurabilityPolicy m_policy;
+        std::chrono::steady_clock::time_point m_last_flush;
 
         explicit RecordingWriter(
-                std::ofstream&& output_file,
+                std::unique_ptr<Output> output,
                 std::vector<TetrionHeader>&& tetrion_headers,
-                AdditionalInformation&& information
+                AdditionalInformation&& information,
+                DurabilityPolicy policy
         );
 
     public:
         OOPETRIS_RECORDINGS_EXPORTED RecordingWriter(RecordingWriter&& old) noexcept;
 
+        RecordingWriter(const RecordingWriter&) = delete;
+        RecordingWriter& operator=(const RecordingWriter&) = delete;
+        RecordingWriter& operator=(RecordingWriter&&) = delete;
+
+        // waits until everything is written
+        OOPETRIS_RECORDINGS_EXPORTED ~RecordingWriter();
+
         OOPETRIS_RECORDINGS_EXPORTED static helper::expected<RecordingWriter, std::string> get_writer(
                 const std::filesystem::path& path,
                 std::vector<TetrionHeader>&& tetrion_headers,
                 AdditionalInformation&& information,
-                bool overwrite = false
+                bool overwrite = false,
+                DurabilityPolicy policy = {}
         );
 
+        // the add functions only report errors of earlier writes, as the writing itself happens in the background
         [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED helper::expected<void, std::string> add_record(
                 u8 tetrion_index, // NOLINT(bugprone-easily-swappable-parameters)
                 u64 simulation_step_index,
@@ -41,25 +83,34 @@ namespace recorder {
         [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED helper::expected<void, std::string>
         add_snapshot(u64 simulation_step_index, std::unique_ptr<TetrionCoreInformation> information);
 
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED helper::expected<void, std::string>
+        add_keyframe(u8 tetrion_index, u64 simulation_step_index, std::vector<char> state);
+
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED helper::expected<void, std::string> add_state_hash(
+                u8 tetrion_index, // NOLINT(bugprone-easily-swappable-parameters)
+                u64 simulation_step_index,
+                u64 hash
+        );
+
+        // hands the buffered entries to the background thread, if the policy asks for it, doesn't wait for the disk
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED helper::expected<void, std::string> game_over();
+
+        // waits until everything added so far is written to the file (and synced to the storage device, if requested)
+        [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED helper::expected<void, std::string> flush(bool sync = false);
+
     private:
-        static helper::expected<void, std::string>
-        write_tetrion_header_to_file(std::ofstream& file, const TetrionHeader& header);
+        static void append_tetrion_header(std::vector<char>& bytes, const TetrionHeader& header);
 
-        static helper::expected<void, std::string> write_checksum_to_file(
-                std::ofstream& file,
+        static void append_checksum(
+                std::vector<char>& bytes,
                 const std::vector<TetrionHeader>& tetrion_headers,
                 const AdditionalInformation& information
         );
 
-        template<std::integral Integral>
-        helper::expected<void, std::string> write(Integral data) {
-            const auto result = helper::writer::write_integral_to_file(m_output_file, data);
-            if (not result.has_value()) {
-                return helper::unexpected<std::string>{ fmt::format("error while writing: {}", result.error()) };
-            }
+        // called after every entry, hands the block over, if it's full or the policy asks for it
+        [[nodiscard]] helper::expected<void, std::string> entry_added(u64 simulation_step_index);
 
-            return {};
-        }
+        [[nodiscard]] helper::expected<void, std::string> submit_block();
     };
 
 } // namespace recorder
@@ -0,0 +1,73 @@
+#include "./tetrion_keyframe.hpp"
+#include "./helper.hpp"
+
+#include <limits>
+
+
+TetrionKeyframe::TetrionKeyframe(
+        const u8 tetrion_index,
+        const SimulationStep simulation_step_index,
+        std::vector<char> state
+)
+    : m_tetrion_index{ tetrion_index },
+      m_simulation_step_index{ simulation_step_index },
+      m_state{ std::move(state) } { }
+
+
+helper::expected<TetrionKeyframe, std::string> TetrionKeyframe::from_istream(std::istream& istream) {
+    const auto tetrion_index = helper::reader::read_from_istream<u8>(istream);
+    if (not tetrion_index.has_value()) {
+        return helper::unexpected<std::string>{ "unable to read tetrion index from keyframe" };
+    }
+
+    const auto simulation_step_index = helper::reader::read_from_istream<SimulationStep>(istream);
+    if (not simulation_step_index.has_value()) {
+        return helper::unexpected<std::string>{ "unable to read simulation step index from keyframe" };
+    }
+
+    const auto state_size = helper::reader::read_from_istream<StateSize>(istream);
+    if (not state_size.has_value()) {
+        return helper::unexpected<std::string>{ "unable to read state size from keyframe" };
+    }
+
+    std::vector<char> state(state_size.value());
+    istream.read(state.data(), static_cast<std::streamsize>(state.size()));
+    if (not istream) {
+        return helper::unexpected<std::string>{ "unable to read state from keyframe" };
+    }
+
+    return TetrionKeyframe{ tetrion_index.value(), simulation_step_index.value(), std::move(state) };
+}
+
+[[nodiscard]] u8 TetrionKeyframe::tetrion_index() const {
+    return m_tetrion_index;
+}
+
+[[nodiscard]] SimulationStep TetrionKeyframe::simulation_step_index() const {
+    return m_simulation_step_index;
+}
+
+[[nodiscard]] const std::vector<char>& TetrionKeyframe::state() const {
+    return m_state;
+}
+
+[[nodiscard]] std::vector<char> TetrionKeyframe::to_bytes() const {
+    auto bytes = std::vector<char>{};
+    bytes.reserve(sizeof(m_tetrion_index) + sizeof(m_simulation_step_index) + sizeof(StateSize) + m_state.size());
+    append_bytes(bytes);
+    return bytes;
+}
+
+void TetrionKeyframe::append_bytes(std::vector<char>& bytes) const {
+    static_assert(sizeof(decltype(m_tetrion_index)) == 1);
+    helper::writer::append_value(bytes, m_tetrion_index);
+
+    static_assert(sizeof(decltype(m_simulation_step_index)) == 8);
+    helper::writer::append_value(bytes, m_simulation_step_index);
+
+    assert(m_state.size() <= std::numeric_limits<StateSize>::max());
+    static_assert(sizeof(StateSize) == 4);
+    helper::writer::append_value(bytes, static_cast<StateSize>(m_state.size()));
+
+    bytes.insert(bytes.end(), m_state.begin(), m_state.end());
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "./export_symbols.hpp"
+#include <core/helper/expected.hpp>
+#include <core/helper/types.hpp>
+
+#include <istream>
+#include <vector>
+
+// the complete state of a tetrion at some simulation step, so that a replay can resume from there
+// the state itself is opaque to the recording, its layout is defined by the engine that wrote it
+struct TetrionKeyframe final {
+public:
+    using StateSize = u32;
+
+private:
+    u8 m_tetrion_index;
+    SimulationStep m_simulation_step_index;
+    std::vector<char> m_state;
+
+public:
+    OOPETRIS_RECORDINGS_EXPORTED
+    TetrionKeyframe(u8 tetrion_index, SimulationStep simulation_step_index, std::vector<char> state);
+
+    OOPETRIS_RECORDINGS_EXPORTED static helper::expected<TetrionKeyframe, std::string> from_istream(
+            std::istream& istream
+    );
+
+    [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED u8 tetrion_index() const;
+
+    [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED SimulationStep simulation_step_index() const;
+
+    [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED const std::vector<char>& state() const;
+
+    [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED std::vector<char> to_bytes() const;
+
+    // the same as to_bytes, but appends to existing bytes, so no temporary buffer is needed
+    OOPETRIS_RECORDINGS_EXPORTED void append_bytes(std::vector<char>& bytes) const;
+};
@@ -82,6 +82,12 @@ helper::expected<TetrionSnapshot, std::string> TetrionSnapshot::from_istream(std
             };
         }
 
+        if (x_coord.value() >= grid::width_in_tiles or y_coord.value() >= grid::height_in_tiles) {
+            return helper::unexpected<std::string>{
+                fmt::format("mino position out of bounds in snapshot: ({}, {})", x_coord.value(), y_coord.value())
+            };
+        }
+
         auto mino_pos = shapes::AbstractPoint<Coordinate>(x_coord.value(), y_coord.value());
 
         mino_stack.set(mino_pos.cast<i8>(), maybe_type.value());
@@ -128,7 +134,11 @@ TetrionSnapshot::TetrionSnapshot(
 
 [[nodiscard]] std::vector<char> TetrionSnapshot::to_bytes() const {
     auto bytes = std::vector<char>{};
+    append_bytes(bytes);
+    return bytes;
+}
 
+void TetrionSnapshot::append_bytes(std::vector<char>& bytes) const {
     static_assert(sizeof(decltype(m_tetrion_index)) == 1);
     helper::writer::append_value(bytes, m_tetrion_index);
 
@@ -165,7 +175,6 @@ TetrionSnapshot::TetrionSnapshot(
         static_assert(sizeof(std::underlying_type_t<helper::TetrominoType>) == 1);
         helper::writer::append_value(bytes, std::to_underlying(mino.type()));
     }
-    return bytes;
 }
 
 
@@ -60,6 +60,9 @@ public:
 
     [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED std::vector<char> to_bytes() const;
 
+    // the same as to_bytes, but appends to existing bytes, so no temporary buffer is needed
+    OOPETRIS_RECORDINGS_EXPORTED void append_bytes(std::vector<char>& bytes) const;
+
     [[nodiscard]] OOPETRIS_RECORDINGS_EXPORTED helper::expected<void, std::string> compare_to(
             const TetrionSnapshot& other
     ) const;
@@ -4,9 +4,12 @@
 #include "helper/constants.hpp"
 #include "helper/graphic_utils.hpp"
 #include "helper/music_utils.hpp"
+#include "helper/spdlog_wrapper.hpp"
 #include "manager/music_manager.hpp"
 #include "scenes/scene.hpp"
 
+#include <algorithm>
+#include <ranges>
 #include <vector>
 
 namespace scenes {
@@ -16,7 +19,8 @@ namespace scenes {
             const ui::Layout& layout,
             const std::filesystem::path& recording_path
     )
-        : Scene{ service_provider, layout } {
+        : Scene{ service_provider, layout },
+          m_simulation_frequency{ constants::simulation_frequency } {
 
         auto [parameters, information] = input::get_game_parameters_for_replay(service_provider, recording_path);
 
@@ -26,21 +30,22 @@ namespace scenes {
 
         if (parameters.empty()) {
             throw std::runtime_error("An empty recording file isn't supported");
-        } else if (parameters.size() == 1) { // NOLINT(readability-else-after-return,llvm-else-after-return)
-            layouts.push_back(ui::RelativeLayout{ layout, 0.02, 0.01, 0.96, 0.98 });
-        } else if (parameters.size() == 2) {
-            layouts.push_back(ui::RelativeLayout{ layout, 0.02, 0.01, 0.46, 0.98 });
-            layouts.push_back(ui::RelativeLayout{ layout, 0.52, 0.01, 0.46, 0.98 });
-        } else {
+        }
 
-            //TODO(Totto): support bigger layouts than just 2
-            throw std::runtime_error("At the moment only replays from up to two players are supported");
+        // all players side by side, the gaps shrink with more players, so that there is always room left
+        constexpr double margin = 0.02;
+        const auto num_players = static_cast<double>(parameters.size());
+        const auto gap = 0.08 / std::max(num_players, 2.0);
+        const auto width = (1.0 - 2 * margin - (num_players - 1) * gap) / num_players;
+        for (decltype(parameters.size()) i = 0; i < parameters.size(); ++i) {
+            layouts.push_back(
+                    ui::RelativeLayout{ layout, margin + static_cast<double>(i) * (width + gap), 0.01, width, 0.98 }
+            );
         }
 
-        u32 simulation_frequency = constants::simulation_frequency;
         if (const auto stored_simulation_frequency = information.get_if<u32>("simulation_frequency");
             stored_simulation_frequency.has_value()) {
-            simulation_frequency = stored_simulation_frequency.value();
+            m_simulation_frequency = stored_simulation_frequency.value();
         }
 
 
@@ -48,8 +53,10 @@ namespace scenes {
             auto [input, starting_parameters] = std::move(parameters.at(i));
 
             m_games.emplace_back(std::make_unique<Game>(
-                    service_provider, std::move(input), starting_parameters, simulation_frequency, layouts.at(i), false
+                    service_provider, std::move(input), starting_parameters, m_simulation_frequency, layouts.at(i),
+                    false
             ));
+            m_games.back()->enable_checkpoints(checkpoint_memory_budget / parameters.size());
         }
 
 
@@ -75,16 +82,27 @@ namespace scenes {
 
 
     [[nodiscard]] Scene::UpdateResult ReplayGame::update() {
-        bool all_games_finished = true;
-        for (auto& game : m_games) {
-            if (game->is_game_finished()) {
-                continue;
+        const auto is_running = [](const auto& game) { return not game->is_game_finished(); };
+
+        if (m_playback_speed_index >= playback_speeds.size()) {
+            // every update simulates one step with input or game events, the game, that is furthest behind, gets the
+            // next one, so all games share the budget of the frame and stay at about the same step
+            const auto deadline = std::chrono::steady_clock::now() + max_speed_time_per_frame;
+            while (std::chrono::steady_clock::now() < deadline) {
+                auto running_games = m_games | std::views::filter(is_running);
+                const auto game = std::ranges::min_element(running_games, {}, &Game::simulation_step_index);
+                if (game == running_games.end()) {
+                    break;
+                }
+                (*game)->update();
+            }
+        } else {
+            for (auto& game : m_games | std::views::filter(is_running)) {
+                game->update();
             }
-
-            all_games_finished = false;
-            game->update();
         }
 
+        const auto all_games_finished = std::ranges::none_of(m_games, is_running);
         if (all_games_finished) {
             //TODO(Totto): the game input we use here for the game over is not guarantteed to work, better wul dbe to get one for this system at the tart of this scene!
             return UpdateResult{
@@ -136,10 +154,40 @@ namespace scenes {
     [[nodiscard]] bool
     ReplayGame::handle_event(const std::shared_ptr<input::InputManager>& input_manager, const SDL_Event& event) {
 
+        // seeking restores the closest checkpoint or keyframe of the recording, so this is cheap in both directions
+        const auto navigation_event = input_manager->get_navigation_event(event);
+        if (navigation_event == input::NavigationEvent::LEFT or navigation_event == input::NavigationEvent::RIGHT) {
+            const auto seek_distance = static_cast<SimulationStep>(seek_seconds) * m_simulation_frequency;
+            for (auto& game : m_games) {
+                const auto current_simulation_step_index = game->simulation_step_index();
+                game->seek(
+                        navigation_event == input::NavigationEvent::RIGHT
+                                ? current_simulation_step_index + seek_distance
+                                : current_simulation_step_index - std::min(current_simulation_step_index, seek_distance)
+                );
+            }
+            return true;
+        }
+
+        if (navigation_event == input::NavigationEvent::UP) {
+            set_playback_speed_index(std::min(m_playback_speed_index + 1, playback_speeds.size()));
+            return true;
+        }
+
+        if (navigation_event == input::NavigationEvent::DOWN) {
+            set_playback_speed_index(m_playback_speed_index == 0 ? 0 : m_playback_speed_index - 1);
+            return true;
+        }
+
+        if (navigation_event == input::NavigationEvent::OK) {
+            for (auto& game : m_games) {
+                game->skip_to_end();
+            }
+            return true;
+        }
+
         //TODO(Totto): add gameInput to this function
         //TODO(Totto): re-add pause scene
-        UNUSED(input_manager);
-        UNUSED(event);
         /*   if (utils::event_is_action(event, utils::CrossPlatformAction::Pause)) {
 
             for (auto& game : m_games) {
@@ -164,4 +212,20 @@ namespace scenes {
     }
 
 
+    void ReplayGame::set_playback_speed_index(const usize index) {
+        m_playback_speed_index = index;
+
+        const auto speed = index < playback_speeds.size() ? std::optional{ playback_speeds.at(index) } : std::nullopt;
+        if (speed.has_value()) {
+            spdlog::info("replay speed: {}x", speed.value());
+        } else {
+            spdlog::info("replay speed: maximum");
+        }
+
+        for (auto& game : m_games) {
+            game->set_playback_speed(speed);
+        }
+    }
+
+
 } // namespace scenes
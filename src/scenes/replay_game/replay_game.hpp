@@ -3,15 +3,29 @@
 #include "game/game.hpp"
 #include "scenes/scene.hpp"
 
+#include <array>
+#include <chrono>
+
 namespace scenes {
 
     struct ReplayGame : public Scene {
     private:
         enum class NextScene : u8 { Pause, Settings };
 
+        static constexpr u32 seek_seconds = 5;
+        // one more step than the last one is as fast as possible
+        static constexpr std::array<double, 7> playback_speeds{ 0.25, 0.5, 1.0, 2.0, 4.0, 8.0, 16.0 };
+        static constexpr usize default_playback_speed_index = 2;
+        // at maximum speed all games together get this much of a frame, that leaves enough of a 60 fps frame for
+        // rendering and event handling
+        static constexpr auto max_speed_time_per_frame = std::chrono::milliseconds{ 12 };
+        // shared by all tetrions, enough for hours of dense checkpoints
+        static constexpr usize checkpoint_memory_budget = usize{ 32 } * 1024 * 1024;
 
         std::optional<NextScene> m_next_scene;
         std::vector<std::unique_ptr<Game>> m_games;
+        u32 m_simulation_frequency;
+        usize m_playback_speed_index{ default_playback_speed_index };
 
     public:
         OOPETRIS_GRAPHICS_EXPORTED explicit ReplayGame(
@@ -24,6 +38,9 @@ namespace scenes {
         OOPETRIS_GRAPHICS_EXPORTED void render(const ServiceProvider& service_provider) override;
         [[nodiscard]] OOPETRIS_GRAPHICS_EXPORTED bool
         handle_event(const std::shared_ptr<input::InputManager>& input_manager, const SDL_Event& event) override;
+
+    private:
+        void set_playback_speed_index(usize index);
     };
 
 
@@ -0,0 +1,162 @@
+#include <core/game/mino_stack.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+
+TEST(MinoStack, EmptyStack) {
+    const auto mino_stack = MinoStack{};
+
+    ASSERT_EQ(mino_stack.num_minos(), 0);
+    ASSERT_TRUE(mino_stack.minos().empty());
+
+    for (i8 y = 0; y < grid::height_in_tiles; ++y) {
+        for (i8 x = 0; x < grid::width_in_tiles; ++x) {
+            ASSERT_TRUE(mino_stack.is_empty(grid::GridPoint{ x, y }));
+        }
+    }
+}
+
+TEST(MinoStack, SetAndOverwrite) {
+    auto mino_stack = MinoStack{};
+
+    mino_stack.set(grid::GridPoint{ 3, 19 }, helper::TetrominoType::T);
+    mino_stack.set(grid::GridPoint{ 9, 0 }, helper::TetrominoType::Z);
+
+    ASSERT_EQ(mino_stack.num_minos(), 2);
+    ASSERT_FALSE(mino_stack.is_empty(grid::GridPoint{ 3, 19 }));
+    ASSERT_FALSE(mino_stack.is_empty(grid::GridPoint{ 9, 0 }));
+    ASSERT_TRUE(mino_stack.is_empty(grid::GridPoint{ 4, 19 }));
+
+    // out of bounds positions are never occupied
+    ASSERT_TRUE(mino_stack.is_empty(grid::GridPoint{ -1, 19 }));
+    ASSERT_TRUE(mino_stack.is_empty(grid::GridPoint{ 10, 0 }));
+
+    mino_stack.set(grid::GridPoint{ 3, 19 }, helper::TetrominoType::I);
+
+    ASSERT_EQ(mino_stack.num_minos(), 2);
+    ASSERT_THAT(
+            mino_stack.minos(), ::testing::ElementsAre(
+                                        Mino{ grid::GridPoint{ 9, 0 }, helper::TetrominoType::Z },
+                                        Mino{ grid::GridPoint{ 3, 19 }, helper::TetrominoType::I }
+                                )
+    );
+}
+
+TEST(MinoStack, ClearRowAndLetSink) {
+    auto mino_stack = MinoStack{};
+
+    for (i8 x = 0; x < grid::width_in_tiles; ++x) {
+        mino_stack.set(grid::GridPoint{ x, 19 }, helper::TetrominoType::I);
+    }
+    mino_stack.set(grid::GridPoint{ 2, 18 }, helper::TetrominoType::L);
+    mino_stack.set(grid::GridPoint{ 5, 17 }, helper::TetrominoType::S);
+
+    mino_stack.clear_row_and_let_sink(19);
+
+    auto expected = MinoStack{};
+    expected.set(grid::GridPoint{ 2, 19 }, helper::TetrominoType::L);
+    expected.set(grid::GridPoint{ 5, 18 }, helper::TetrominoType::S);
+
+    ASSERT_EQ(mino_stack.num_minos(), 2);
+    ASSERT_EQ(mino_stack, expected);
+}
+
+TEST(MinoStack, EqualityIsIndependentOfInsertionOrder) {
+    auto first = MinoStack{};
+    first.set(grid::GridPoint{ 0, 0 }, helper::TetrominoType::O);
+    first.set(grid::GridPoint{ 7, 12 }, helper::TetrominoType::J);
+
+    auto second = MinoStack{};
+    second.set(grid::GridPoint{ 7, 12 }, helper::TetrominoType::J);
+    second.set(grid::GridPoint{ 0, 0 }, helper::TetrominoType::O);
+
+    ASSERT_EQ(first, second);
+
+    second.set(grid::GridPoint{ 7, 12 }, helper::TetrominoType::T);
+    ASSERT_NE(first, second);
+}
+
+TEST(MinoStack, ClearFullRowsInSinglePass) {
+    auto mino_stack = MinoStack{};
+
+    for (i8 x = 0; x < grid::width_in_tiles; ++x) {
+        mino_stack.set(grid::GridPoint{ x, 19 }, helper::TetrominoType::I);
+        mino_stack.set(grid::GridPoint{ x, 17 }, helper::TetrominoType::O);
+        mino_stack.set(grid::GridPoint{ x, 10 }, helper::TetrominoType::T);
+    }
+    mino_stack.set(grid::GridPoint{ 4, 18 }, helper::TetrominoType::L);
+    mino_stack.set(grid::GridPoint{ 1, 16 }, helper::TetrominoType::S);
+
+    // the full row 10 is outside of the checked range and has to stay
+    ASSERT_EQ(mino_stack.clear_full_rows(16, 19), 2);
+
+    auto expected = MinoStack{};
+    expected.set(grid::GridPoint{ 4, 19 }, helper::TetrominoType::L);
+    expected.set(grid::GridPoint{ 1, 18 }, helper::TetrominoType::S);
+    for (i8 x = 0; x < grid::width_in_tiles; ++x) {
+        expected.set(grid::GridPoint{ x, 12 }, helper::TetrominoType::T);
+    }
+
+    ASSERT_EQ(mino_stack.num_minos(), expected.num_minos());
+    ASSERT_EQ(mino_stack, expected);
+    ASSERT_TRUE(mino_stack.is_row_full(12));
+    ASSERT_FALSE(mino_stack.is_row_full(19));
+
+    ASSERT_EQ(mino_stack.clear_full_rows(0, 19), 1);
+    ASSERT_EQ(mino_stack.num_minos(), 2);
+}
+
+TEST(MinoStack, ColumnHeightsAndFreeCells) {
+    auto mino_stack = MinoStack{};
+
+    ASSERT_EQ(mino_stack.column_height(0), 0);
+    ASSERT_EQ(mino_stack.free_cells_below(grid::GridPoint{ 0, 0 }), 19);
+
+    mino_stack.set(grid::GridPoint{ 0, 15 }, helper::TetrominoType::J);
+    mino_stack.set(grid::GridPoint{ 0, 19 }, helper::TetrominoType::J);
+
+    ASSERT_EQ(mino_stack.column_height(0), 5);
+    ASSERT_EQ(mino_stack.free_cells_below(grid::GridPoint{ 0, 0 }), 14);
+    // below an overhang only the cells up to the next occupied cell count
+    ASSERT_EQ(mino_stack.free_cells_below(grid::GridPoint{ 0, 16 }), 2);
+    ASSERT_EQ(mino_stack.free_cells_below(grid::GridPoint{ 0, 19 }), 0);
+
+    for (i8 x = 0; x < grid::width_in_tiles; ++x) {
+        mino_stack.set(grid::GridPoint{ x, 19 }, helper::TetrominoType::I);
+    }
+    ASSERT_EQ(mino_stack.clear_full_rows(19, 19), 1);
+
+    ASSERT_EQ(mino_stack.column_height(0), 4);
+    ASSERT_EQ(mino_stack.column_height(1), 0);
+    ASSERT_EQ(mino_stack.free_cells_below(grid::GridPoint{ 0, 0 }), 15);
+}
+
+TEST(MinoStack, HashFollowsContent) {
+    auto mino_stack = MinoStack{};
+    const auto empty_hash = mino_stack.hash();
+
+    mino_stack.set(grid::GridPoint{ 4, 18 }, helper::TetrominoType::L);
+    const auto single_hash = mino_stack.hash();
+    ASSERT_NE(single_hash, empty_hash);
+
+    // overwriting a cell replaces its contribution to the hash
+    mino_stack.set(grid::GridPoint{ 4, 18 }, helper::TetrominoType::T);
+    ASSERT_NE(mino_stack.hash(), single_hash);
+    mino_stack.set(grid::GridPoint{ 4, 18 }, helper::TetrominoType::L);
+    ASSERT_EQ(mino_stack.hash(), single_hash);
+
+    for (i8 x = 0; x < grid::width_in_tiles; ++x) {
+        mino_stack.set(grid::GridPoint{ x, 19 }, helper::TetrominoType::I);
+    }
+    ASSERT_EQ(mino_stack.clear_full_rows(18, 19), 1);
+
+    auto expected = MinoStack{};
+    expected.set(grid::GridPoint{ 4, 19 }, helper::TetrominoType::L);
+
+    ASSERT_EQ(mino_stack.hash(), expected.hash());
+    ASSERT_EQ(mino_stack, expected);
+
+    mino_stack.clear_row_and_let_sink(19);
+    ASSERT_EQ(mino_stack.hash(), empty_hash);
+}
@@ -0,0 +1,79 @@
+#include <core/helper/random.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <tuple>
+#include <vector>
+
+
+TEST(Random, Xoshiro256IsTheSameOnEveryPlatform) {
+    auto random = Random{ 42, RandomAlgorithm::Xoshiro256 };
+
+    std::vector<int> values{};
+    for (usize i = 0; i < 10; ++i) {
+        values.push_back(random.random(7));
+    }
+    ASSERT_THAT(values, ::testing::ElementsAre(2, 1, 5, 4, 4, 1, 2, 0, 5, 5));
+
+    ASSERT_EQ(random.random(1000000U), 817649U);
+    ASSERT_EQ(random.random(1000000U), 681893U);
+    ASSERT_EQ(random.random(1000000U), 893110U);
+    ASSERT_EQ(random.num_draws(), 13);
+}
+
+TEST(Random, RandomDoubleIsInRange) {
+    for (const auto algorithm : { RandomAlgorithm::MersenneTwister, RandomAlgorithm::Xoshiro256 }) {
+        auto random = Random{ 1234, algorithm };
+        for (usize i = 0; i < 1000; ++i) {
+            const auto value = random.random();
+            ASSERT_GE(value, 0.0);
+            ASSERT_LT(value, 1.0);
+        }
+    }
+}
+
+TEST(Random, CopyContinuesTheSameSequence) {
+    for (const auto algorithm : { RandomAlgorithm::MersenneTwister, RandomAlgorithm::Xoshiro256 }) {
+        auto random = Random{ 99, algorithm };
+        for (usize i = 0; i < 17; ++i) {
+            std::ignore = random.random(7);
+        }
+
+        auto copy = random;
+        for (usize i = 0; i < 100; ++i) {
+            ASSERT_EQ(random.random(1000), copy.random(1000));
+        }
+    }
+}
+
+TEST(Random, MersenneTwisterMatchesOldRecordings) {
+    // version 1 recordings were created with the generator and distributions of the standard library
+    auto expected_generator = std::mt19937_64{ 7 };
+    auto random = Random{ 7, RandomAlgorithm::MersenneTwister };
+
+    // restoring an older copy has to rewind the shared generator
+    const auto start = random;
+
+    for (usize i = 0; i < 200; ++i) {
+        auto distribution = std::uniform_int_distribution<int>{ 0, 6 };
+        ASSERT_EQ(random.random(7), distribution(expected_generator));
+    }
+
+    random = start;
+    expected_generator.seed(7);
+    for (usize i = 0; i < 200; ++i) {
+        auto distribution = std::uniform_int_distribution<int>{ 0, 6 };
+        ASSERT_EQ(random.random(7), distribution(expected_generator));
+    }
+}
+
+TEST(Random, SeedingResetsTheSequence) {
+    auto random = Random{ 5 };
+    const auto first = random.random(1000000);
+    std::ignore = random.random(1000000);
+
+    random.seed(5);
+    ASSERT_EQ(random.num_draws(), 0);
+    ASSERT_EQ(random.random(1000000), first);
+}
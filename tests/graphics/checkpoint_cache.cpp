@@ -0,0 +1,106 @@
+#include "game/checkpoint_cache.hpp"
+
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+    struct IdleInput final : input::GameInput {
+        IdleInput() : GameInput{ input::GameInputType::Keyboard } { }
+
+        [[nodiscard]] std::optional<input::MenuEvent> get_menu_event(const SDL_Event& /*event*/) const override {
+            return std::nullopt;
+        }
+
+        [[nodiscard]] std::string describe_menu_event(input::MenuEvent /*event*/) const override {
+            return "";
+        }
+
+        [[nodiscard]] const input::Input* underlying_input() const override {
+            return nullptr;
+        }
+    };
+
+    std::vector<std::optional<input::GameInputCommand>> random_commands(const usize num_steps, const u32 seed) {
+        std::mt19937 random{ seed };
+        std::vector<std::optional<input::GameInputCommand>> result{};
+        for (usize i = 0; i <= num_steps; ++i) {
+            result.push_back(
+                    random() % 6 == 0 ? std::optional{ static_cast<input::GameInputCommand>(random() % 5) }
+                                      : std::nullopt
+            );
+        }
+        return result;
+    }
+
+    void simulate(
+            SimulatedTetrion& tetrion,
+            const std::vector<std::optional<input::GameInputCommand>>& commands,
+            const SimulationStep first_step,
+            const SimulationStep last_step,
+            CheckpointCache* cache = nullptr
+    ) {
+        const auto input = IdleInput{};
+        for (auto step = first_step; step <= last_step; ++step) {
+            if (const auto& command = commands.at(step); command.has_value()) {
+                tetrion.handle_input_command(command.value(), step);
+            }
+            tetrion.update_step(step);
+            if (cache != nullptr) {
+                cache->save(tetrion, input, step);
+            }
+        }
+    }
+
+} // namespace
+
+
+TEST(CheckpointCache, ResumesFromCheckpoint) {
+    constexpr SimulationStep num_steps = 600;
+    const auto commands = random_commands(num_steps, 3);
+
+    auto tetrion = SimulatedTetrion{ 0, 1234, 0, nullptr, std::nullopt };
+    tetrion.spawn_next_tetromino(0);
+    auto cache = CheckpointCache{ usize{ 1024 } * 1024 };
+    simulate(tetrion, commands, 1, num_steps, &cache);
+
+    // one checkpoint every interval, from the first saved step on
+    ASSERT_EQ(cache.size(), 10);
+
+    const auto checkpoint = cache.newest_before(300);
+    ASSERT_TRUE(checkpoint.has_value());
+    ASSERT_EQ(checkpoint->simulation_step_index, 241);
+    ASSERT_FALSE(cache.newest_before(0).has_value());
+
+    auto resumed = SimulatedTetrion{ 0, 1234, 0, nullptr, std::nullopt };
+    resumed.restore_state(checkpoint->state.tetrion);
+    simulate(resumed, commands, checkpoint->simulation_step_index + 1, num_steps, &cache);
+
+    ASSERT_EQ(resumed.state_hash(), tetrion.state_hash());
+    ASSERT_EQ(cache.size(), 10);
+}
+
+TEST(CheckpointCache, StaysDenseAroundThePlayhead) {
+    constexpr SimulationStep num_steps = 6000;
+    constexpr SimulationStep interval = 10;
+    const auto commands = random_commands(num_steps, 4);
+
+    auto tetrion = SimulatedTetrion{ 0, 1234, 0, nullptr, std::nullopt };
+    tetrion.spawn_next_tetromino(0);
+    auto cache = CheckpointCache{ 40 * CheckpointCache::bytes_per_checkpoint(), interval };
+    simulate(tetrion, commands, 1, num_steps, &cache);
+
+    ASSERT_EQ(cache.capacity(), 40);
+    ASSERT_EQ(cache.size(), 40);
+
+    // the last checkpoints are still there
+    for (SimulationStep step = num_steps; step > num_steps - 8 * interval; step -= interval) {
+        const auto checkpoint = cache.newest_before(step);
+        ASSERT_TRUE(checkpoint.has_value());
+        ASSERT_GT(checkpoint->simulation_step_index + interval, step);
+    }
+
+    // further away the gaps grow, but the start of the replay is still covered
+    const auto oldest = cache.newest_before(num_steps / 10);
+    ASSERT_TRUE(oldest.has_value());
+}
@@ -0,0 +1,100 @@
+#include "game/piece_sequence.hpp"
+#include "game/simulated_tetrion.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+
+TEST(PieceSequence, EveryBagHoldsEachTypeOnce) {
+    for (const auto algorithm : { RandomAlgorithm::MersenneTwister, RandomAlgorithm::Xoshiro256 }) {
+        const auto types = PieceSequence::generate(1234, algorithm, PieceSequence::bag_size * 50);
+        ASSERT_EQ(types.size(), PieceSequence::bag_size * 50);
+
+        for (usize bag = 0; bag < 50; ++bag) {
+            auto sorted = std::vector(
+                    types.begin() + static_cast<std::ptrdiff_t>(bag * PieceSequence::bag_size),
+                    types.begin() + static_cast<std::ptrdiff_t>((bag + 1) * PieceSequence::bag_size)
+            );
+            std::ranges::sort(sorted);
+            for (usize i = 0; i < PieceSequence::bag_size; ++i) {
+                ASSERT_EQ(sorted.at(i), static_cast<helper::TetrominoType>(i));
+            }
+        }
+    }
+}
+
+TEST(PieceSequence, CacheMatchesBulkGeneration) {
+    const auto expected = PieceSequence::generate(77, RandomAlgorithm::Xoshiro256, 1000);
+
+    auto sequence = PieceSequence{ 77, RandomAlgorithm::Xoshiro256 };
+    ASSERT_EQ(sequence.at(3), expected.at(3));
+
+    const auto types = sequence.get(500, 500);
+    ASSERT_TRUE(std::ranges::equal(types, std::span{ expected }.subspan(500)));
+    ASSERT_GE(sequence.num_generated(), 1000);
+
+    for (usize i = 0; i < 1000; ++i) {
+        ASSERT_EQ(sequence.at(i), expected.at(i));
+    }
+}
+
+TEST(PieceSequence, TetrionSpawnsTheSequence) {
+    constexpr Random::Seed seed = 4242;
+    const auto expected = PieceSequence::generate(seed, RandomAlgorithm::Xoshiro256, 100);
+
+    auto tetrion = SimulatedTetrion{ 0, seed, 0, nullptr, std::nullopt };
+    tetrion.spawn_next_tetromino(0);
+
+    ASSERT_TRUE(std::ranges::equal(
+            tetrion.preview_tetromino_types(),
+            std::span{ expected }.subspan(1, TetrionState::num_preview_tetrominos)
+    ));
+    ASSERT_TRUE(std::ranges::equal(tetrion.upcoming_tetromino_types(99), std::span{ expected }.subspan(1)));
+
+    for (usize i = 0; i < 50; ++i) {
+        ASSERT_EQ(tetrion.state().active_tetromino->type(), expected.at(i));
+        tetrion.spawn_next_tetromino(0);
+    }
+}
+
+TEST(PieceSequence, CacheOnlyKeepsAWindow) {
+    constexpr Random::Seed seed = 99;
+    constexpr usize num_pieces = 20000;
+    constexpr usize lookahead = TetrionState::num_preview_tetrominos + 1;
+    const auto expected = PieceSequence::generate(seed, RandomAlgorithm::Xoshiro256, num_pieces + lookahead);
+
+    // the same access pattern as spawning in a tetrion
+    auto sequence = PieceSequence{ seed, RandomAlgorithm::Xoshiro256 };
+    for (u64 position = 0; position < num_pieces; ++position) {
+        ASSERT_EQ(sequence.get(position, lookahead).front(), expected.at(position));
+        sequence.discard_before(position + 1);
+        ASSERT_LE(sequence.num_cached(), PieceSequence::max_cached_without_lookahead + lookahead);
+    }
+    ASSERT_GE(sequence.num_generated(), num_pieces);
+
+    // going back before the cached window starts the sequence again
+    ASSERT_EQ(sequence.at(3), expected.at(3));
+    ASSERT_EQ(sequence.at(num_pieces - 1), expected.at(num_pieces - 1));
+}
+
+TEST(PieceSequence, TetrionRestoresAnEarlierPosition) {
+    constexpr Random::Seed seed = 99;
+    const auto expected = PieceSequence::generate(seed, RandomAlgorithm::Xoshiro256, 2000);
+
+    auto tetrion = SimulatedTetrion{ 0, seed, 0, nullptr, std::nullopt };
+    tetrion.spawn_next_tetromino(0);
+    const auto initial_state = tetrion.state();
+
+    for (usize i = 1; i < 1000; ++i) {
+        tetrion.spawn_next_tetromino(0);
+        ASSERT_EQ(tetrion.state().active_tetromino->type(), expected.at(i));
+    }
+
+    tetrion.restore_state(initial_state);
+    ASSERT_TRUE(std::ranges::equal(
+            tetrion.preview_tetromino_types(),
+            std::span{ expected }.subspan(1, TetrionState::num_preview_tetrominos)
+    ));
+}
@@ -0,0 +1,404 @@
+#include "utils/helper.hpp"
+
+#include <recordings/recordings.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <optional>
+#include <variant>
+
+namespace {
+
+    void write_recording(const std::filesystem::path& path) {
+        std::vector<recorder::TetrionHeader> headers{};
+        headers.emplace_back(17, 3);
+        headers.emplace_back(18, 4);
+
+        auto writer = std::move(
+                recorder::RecordingWriter::get_writer(path, std::move(headers), recorder::AdditionalInformation{}, true)
+                        .value()
+        );
+
+        std::ignore = writer.add_record(0, 5, InputEvent::RotateLeftPressed);
+        std::ignore = writer.add_state_hash(1, 60, 0x0123456789ABCDEFULL);
+        std::ignore = writer.add_keyframe(1, 60, { 'a', 'b', 'c' });
+        std::ignore = writer.add_record(1, 1ULL << 40U, InputEvent::HoldReleased);
+    }
+
+} // namespace
+
+TEST(RecordingStream, DecodesEveryEntry) {
+    auto path = std::filesystem::temp_directory_path() / "oopetris_recording_stream_test.rec";
+    write_recording(path);
+
+    auto maybe_stream = recorder::RecordingStream::from_path(path);
+    ASSERT_THAT(maybe_stream, ExpectedHasValue());
+    auto stream = std::move(maybe_stream.value());
+    ASSERT_EQ(stream.tetrion_headers().size(), 2);
+    ASSERT_EQ(stream.tetrion_headers().at(1).seed, 18);
+
+    std::vector<recorder::RecordingStream::Entry> entries{};
+    for (const auto& entry : stream) {
+        entries.push_back(entry);
+    }
+    ASSERT_FALSE(stream.error().has_value()) << stream.error().value();
+    ASSERT_EQ(entries.size(), 4);
+
+    const auto& first = std::get<recorder::Record>(entries.at(0));
+    ASSERT_EQ(first.tetrion_index, 0);
+    ASSERT_EQ(first.simulation_step_index, 5);
+    ASSERT_EQ(first.event, InputEvent::RotateLeftPressed);
+
+    const auto& state_hash = std::get<recorder::StateHash>(entries.at(1));
+    ASSERT_EQ(state_hash.hash, 0x0123456789ABCDEFULL);
+
+    const auto& keyframe = std::get<TetrionKeyframe>(entries.at(2));
+    ASSERT_EQ(keyframe.state(), (std::vector<char>{ 'a', 'b', 'c' }));
+
+    ASSERT_EQ(recorder::tetrion_index_of(entries.at(3)), 1);
+    ASSERT_EQ(recorder::simulation_step_index_of(entries.at(3)), 1ULL << 40U);
+
+    std::filesystem::remove(path);
+}
+
+TEST(RecordingStream, TruncatedBlockIsAnError) {
+    auto path = std::filesystem::temp_directory_path() / "oopetris_recording_stream_truncated_test.rec";
+    write_recording(path);
+
+    const auto read_entries = [&path]() {
+        auto stream = std::move(recorder::RecordingStream::from_path(path).value());
+        usize num_entries = 0;
+        while (stream.next().has_value()) {
+            ++num_entries;
+        }
+        return std::pair{ num_entries, stream.error() };
+    };
+
+    const auto block_offset = recorder::RecordingStream::from_path(path)->block_index().at(0).offset;
+
+    // without the end of the index, the block is still found
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    ASSERT_TRUE(recorder::RecordingStream::from_path(path)->block_index().empty());
+    const auto [num_entries, error] = read_entries();
+    ASSERT_EQ(num_entries, 4);
+    ASSERT_FALSE(error.has_value());
+
+    // cut off the compressed entries
+    std::filesystem::resize_file(path, block_offset + recorder::block::header_size + 1);
+    const auto [num_truncated_entries, truncated_error] = read_entries();
+    ASSERT_EQ(num_truncated_entries, 0);
+    ASSERT_EQ(truncated_error, "invalid block while reading recorded game");
+
+    const auto reader = recorder::RecordingReader::from_path(path);
+    ASSERT_THAT(reader, ExpectedHasError());
+
+    std::filesystem::remove(path);
+}
+
+TEST(RecordingStream, BlockIndexAllowsSkippingAndParallelDecoding) {
+    auto path = std::filesystem::temp_directory_path() / "oopetris_recording_stream_block_index_test.rec";
+
+    constexpr usize num_records = 1000;
+    constexpr usize records_per_block = 100;
+    {
+        std::vector<recorder::TetrionHeader> headers{};
+        headers.emplace_back(1, 0);
+        auto writer = std::move(recorder::RecordingWriter::get_writer(
+                                        path, std::move(headers), recorder::AdditionalInformation{}, false,
+                                        recorder::DurabilityPolicy{ .flush_after_entries = records_per_block }
+        )
+                                        .value());
+
+        for (usize i = 0; i < num_records; ++i) {
+            std::ignore = writer.add_record(0, i * 2, InputEvent::MoveRightPressed);
+        }
+    }
+
+    auto stream = std::move(recorder::RecordingStream::from_path(path).value());
+    const auto& blocks = stream.block_index();
+    ASSERT_EQ(blocks.size(), num_records / records_per_block);
+    for (usize i = 0; i < blocks.size(); ++i) {
+        ASSERT_EQ(blocks.at(i).first_simulation_step, i * records_per_block * 2);
+        ASSERT_EQ(blocks.at(i).last_simulation_step, (((i + 1) * records_per_block) - 1) * 2);
+    }
+
+    // step 1001 is in the block, that starts at 1000
+    stream.skip_to(1001);
+    const auto* first_entry = stream.peek();
+    ASSERT_NE(first_entry, nullptr);
+    ASSERT_EQ(recorder::simulation_step_index_of(*first_entry), 1000);
+
+    const auto parallel_reader = recorder::RecordingReader::from_path(path, 4);
+    ASSERT_THAT(parallel_reader, ExpectedHasValue());
+    ASSERT_EQ(parallel_reader->num_records(), num_records);
+    for (usize i = 0; i < num_records; ++i) {
+        ASSERT_EQ(parallel_reader->at(i).simulation_step_index, i * 2);
+        ASSERT_EQ(parallel_reader->at(i).event, InputEvent::MoveRightPressed);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(RecordingStream, BlockIndexThatDoesntChainIsIgnored) {
+    auto path = std::filesystem::temp_directory_path() / "oopetris_recording_stream_broken_index_test.rec";
+
+    constexpr usize num_records = 300;
+    {
+        std::vector<recorder::TetrionHeader> headers{};
+        headers.emplace_back(1, 0);
+        auto writer = std::move(recorder::RecordingWriter::get_writer(
+                                        path, std::move(headers), recorder::AdditionalInformation{}, false,
+                                        recorder::DurabilityPolicy{ .flush_after_entries = 100 }
+        )
+                                        .value());
+
+        for (usize i = 0; i < num_records; ++i) {
+            std::ignore = writer.add_record(0, i, InputEvent::MoveLeftPressed);
+        }
+    }
+
+    const auto blocks = recorder::RecordingStream::from_path(path)->block_index();
+    ASSERT_EQ(blocks.size(), 3);
+
+    // let the second entry of the index point to the third block, so that the second block would be skipped
+    {
+        const auto entry_position = std::filesystem::file_size(path) - recorder::block::trailer_size
+                                    - (2 * recorder::block::index_entry_size);
+        std::fstream file{ path, std::ios::in | std::ios::out | std::ios::binary };
+        file.seekp(static_cast<std::streamoff>(entry_position));
+        const auto offset = blocks.at(2).offset;
+        for (usize i = 0; i < sizeof(offset); ++i) {
+            file.put(static_cast<char>((offset >> (i * 8U)) & 0xFFU));
+        }
+    }
+
+    ASSERT_TRUE(recorder::RecordingStream::from_path(path)->block_index().empty());
+
+    // without an index the blocks are decoded one after the other, so nothing is lost
+    const auto reader = recorder::RecordingReader::from_path(path, 4);
+    ASSERT_THAT(reader, ExpectedHasValue());
+    ASSERT_EQ(reader->num_records(), num_records);
+    for (usize i = 0; i < num_records; ++i) {
+        ASSERT_EQ(reader->at(i).simulation_step_index, i);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(RecordingWriter, FlushMakesEntriesReadable) {
+    auto path = std::filesystem::temp_directory_path() / "oopetris_recording_writer_flush_test.rec";
+
+    std::vector<recorder::TetrionHeader> headers{};
+    headers.emplace_back(1, 0);
+    auto writer = std::move(
+            recorder::RecordingWriter::get_writer(path, std::move(headers), recorder::AdditionalInformation{}).value()
+    );
+
+    const auto count_records = [&path]() {
+        auto stream = std::move(recorder::RecordingStream::from_path(path).value());
+        usize result = 0;
+        while (stream.next().has_value()) {
+            ++result;
+        }
+        EXPECT_FALSE(stream.error().has_value());
+        return result;
+    };
+
+    for (u64 simulation_step_index = 0; simulation_step_index < 100; ++simulation_step_index) {
+        ASSERT_TRUE(writer.add_record(0, simulation_step_index, InputEvent::MoveLeftPressed).has_value());
+    }
+    // far less than a block, so nothing is written before the flush
+    ASSERT_EQ(count_records(), 0);
+
+    ASSERT_TRUE(writer.flush(true).has_value());
+    ASSERT_EQ(count_records(), 100);
+
+    ASSERT_TRUE(writer.add_record(0, 100, InputEvent::MoveLeftReleased).has_value());
+    ASSERT_TRUE(writer.game_over().has_value());
+    ASSERT_TRUE(writer.flush().has_value());
+    ASSERT_EQ(count_records(), 101);
+
+    std::filesystem::remove(path);
+}
+
+TEST(RecordingWriter, RecordsAreCompact) {
+    auto path = std::filesystem::temp_directory_path() / "oopetris_recording_writer_compact_test.rec";
+
+    constexpr usize num_records = 1000;
+    usize header_size = 0;
+    {
+        std::vector<recorder::TetrionHeader> headers{};
+        headers.emplace_back(1, 0);
+        headers.emplace_back(2, 0);
+        auto writer = std::move(
+                recorder::RecordingWriter::get_writer(path, std::move(headers), recorder::AdditionalInformation{})
+                        .value()
+        );
+        header_size = std::filesystem::file_size(path);
+
+        for (usize i = 0; i < num_records; ++i) {
+            const auto tetrion_index = static_cast<u8>(i % 2);
+            std::ignore = writer.add_record(tetrion_index, i * 20, InputEvent::DropPressed);
+        }
+        // a step before the previous one can't be stored as difference
+        std::ignore = writer.add_record(0, 5, InputEvent::DropReleased);
+    }
+
+    // the magic byte, the packed byte and a one byte step difference, except for the full record at the end, before
+    // the block is compressed
+    const auto block_offset = recorder::RecordingStream::from_path(path)->block_index().at(0).offset;
+    ASSERT_EQ(block_offset, header_size);
+    std::ifstream file{ path, std::ios::in | std::ios::binary };
+    file.seekg(static_cast<std::streamoff>(block_offset + 1));
+    ASSERT_EQ(helper::reader::read_integral_from_file<u32>(file), 3 * num_records + 11);
+    file.close();
+    ASSERT_LT(std::filesystem::file_size(path) - header_size, 3 * num_records + 11);
+
+    const auto reader = recorder::RecordingReader::from_path(path);
+    ASSERT_THAT(reader, ExpectedHasValue());
+    ASSERT_EQ(reader->num_records(), num_records + 1);
+    for (usize i = 0; i < num_records; ++i) {
+        ASSERT_EQ(reader->at(i).tetrion_index, i % 2);
+        ASSERT_EQ(reader->at(i).simulation_step_index, i * 20);
+        ASSERT_EQ(reader->at(i).event, InputEvent::DropPressed);
+    }
+    ASSERT_EQ(reader->at(num_records).simulation_step_index, 5);
+    ASSERT_EQ(reader->at(num_records).event, InputEvent::DropReleased);
+
+    std::filesystem::remove(path);
+}
+
+TEST(BlockCodec, RoundTrip) {
+    std::vector<std::byte> input{};
+    // incompressible, repeating and long runs, that overlap with their own output
+    for (usize i = 0; i < 3000; ++i) {
+        input.push_back(static_cast<std::byte>((i * 7919U) ^ (i >> 3U)));
+    }
+    for (usize i = 0; i < 5000; ++i) {
+        input.push_back(static_cast<std::byte>(i % 13));
+    }
+    input.insert(input.end(), 1000, std::byte{ 0x2A });
+
+    for (const auto size : { usize{ 0 }, usize{ 3 }, usize{ 100 }, input.size() }) {
+        const auto data = std::span{ input }.first(size);
+        const auto compressed = helper::block_codec::compress(data);
+
+        std::vector<std::byte> output{};
+        ASSERT_TRUE(helper::block_codec::decompress(compressed, size, output).has_value());
+        ASSERT_TRUE(std::ranges::equal(output, data));
+    }
+
+    const auto compressed = helper::block_codec::compress(input);
+    ASSERT_LT(compressed.size(), input.size() / 2);
+
+    std::vector<std::byte> output{};
+    ASSERT_FALSE(helper::block_codec::decompress(compressed, input.size() - 1, output).has_value());
+    ASSERT_FALSE(helper::block_codec::decompress(compressed, input.size() + 1, output).has_value());
+    ASSERT_FALSE(
+            helper::block_codec::decompress(std::span{ compressed }.first(compressed.size() - 1), input.size(), output)
+                    .has_value()
+    );
+}
+
+TEST(SharedRecordingStream, HandsOutTheEntriesOfEachTetrion) {
+    auto path = std::filesystem::temp_directory_path() / "oopetris_shared_recording_stream_test.rec";
+    write_recording(path);
+
+    auto maybe_stream = recorder::SharedRecordingStream::from_path(path);
+    ASSERT_THAT(maybe_stream, ExpectedHasValue());
+    auto stream = std::move(maybe_stream.value());
+    ASSERT_EQ(stream.tetrion_headers().size(), 2);
+
+    // the entries of tetrion 0 come after the first one of tetrion 1, they are kept until they are asked for
+    const auto first = stream.next(1);
+    ASSERT_TRUE(first.has_value());
+    ASSERT_EQ(std::get<recorder::StateHash>(first.value()).simulation_step_index, 60);
+
+    const auto record = stream.next(0);
+    ASSERT_TRUE(record.has_value());
+    ASSERT_EQ(std::get<recorder::Record>(record.value()).event, InputEvent::RotateLeftPressed);
+    ASSERT_FALSE(stream.has_unread_records(0));
+    ASSERT_FALSE(stream.next(0).has_value());
+    ASSERT_TRUE(stream.has_unread_records(1));
+
+    ASSERT_TRUE(std::holds_alternative<TetrionKeyframe>(stream.next(1).value()));
+    ASSERT_EQ(recorder::simulation_step_index_of(stream.next(1).value()), 1ULL << 40U);
+    ASSERT_FALSE(stream.has_unread_records(1));
+    ASSERT_FALSE(stream.next(1).has_value());
+    ASSERT_FALSE(stream.error().has_value());
+
+    std::filesystem::remove(path);
+}
+
+TEST(SharedRecordingStream, DoesntReadAheadAfterTheLastEntryOfATetrion) {
+    auto path = std::filesystem::temp_directory_path() / "oopetris_shared_recording_stream_end_test.rec";
+
+    // more entries of tetrion 1 than the stream keeps pending for a reader
+    constexpr usize num_records = 70000;
+    const auto write_records = [&path](const std::optional<SimulationStep> last_step_of_first_tetrion) {
+        std::vector<recorder::TetrionHeader> headers{};
+        headers.emplace_back(1, 0);
+        headers.emplace_back(2, 0);
+        auto writer = std::move(
+                recorder::RecordingWriter::get_writer(path, std::move(headers), recorder::AdditionalInformation{}, false)
+                        .value()
+        );
+
+        std::ignore = writer.add_record(0, 0, InputEvent::MoveLeftPressed);
+        for (usize i = 1; i <= num_records; ++i) {
+            std::ignore = writer.add_record(1, i, InputEvent::MoveRightPressed);
+        }
+        if (last_step_of_first_tetrion.has_value()) {
+            std::ignore = writer.add_record(0, last_step_of_first_tetrion.value(), InputEvent::MoveLeftReleased);
+        }
+    };
+
+    {
+        write_records(std::nullopt);
+        auto stream = std::move(recorder::SharedRecordingStream::from_path(path).value());
+
+        ASSERT_TRUE(stream.next(0).has_value());
+        ASSERT_FALSE(stream.has_unread_records(0));
+        ASSERT_FALSE(stream.next(0).has_value());
+        ASSERT_FALSE(stream.error().has_value()) << stream.error().value();
+    }
+
+    {
+        // the last entry of tetrion 0 is only found after every entry of tetrion 1
+        write_records(num_records + 1);
+        auto stream = std::move(recorder::SharedRecordingStream::from_path(path).value());
+
+        ASSERT_TRUE(stream.next(0).has_value());
+        ASSERT_FALSE(stream.next(0).has_value());
+        ASSERT_TRUE(stream.error().has_value());
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(RecordingReader, FindsTheEntriesOfATetrionAfterAStep) {
+    auto path = std::filesystem::temp_directory_path() / "oopetris_recording_reader_index_test.rec";
+    write_recording(path);
+
+    auto maybe_reader = recorder::RecordingReader::from_path(path);
+    ASSERT_THAT(maybe_reader, ExpectedHasValue());
+    const auto& reader = maybe_reader.value();
+    ASSERT_EQ(reader.num_records(), 2);
+
+    ASSERT_EQ(reader.next_record_index(0, 4), 0);
+    ASSERT_EQ(reader.next_record_index(0, 5), reader.num_records());
+    ASSERT_EQ(reader.next_record_index(1, 0), 1);
+    ASSERT_EQ(reader.next_record_index(1, 1ULL << 40U), reader.num_records());
+    ASSERT_EQ(reader.next_record_index(7, 0), reader.num_records());
+
+    ASSERT_EQ(reader.next_state_hash_index(1, 59), 0);
+    ASSERT_EQ(reader.next_state_hash_index(1, 60), reader.state_hashes().size());
+    ASSERT_EQ(reader.next_state_hash_index(0, 0), reader.state_hashes().size());
+    ASSERT_EQ(reader.next_snapshot_index(0, 0), reader.snapshots().size());
+
+    ASSERT_EQ(reader.last_record_step(0), 5);
+    ASSERT_EQ(reader.last_record_step(1), 1ULL << 40U);
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,85 @@
+#include "game/rollback_buffer.hpp"
+#include "utils/helper.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+    std::vector<std::optional<input::GameInputCommand>> random_commands(const usize num_steps, const u32 seed) {
+        std::mt19937 random{ seed };
+        std::vector<std::optional<input::GameInputCommand>> result{};
+        for (usize i = 0; i <= num_steps; ++i) {
+            result.push_back(
+                    random() % 6 == 0 ? std::optional{ static_cast<input::GameInputCommand>(random() % 5) }
+                                      : std::nullopt
+            );
+        }
+        return result;
+    }
+
+    void simulate(
+            SimulatedTetrion& tetrion,
+            const std::vector<std::optional<input::GameInputCommand>>& commands,
+            const SimulationStep first_step,
+            const SimulationStep last_step,
+            RollbackBuffer* buffer = nullptr
+    ) {
+        for (auto step = first_step; step <= last_step; ++step) {
+            if (const auto& command = commands.at(step); command.has_value()) {
+                tetrion.handle_input_command(command.value(), step);
+            }
+            tetrion.update_step(step);
+            if (buffer != nullptr) {
+                buffer->save(tetrion, step);
+            }
+        }
+    }
+
+} // namespace
+
+
+TEST(RollbackBuffer, ResimulatesCorrectedInputs) {
+    constexpr SimulationStep num_steps = 600;
+
+    const auto commands = random_commands(num_steps, 1);
+    auto corrected_commands = commands;
+    corrected_commands.at(450) = input::GameInputCommand::Drop;
+
+    auto expected = SimulatedTetrion{ 0, 1234, 0, nullptr, std::nullopt };
+    expected.spawn_next_tetromino(0);
+    simulate(expected, corrected_commands, 1, num_steps);
+
+    auto tetrion = SimulatedTetrion{ 0, 1234, 0, nullptr, std::nullopt };
+    tetrion.spawn_next_tetromino(0);
+    auto buffer = RollbackBuffer{ 100, 4 };
+    simulate(tetrion, commands, 1, num_steps, &buffer);
+
+    ASSERT_NE(tetrion.state_hash(), expected.state_hash());
+    ASSERT_EQ(buffer.size(), 100);
+    ASSERT_EQ(buffer.newest_step(), 600);
+    ASSERT_EQ(buffer.oldest_step(), 204);
+
+    // the corrected input arrives late, so everything from step 450 on has to be simulated again
+    const auto restored_step = buffer.rollback_to(tetrion, 449);
+    ASSERT_THAT(restored_step, ExpectedHasValue());
+    ASSERT_EQ(restored_step.value(), 448);
+    ASSERT_EQ(buffer.newest_step(), 448);
+
+    simulate(tetrion, corrected_commands, restored_step.value() + 1, num_steps, &buffer);
+
+    ASSERT_EQ(tetrion.state_hash(), expected.state_hash());
+    ASSERT_EQ(buffer.newest_step(), 600);
+}
+
+TEST(RollbackBuffer, TooOldStep) {
+    auto tetrion = SimulatedTetrion{ 0, 1234, 0, nullptr, std::nullopt };
+    tetrion.spawn_next_tetromino(0);
+    auto buffer = RollbackBuffer{ 10 };
+    simulate(tetrion, random_commands(50, 2), 1, 50, &buffer);
+
+    const auto result = buffer.rollback_to(tetrion, 20);
+    ASSERT_THAT(result, ExpectedHasError());
+    ASSERT_EQ(result.error(), "can't roll back to step 20, the oldest saved state is from step 41");
+}
@@ -0,0 +1,53 @@
+#include "game/tetrion_batch.hpp"
+
+#include <gtest/gtest.h>
+#include <random>
+
+
+TEST(TetrionBatch, MatchesIndividualTetrions) {
+    constexpr usize num_games = 200;
+
+    std::vector<Random::Seed> seeds{};
+    std::vector<SimulatedTetrion> expected{};
+    expected.reserve(num_games);
+    for (usize i = 0; i < num_games; ++i) {
+        seeds.push_back(static_cast<Random::Seed>(i * 31 + 7));
+        expected.emplace_back(0, seeds.back(), 0, nullptr, std::nullopt).spawn_next_tetromino(0);
+    }
+
+    auto moved_from = TetrionBatch{ seeds, 0, 4 };
+    ASSERT_EQ(moved_from.size(), num_games);
+    moved_from.step(std::vector<TetrionBatch::Command>(num_games));
+
+    // the worker threads are already running and have to keep working after the move
+    auto batch = std::move(moved_from);
+
+    std::mt19937 random{ 42 }; // NOLINT(cert-msc32-c,cert-msc51-cpp)
+    std::vector<TetrionBatch::Command> commands(num_games);
+    for (auto& tetrion : expected) {
+        tetrion.update_step(1);
+    }
+    for (SimulationStep step = 2; step <= 2000; ++step) {
+        for (auto& command : commands) {
+            command = (random() % 8 == 0 ? std::optional{ static_cast<input::GameInputCommand>(random() % 8) }
+                                         : std::nullopt);
+        }
+
+        batch.step(commands);
+
+        for (usize i = 0; i < num_games; ++i) {
+            if (expected.at(i).is_game_over()) {
+                continue;
+            }
+            if (commands.at(i).has_value()) {
+                expected.at(i).handle_input_command(commands.at(i).value(), step);
+            }
+            expected.at(i).update_step(step);
+        }
+    }
+
+    ASSERT_EQ(batch.simulation_step_index(), 2000);
+    for (usize i = 0; i < num_games; ++i) {
+        ASSERT_EQ(batch.at(i).state_hash(), expected.at(i).state_hash()) << "game " << i;
+    }
+}
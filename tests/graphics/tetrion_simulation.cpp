@@ -1,10 +1,14 @@
 
 
+#include "game/keyframe.hpp"
 #include "game/simulation.hpp"
 #include "utils/helper.hpp"
 
 #include <gmock/gmock.h>
+#include <algorithm>
 #include <gtest/gtest.h>
+#include <limits>
+#include <random>
 
 
 TEST(Simulation, InvalidFilePath) {
@@ -30,3 +34,415 @@ TEST(Simulation, ValidRecordingsFile) {
     ASSERT_THAT(maybe_simulation, ExpectedHasValue())
             << "Path was: " << path << "\nError: " << maybe_simulation.error();
 }
+
+namespace {
+
+    struct FeedInput final : input::GameInput {
+        FeedInput() : GameInput{ input::GameInputType::Keyboard } { }
+
+        void feed(const InputEvent event, const SimulationStep simulation_step_index) {
+            handle_event(event, simulation_step_index);
+        }
+
+        [[nodiscard]] std::optional<input::MenuEvent> get_menu_event(const SDL_Event& /*event*/) const override {
+            return std::nullopt;
+        }
+
+        [[nodiscard]] std::string describe_menu_event(input::MenuEvent /*event*/) const override {
+            return "";
+        }
+
+        [[nodiscard]] const input::Input* underlying_input() const override {
+            return nullptr;
+        }
+    };
+
+    // plays one game per seed with random inputs and records them with keyframes, returns the last simulated steps
+    std::vector<SimulationStep>
+    record_random_games(const std::filesystem::path& path, const std::vector<Random::Seed>& seeds) {
+        std::vector<recorder::TetrionHeader> headers{};
+        for (const auto seed : seeds) {
+            headers.emplace_back(seed, 0);
+        }
+
+        auto maybe_writer =
+                recorder::RecordingWriter::get_writer(path, std::move(headers), recorder::AdditionalInformation{});
+        EXPECT_THAT(maybe_writer, ExpectedHasValue());
+        const auto writer = std::make_shared<recorder::RecordingWriter>(std::move(maybe_writer.value()));
+
+        std::vector<SimulationStep> result{};
+
+        // the games are played one after another, so the records of different tetrions aren't sorted by step
+        for (u8 tetrion_index = 0; tetrion_index < static_cast<u8>(seeds.size()); ++tetrion_index) {
+            const auto seed = seeds.at(tetrion_index);
+            auto tetrion = SimulatedTetrion{ tetrion_index, seed, 0, nullptr, writer };
+            tetrion.spawn_next_tetromino(0);
+
+            FeedInput input{};
+            input.set_target_tetrion(&tetrion);
+            input.set_event_callback([&writer, tetrion_index](
+                                             const InputEvent event, const SimulationStep simulation_step_index
+                                     ) { std::ignore = writer->add_record(tetrion_index, simulation_step_index, event); }
+            );
+
+            std::mt19937 random{ static_cast<u32>(seed) };
+            std::array<bool, 5> pressed{};
+
+            SimulationStep simulation_step_index = 0;
+            while (simulation_step_index < 4 * keyframe::interval and not tetrion.is_game_over()) {
+                ++simulation_step_index;
+                if (random() % 30 == 0) {
+                    // only moves and rotations, so that the game lasts long enough
+                    const auto key = static_cast<u8>(random() % pressed.size());
+                    input.feed(static_cast<InputEvent>(pressed.at(key) ? key + 7 : key), simulation_step_index);
+                    pressed.at(key) = not pressed.at(key);
+                }
+                input.update(simulation_step_index);
+                tetrion.update_step(simulation_step_index);
+                input.late_update(simulation_step_index);
+                tetrion.dispatch_events();
+
+                if (simulation_step_index % keyframe::interval == 0) {
+                    std::ignore = writer->add_keyframe(
+                            tetrion_index, simulation_step_index, keyframe::to_bytes(tetrion, input)
+                    );
+                }
+            }
+
+            result.push_back(simulation_step_index);
+        }
+
+        return result;
+    }
+
+    u64 state_hash_by_stepping(std::filesystem::path path, const SimulationStep simulation_step_index) {
+        auto simulation = std::move(Simulation::get_replay_simulation(path).value());
+        while (simulation.simulation_step_index() < simulation_step_index and not simulation.is_game_finished()) {
+            simulation.update();
+        }
+        return simulation.tetrion().state_hash();
+    }
+
+} // namespace
+
+TEST(Simulation, SeekFromKeyframes) {
+    auto path = std::filesystem::temp_directory_path() / "oopetris_seek_test.rec";
+    const auto last_step = record_random_games(path, { 42 }).at(0);
+    ASSERT_GT(last_step, 2 * keyframe::interval);
+
+    const auto recording_reader = recorder::RecordingReader::from_path(path);
+    ASSERT_THAT(recording_reader, ExpectedHasValue());
+    ASSERT_EQ(recording_reader->keyframes().size(), last_step / keyframe::interval);
+
+    const auto* keyframe = recording_reader->keyframe_before(0, keyframe::interval + 1);
+    ASSERT_NE(keyframe, nullptr);
+    ASSERT_EQ(keyframe->simulation_step_index(), keyframe::interval);
+    ASSERT_EQ(recording_reader->keyframe_before(0, keyframe::interval - 1), nullptr);
+
+    // the replay ends with the last record
+    const auto last_record_step = recording_reader->records().back().simulation_step_index;
+
+    auto maybe_simulation = Simulation::get_replay_simulation(path);
+    ASSERT_THAT(maybe_simulation, ExpectedHasValue());
+    auto simulation = std::move(maybe_simulation.value());
+
+    // forwards, backwards to a keyframe, backwards before the first keyframe and forwards again
+    const auto targets = { last_record_step * 2 / 3, last_record_step / 2, keyframe::interval / 2, last_record_step };
+    for (const auto target : targets) {
+        simulation.seek(target);
+        ASSERT_EQ(simulation.simulation_step_index(), target);
+        ASSERT_EQ(simulation.tetrion().state_hash(), state_hash_by_stepping(path, target)) << "at step " << target;
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(Simulation, MultipleTetrionsInParallel) {
+    auto path = std::filesystem::temp_directory_path() / "oopetris_multiple_tetrions_test.rec";
+    const auto last_steps = record_random_games(path, { 1, 2, 3, 4, 5 });
+
+    auto maybe_simulation = Simulation::get_replay_simulation(path, 4);
+    ASSERT_THAT(maybe_simulation, ExpectedHasValue());
+    auto simulation = std::move(maybe_simulation.value());
+    ASSERT_EQ(simulation.num_tetrions(), 5);
+
+    auto sequential = std::move(Simulation::get_replay_simulation(path, 1).value());
+
+    simulation.simulate_to_end();
+    while (not sequential.is_game_finished()) {
+        sequential.update();
+    }
+
+    ASSERT_TRUE(simulation.is_game_finished());
+    ASSERT_EQ(simulation.simulation_step_index(), sequential.simulation_step_index());
+    ASSERT_LE(simulation.simulation_step_index(), *std::ranges::max_element(last_steps));
+    for (usize i = 0; i < simulation.num_tetrions(); ++i) {
+        ASSERT_EQ(simulation.tetrion(i).tetrion_index(), i);
+        ASSERT_EQ(simulation.tetrion(i).state_hash(), sequential.tetrion(i).state_hash()) << "tetrion " << i;
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(Simulation, StreamingReplayMatchesLoadedReplay) {
+    auto path = std::filesystem::temp_directory_path() / "oopetris_streaming_test.rec";
+    record_random_games(path, { 21, 22, 23 });
+
+    auto loaded = std::move(Simulation::get_replay_simulation(path, 1).value());
+    auto maybe_streamed = Simulation::get_streaming_replay_simulation(path);
+    ASSERT_THAT(maybe_streamed, ExpectedHasValue());
+    auto streamed = std::move(maybe_streamed.value());
+    ASSERT_EQ(streamed.num_tetrions(), 3);
+
+    loaded.simulate_to_end();
+    ASSERT_NO_THROW(streamed.simulate_to_end());
+
+    ASSERT_TRUE(streamed.is_game_finished());
+    for (usize i = 0; i < loaded.num_tetrions(); ++i) {
+        ASSERT_EQ(streamed.simulation_step_index(i), loaded.simulation_step_index(i)) << "tetrion " << i;
+        ASSERT_EQ(streamed.tetrion(i).state_hash(), loaded.tetrion(i).state_hash()) << "tetrion " << i;
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(Simulation, SeekToEndFromLastKeyframe) {
+    auto path = std::filesystem::temp_directory_path() / "oopetris_seek_to_end_test.rec";
+    record_random_games(path, { 7, 8 });
+
+    auto replayed = std::move(Simulation::get_replay_simulation(path, 1).value());
+    auto seeked = std::move(Simulation::get_replay_simulation(path, 1).value());
+
+    replayed.simulate_to_end();
+    seeked.seek(std::numeric_limits<SimulationStep>::max());
+
+    ASSERT_TRUE(seeked.is_game_finished());
+    for (usize i = 0; i < replayed.num_tetrions(); ++i) {
+        ASSERT_EQ(seeked.simulation_step_index(i), replayed.simulation_step_index(i)) << "tetrion " << i;
+        ASSERT_EQ(seeked.tetrion(i).state_hash(), replayed.tetrion(i).state_hash()) << "tetrion " << i;
+        ASSERT_GT(replayed.tetrion(i).num_locked_tetrominos(), 0);
+        ASSERT_EQ(seeked.tetrion(i).num_locked_tetrominos(), replayed.tetrion(i).num_locked_tetrominos());
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(Simulation, KeyframeThatDoesntMatchItsStateHashIsIgnored) {
+    auto path = std::filesystem::temp_directory_path() / "oopetris_keyframe_state_hash_test.rec";
+    auto tampered_path = std::filesystem::temp_directory_path() / "oopetris_keyframe_state_hash_tampered_test.rec";
+    record_random_games(path, { 9 });
+
+    const auto reader = std::move(recorder::RecordingReader::from_path(path).value());
+    const auto& keyframes = reader.keyframes();
+    ASSERT_GE(keyframes.size(), 2);
+
+    // the keyframe, that seeking to the end starts at, has the (valid) state of the first one, which isn't the state
+    // at its step
+    const auto* tampered_keyframe = reader.keyframe_before(0, reader.records().back().simulation_step_index);
+    ASSERT_NE(tampered_keyframe, nullptr);
+    ASSERT_NE(tampered_keyframe, &keyframes.front());
+    {
+        auto headers = reader.tetrion_headers();
+        auto writer = std::move(recorder::RecordingWriter::get_writer(
+                                        tampered_path, std::move(headers), recorder::AdditionalInformation{}, true
+        )
+                                        .value());
+        for (const auto& record : reader.records()) {
+            std::ignore = writer.add_record(record.tetrion_index, record.simulation_step_index, record.event);
+        }
+        for (const auto& state_hash : reader.state_hashes()) {
+            std::ignore =
+                    writer.add_state_hash(state_hash.tetrion_index, state_hash.simulation_step_index, state_hash.hash);
+        }
+        for (const auto& keyframe : keyframes) {
+            std::ignore = writer.add_keyframe(
+                    keyframe.tetrion_index(), keyframe.simulation_step_index(),
+                    &keyframe == tampered_keyframe ? keyframes.front().state() : keyframe.state()
+            );
+        }
+    }
+
+    auto replayed = std::move(Simulation::get_replay_simulation(path).value());
+    auto seeked = std::move(Simulation::get_replay_simulation(tampered_path).value());
+
+    replayed.simulate_to_end();
+    ASSERT_NO_THROW(seeked.seek(std::numeric_limits<SimulationStep>::max()));
+
+    ASSERT_TRUE(seeked.is_game_finished());
+    ASSERT_EQ(seeked.simulation_step_index(), replayed.simulation_step_index());
+    ASSERT_EQ(seeked.tetrion().state_hash(), replayed.tetrion().state_hash());
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(tampered_path);
+}
+
+TEST(Simulation, StateHashMismatchIsDetected) {
+    auto path = std::filesystem::temp_directory_path() / "oopetris_state_hash_test.rec";
+    auto tampered_path = std::filesystem::temp_directory_path() / "oopetris_state_hash_tampered_test.rec";
+    record_random_games(path, { 11 });
+
+    auto replayed = std::move(Simulation::get_replay_simulation(path).value());
+    ASSERT_NO_THROW(replayed.simulate_to_end());
+
+    const auto reader = std::move(recorder::RecordingReader::from_path(path).value());
+    const auto& state_hashes = reader.state_hashes();
+    ASSERT_GE(state_hashes.size(), 2);
+    ASSERT_EQ(state_hashes.at(1).simulation_step_index, 2 * SimulatedTetrion::state_hash_interval);
+
+    // the same recording, but the second state hash doesn't match anymore
+    {
+        auto headers = reader.tetrion_headers();
+        auto maybe_writer = recorder::RecordingWriter::get_writer(
+                tampered_path, std::move(headers), recorder::AdditionalInformation{}, true
+        );
+        ASSERT_THAT(maybe_writer, ExpectedHasValue());
+        auto& writer = maybe_writer.value();
+        for (const auto& record : reader.records()) {
+            std::ignore = writer.add_record(record.tetrion_index, record.simulation_step_index, record.event);
+        }
+        for (usize i = 0; i < state_hashes.size(); ++i) {
+            const auto& state_hash = state_hashes.at(i);
+            std::ignore = writer.add_state_hash(
+                    state_hash.tetrion_index, state_hash.simulation_step_index,
+                    i == 1 ? state_hash.hash ^ 1 : state_hash.hash
+            );
+        }
+    }
+
+    auto tampered = std::move(Simulation::get_replay_simulation(tampered_path).value());
+    try {
+        tampered.simulate_to_end();
+        FAIL() << "the modified state hash wasn't detected";
+    } catch (const std::runtime_error& error) {
+        EXPECT_THAT(
+                error.what(), ::testing::HasSubstr(fmt::format(
+                                      "state hashes at simulation step {} are not equal",
+                                      state_hashes.at(1).simulation_step_index
+                              ))
+        );
+        EXPECT_THAT(
+                error.what(), ::testing::HasSubstr(fmt::format(
+                                      "diverged after simulation step {}", state_hashes.at(0).simulation_step_index
+                              ))
+        );
+    }
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(tampered_path);
+}
+
+TEST(Simulation, DivergenceInWorkerThreadIsRethrown) {
+    auto path = std::filesystem::temp_directory_path() / "oopetris_parallel_divergence_test.rec";
+    auto tampered_path = std::filesystem::temp_directory_path() / "oopetris_parallel_divergence_tampered_test.rec";
+    record_random_games(path, { 31, 32 });
+
+    const auto reader = std::move(recorder::RecordingReader::from_path(path).value());
+    const auto& state_hashes = reader.state_hashes();
+    const auto tampered_hash = std::ranges::find_if(state_hashes, [](const recorder::StateHash& state_hash) {
+        return state_hash.tetrion_index == 1;
+    });
+    ASSERT_NE(tampered_hash, state_hashes.end());
+
+    // only the second tetrion diverges, so the exception is thrown by one of the worker threads
+    {
+        auto headers = reader.tetrion_headers();
+        auto writer = std::move(recorder::RecordingWriter::get_writer(
+                                        tampered_path, std::move(headers), recorder::AdditionalInformation{}, true
+        )
+                                        .value());
+        for (const auto& record : reader.records()) {
+            std::ignore = writer.add_record(record.tetrion_index, record.simulation_step_index, record.event);
+        }
+        for (const auto& state_hash : state_hashes) {
+            std::ignore = writer.add_state_hash(
+                    state_hash.tetrion_index, state_hash.simulation_step_index,
+                    &state_hash == &*tampered_hash ? state_hash.hash ^ 1 : state_hash.hash
+            );
+        }
+    }
+
+    auto tampered = std::move(Simulation::get_replay_simulation(tampered_path, 2).value());
+    ASSERT_THROW(tampered.simulate_to_end(), std::runtime_error);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(tampered_path);
+}
+
+TEST(Keyframe, RoundTripAndInvalidValues) {
+    auto tetrion = SimulatedTetrion{ 0, 5, 0, nullptr, std::nullopt };
+    tetrion.spawn_next_tetromino(0);
+    FeedInput input{};
+    input.set_target_tetrion(&tetrion);
+
+    // ends with a tetromino on hold
+    for (SimulationStep simulation_step_index = 1; simulation_step_index <= 310; ++simulation_step_index) {
+        if (simulation_step_index % 40 == 0) {
+            input.feed(InputEvent::RotateRightPressed, simulation_step_index);
+            input.feed(InputEvent::MoveLeftPressed, simulation_step_index);
+        } else if (simulation_step_index % 40 == 5) {
+            input.feed(InputEvent::HoldPressed, simulation_step_index);
+        } else if (simulation_step_index % 40 == 10) {
+            input.feed(InputEvent::DropPressed, simulation_step_index);
+        } else if (simulation_step_index % 40 == 20) {
+            input.feed(InputEvent::RotateRightReleased, simulation_step_index);
+            input.feed(InputEvent::MoveLeftReleased, simulation_step_index);
+            input.feed(InputEvent::HoldReleased, simulation_step_index);
+            input.feed(InputEvent::DropReleased, simulation_step_index);
+        }
+        input.update(simulation_step_index);
+        tetrion.update_step(simulation_step_index);
+        input.late_update(simulation_step_index);
+        tetrion.dispatch_events();
+    }
+    ASSERT_GT(tetrion.num_locked_tetrominos(), 0);
+    ASSERT_TRUE(tetrion.state().tetromino_on_hold.has_value());
+
+    auto initial_tetrion = SimulatedTetrion{ 0, 5, 0, nullptr, std::nullopt };
+    initial_tetrion.spawn_next_tetromino(0);
+    const auto initial_state = initial_tetrion.state();
+    const auto from_bytes = [&initial_state](const std::vector<char>& keyframe_bytes) {
+        return keyframe::from_bytes(keyframe_bytes, 310, initial_state);
+    };
+
+    const auto bytes = keyframe::to_bytes(tetrion, input);
+    const auto state = from_bytes(bytes);
+    ASSERT_THAT(state, ExpectedHasValue());
+
+    auto restored = SimulatedTetrion{ 0, 5, 0, nullptr, std::nullopt };
+    restored.restore_state(state->tetrion);
+    ASSERT_EQ(restored.state_hash(), tetrion.state_hash());
+    ASSERT_EQ(state->held_keys.left, input.held_keys().left);
+
+    // the version, seed, algorithm, level, lock delay step, lines, score and locked tetrominos come before the first
+    // bool, then the other bools, the lock delays and the gravity step before the game state
+    constexpr usize first_bool_offset = 4 + 8 + 1 + 4 + 8 + 4 + 8 + 4;
+    constexpr usize gravity_step_offset = first_bool_offset + 4 + 4;
+    constexpr usize game_state_offset = gravity_step_offset + 8;
+
+    auto invalid_bool = bytes;
+    invalid_bool.at(first_bool_offset) = 2;
+    ASSERT_THAT(from_bytes(invalid_bool), ExpectedHasError());
+
+    auto invalid_game_state = bytes;
+    invalid_game_state.at(game_state_offset) = 7;
+    ASSERT_THAT(from_bytes(invalid_game_state), ExpectedHasError());
+
+    auto other_version = bytes;
+    other_version.at(0) = 1;
+    ASSERT_THAT(from_bytes(other_version), ExpectedHasError());
+
+    ASSERT_THAT(from_bytes({ bytes.begin(), bytes.end() - 1 }), ExpectedHasError());
+
+    auto trailing_bytes = bytes;
+    trailing_bytes.push_back(0);
+    ASSERT_THAT(from_bytes(trailing_bytes), ExpectedHasError());
+
+    // a keyframe must not swap the piece sequence of the recording
+    auto other_seed = bytes;
+    other_seed.at(4) ^= 1;
+    ASSERT_THAT(from_bytes(other_seed), ExpectedHasError());
+
+    auto far_gravity_step = bytes;
+    far_gravity_step.at(gravity_step_offset + 7) = 1;
+    ASSERT_THAT(from_bytes(far_gravity_step), ExpectedHasError());
+}
@@ -0,0 +1,51 @@
+#include "game/simulated_tetrion.hpp"
+#include "game/tetromino.hpp"
+
+#include <gtest/gtest.h>
+
+
+TEST(Tetromino, ShapeMasksMatchTheMinos) {
+    const auto position = grid::GridPoint{ 3, 5 };
+
+    for (u8 type = 0; type <= static_cast<u8>(helper::TetrominoType::LastType); ++type) {
+        auto tetromino = Tetromino{ position, static_cast<helper::TetrominoType>(type) };
+
+        for (usize i = 0; i < 4; ++i) {
+            const auto& mask = Tetromino::get_shape_mask(tetromino.type(), tetromino.rotation());
+
+            std::array<MinoStack::RowMask, 4> rows{};
+            auto min = Tetromino::TetrominoPoint{ 4, 4 };
+            auto max = Tetromino::TetrominoPoint{ -1, -1 };
+            for (const auto& mino : tetromino.minos()) {
+                const auto offset = mino.position() - position;
+                rows.at(static_cast<usize>(offset.y)) |= static_cast<MinoStack::RowMask>(1U << offset.x);
+                min = { std::min(min.x, offset.x), std::min(min.y, offset.y) };
+                max = { std::max(max.x, offset.x), std::max(max.y, offset.y) };
+            }
+
+            ASSERT_EQ(mask.rows, rows) << "type " << static_cast<int>(type) << ", rotation " << i;
+            ASSERT_EQ(mask.min, min) << "type " << static_cast<int>(type) << ", rotation " << i;
+            ASSERT_EQ(mask.max, max) << "type " << static_cast<int>(type) << ", rotation " << i;
+
+            tetromino.rotate_right();
+        }
+    }
+}
+
+TEST(Tetromino, RotationAtTheWallIsKicked) {
+    auto tetrion = SimulatedTetrion{ 0, 1, 0, nullptr, std::nullopt };
+    tetrion.spawn_next_tetromino(0);
+
+    // a vertical I in the leftmost column can only turn horizontal after being kicked two columns to the right
+    auto state = tetrion.state();
+    state.active_tetromino = Tetromino{ grid::GridPoint{ -2, 5 }, helper::TetrominoType::I };
+    state.active_tetromino->rotate_right();
+    tetrion.restore_state(state);
+
+    ASSERT_TRUE(tetrion.handle_input_command(input::GameInputCommand::RotateRight, 1));
+
+    const auto& active_tetromino = tetrion.state().active_tetromino;
+    ASSERT_TRUE(active_tetromino.has_value());
+    ASSERT_EQ(active_tetromino->rotation(), Rotation::South);
+    ASSERT_EQ(active_tetromino->position(), (grid::GridPoint{ 0, 5 }));
+}